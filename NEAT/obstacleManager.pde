@@ -9,6 +9,10 @@ class ObstacleManager {
     
     float speed = 5;
     
+    // Obstacles all move left at the same speed, so the list stays sorted by position: the ones
+    // ahead of the dinos (which share one X position) start at this index
+    int nextAhead = 0;
+    
     // Update obstacles and create new ones
     void update() {
         updateSpeed();
@@ -39,50 +43,20 @@ class ObstacleManager {
     
     // Get the closest obstacle ahead of a position
     Obstacles getClosestObstacle(float dinoX) {
-        Obstacles closest = null;
-        float closestDistance = Float.MAX_VALUE;
-        
-        for (Obstacles obstacle : obstacles) {
-            if (obstacle.positionX > dinoX) { // Only consider obstacles ahead
-                float distance = obstacle.positionX - dinoX;
-                if (distance < closestDistance) {
-                    closestDistance = distance;
-                    closest = obstacle;
-                }
-            }
-        }
-        
-        return closest;
+        int index = findNextAhead(dinoX);
+        return index < obstacles.size() ? obstacles.get(index) : null;
     }
     
     // Get the second closest obstacle ahead of a position
     Obstacles getSecondClosestObstacle(float dinoX) {
-        Obstacles closest = null;
-        Obstacles secondClosest = null;
-        float closestDistance = Float.MAX_VALUE;
-        float secondClosestDistance = Float.MAX_VALUE;
-        
-        for (Obstacles obstacle : obstacles) {
-            if (obstacle.positionX > dinoX) { // Only consider obstacles ahead
-                float distance = obstacle.positionX - dinoX;
-                if (distance < closestDistance) {
-                    secondClosest = closest;
-                    secondClosestDistance = closestDistance;
-                    closest = obstacle;
-                    closestDistance = distance;
-                } else if (distance < secondClosestDistance) {
-                    secondClosest = obstacle;
-                    secondClosestDistance = distance;
-                }
-            }
-        }
-        
-        return secondClosest;
+        int index = findNextAhead(dinoX) + 1;
+        return index < obstacles.size() ? obstacles.get(index) : null;
     }
     
     // Reset obstacles (for new generation)
     void reset() {
         obstacles.clear();
+        nextAhead = 0;
         speed = 5;
         timerBetweenObstacles = 0;
         randomAdditionOfNewObstacles = floor(random(30)); // Updated to match new range
@@ -93,13 +67,22 @@ class ObstacleManager {
         speed += 0.005; // Increased from 0.001 to 0.005 for faster difficulty progression
     }
     
+    private int findNextAhead(float dinoX) {
+        while (nextAhead < obstacles.size() && obstacles.get(nextAhead).positionX <= dinoX) {
+            nextAhead++;
+        }
+        return nextAhead;
+    }
+    
     private void updateObstacles() {
-        for(int i = obstacles.size() - 1; i >= 0; i--) {
+        for(int i = 0; i < obstacles.size(); i++) {
             obstacles.get(i).move(speed);
-            
-            if ((obstacles.get(i).positionX + obstacles.get(i).obstacleWidth) < 0) {
-                obstacles.remove(i);
-            }
+        }
+        
+        // Obstacles off screen are always at the front
+        while (obstacles.size() > 0 && (obstacles.get(0).positionX + obstacles.get(0).obstacleWidth) < 0) {
+            obstacles.remove(0);
+            nextAhead = max(0, nextAhead - 1);
         }
     }
     
@@ -0,0 +1,1161 @@
+// File: Benchmark.cpp
+// Description: Micro and macro benchmarks of the NEAT core, the native simulator, the logger, the
+//              profiler and the server's transports. Only portable sources are linked (not the server
+//              itself), and the loopback sockets of the transport benchmark are winsock or BSD sockets,
+//              so it builds on Windows and Linux alike. Results are printed as a table and written as
+//              JSON, to compare releases.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int SOCKET;
+const SOCKET INVALID_SOCKET = -1;
+const int SOCKET_ERROR = -1;
+int closesocket(SOCKET socket) { return close(socket); }
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <iomanip>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "NEAT.h"
+#include "neuralNetwork.h"
+#include "CompiledNetwork.h"
+#include "GenomeDeltaEncoder.h"
+#include "WebSocketFrameParser.h"
+#include "SharedMemoryTransport.h"
+#include "DinoSimulator.h"
+#include "IslandModel.h"
+#include "NoveltyArchive.h"
+#include "Logger.h"
+#include "Profiler.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::string;
+using json = nlohmann::json;
+
+// Same network shape as the server's
+const int NUM_INPUTS = 4;
+const int NUM_OUTPUTS = 2;
+
+struct Options {
+    string filter;                  // Only benchmarks whose name contains it
+    string jsonPath = "benchmark.json";
+    double minSampleSeconds = 0.1;  // Microbenchmarks repeat their operation until a sample lasts this long
+    int samples = 5;
+    int generations = 50;           // Of the evolution macrobenchmark
+};
+Options options;
+
+// One line of the report. Times are per operation: the median over the samples, and the fastest sample.
+struct Result {
+    string name;
+    json params;
+    uint64_t iterations = 0;        // Operations per sample
+    int samples = 0;
+    double nsPerOp = 0.0;
+    double minNsPerOp = 0.0;
+    double bytesPerOp = 0.0;        // Data handled per operation, 0 when it does not apply
+};
+std::vector<Result> results;
+
+// Every benchmark feeds what it computes in here, so the optimizer cannot drop the work
+volatile double sink = 0.0;
+
+bool isSelected(const string& name) {
+    return options.filter.empty() || name.find(options.filter) != string::npos;
+}
+
+void printHeader() {
+    cout << std::left << std::setw(30) << "benchmark" << std::setw(56) << "params" << std::right
+         << std::setw(14) << "ns/op" << std::setw(14) << "min ns/op" << std::setw(14) << "ops/s" << std::setw(10) << "MB/s" << endl;
+}
+
+void addResult(Result result, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    result.samples = static_cast<int>(samples.size());
+    result.nsPerOp = samples[samples.size() / 2];
+    result.minNsPerOp = samples.front();
+
+    cout << std::left << std::setw(30) << result.name << std::setw(56) << result.params.dump() << std::right << std::fixed
+         << std::setprecision(1) << std::setw(14) << result.nsPerOp << std::setw(14) << result.minNsPerOp
+         << std::setprecision(0) << std::setw(14) << 1e9 / result.nsPerOp << std::setprecision(1) << std::setw(10);
+    if (result.bytesPerOp > 0.0) cout << result.bytesPerOp * 1e3 / result.nsPerOp;
+    else cout << "-";
+    cout << endl;
+    results.push_back(std::move(result));
+}
+
+// Macrobenchmarks time whole runs themselves: one sample per run, in ns per operation
+void addRun(const string& name, json params, uint64_t iterations, std::vector<double>& samples, double bytesPerOp = 0.0) {
+    Result result;
+    result.name = name;
+    result.params = std::move(params);
+    result.iterations = iterations;
+    result.bytesPerOp = bytesPerOp;
+    addResult(std::move(result), samples);
+}
+
+double roundTo(double value, int decimals) {
+    double scale = std::pow(10.0, decimals);
+    return std::round(value * scale) / scale;
+}
+
+// Time _run(n), which performs n operations. The batch grows until it lasts minSampleSeconds,
+// then it is timed once per sample. Returns the median ns per operation, 0 when filtered out.
+double measure(const string& name, json params, const std::function<void(uint64_t)>& run, double bytesPerOp = 0.0) {
+    if (!isSelected(name)) return 0.0;
+
+    auto timeBatch = [&](uint64_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        run(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    uint64_t iterations = 1;
+    while (true) {
+        double seconds = timeBatch(iterations);
+        if (seconds >= options.minSampleSeconds) break;
+        // Extrapolate once a batch is long enough to time, grow tenfold until then
+        if (seconds > options.minSampleSeconds / 100.0) {
+            iterations = static_cast<uint64_t>(iterations * 1.2 * options.minSampleSeconds / seconds) + 1;
+        } else {
+            iterations *= 10;
+        }
+    }
+
+    std::vector<double> samples;
+    for (int s = 0; s < options.samples; ++s) {
+        samples.push_back(timeBatch(iterations) * 1e9 / iterations);
+    }
+
+    addRun(name, std::move(params), iterations, samples, bytesPerOp);
+    return results.back().nsPerOp;
+}
+
+// Connections get the same innovation number in every genome, like NEAT::getConnectionInnovation
+std::map<std::pair<int, int>, int> innovations;
+
+int getInnovation(int fromNode, int toNode) {
+    return innovations.emplace(std::make_pair(fromNode, toNode), static_cast<int>(innovations.size())).first->second;
+}
+
+// Feed-forward genome with numHidden hidden nodes. Every hidden node and output is fed by fanIn
+// random nodes among the inputs and the hidden nodes before it, so networks of the same size
+// share some genes and differ by others, like members of a population.
+Genome makeGenome(int numHidden, int fanIn, std::mt19937& rng) {
+    std::uniform_real_distribution<> weight(-1.0, 1.0);
+    const int firstHidden = NUM_INPUTS + NUM_OUTPUTS;
+
+    Genome genome;
+    for (int i = 0; i < NUM_INPUTS; ++i) genome.addNode(i, 0.0, true, false);
+    for (int i = 0; i < NUM_OUTPUTS; ++i) genome.addNode(NUM_INPUTS + i, weight(rng), false, true);
+    for (int i = 0; i < numHidden; ++i) genome.addNode(firstHidden + i, weight(rng), false, false);
+
+    std::vector<int> sources;
+    auto connect = [&](int toNode, int numHiddenSources) {
+        sources.clear();
+        for (int i = 0; i < NUM_INPUTS; ++i) sources.push_back(i);
+        for (int i = 0; i < numHiddenSources; ++i) sources.push_back(firstHidden + i);
+        std::shuffle(sources.begin(), sources.end(), rng);
+
+        int numConnections = (std::min)(fanIn, static_cast<int>(sources.size()));
+        for (int i = 0; i < numConnections; ++i) {
+            genome.addConnection(sources[i], toNode, weight(rng), getInnovation(sources[i], toNode));
+        }
+    };
+    for (int i = 0; i < numHidden; ++i) connect(firstHidden + i, i);
+    for (int i = 0; i < NUM_OUTPUTS; ++i) connect(NUM_INPUTS + i, numHidden);
+
+    // Crossover and compatibility expect genes in innovation order
+    std::sort(genome.m_connections.begin(), genome.m_connections.end(),
+              [](const Genome::ConnectionGene& a, const Genome::ConnectionGene& b) {
+                  return a.innovationNumber < b.innovationNumber;
+              });
+    return genome;
+}
+
+json genomeParams(const Genome& genome) {
+    return { {"hiddenNodes", genome.m_nodes.size() - NUM_INPUTS - NUM_OUTPUTS}, {"connections", genome.m_connections.size()} };
+}
+
+// Network queries, genetic operators and serialization at several genome sizes
+void runGenomeBenchmarks() {
+    const int hiddenNodeCounts[] = { 0, 8, 32, 128 };
+    const int fanIn = 4;
+    std::mt19937 rng(1);
+    const double inputs[NUM_INPUTS] = { 0.5, -0.25, 0.75, 0.1 };
+    std::vector<double> inputVector(inputs, inputs + NUM_INPUTS);
+
+    for (int numHidden : hiddenNodeCounts) {
+        Genome genome = makeGenome(numHidden, fanIn, rng);
+        Genome other = makeGenome(numHidden, fanIn, rng);
+        json params = genomeParams(genome);
+
+        measure("neuralNetwork.feedForward", params, [&](uint64_t n) {
+            std::unique_ptr<neuralNetwork> network = genome.createNeuralNetwork();
+            for (uint64_t i = 0; i < n; ++i) network->feedForward(inputVector);
+            sink = sink + network->getOutputs()[0];
+        });
+
+        measure("compiledNetwork.feedForward", params, [&](uint64_t n) {
+            CompiledNetwork network = genome.compile();
+            for (uint64_t i = 0; i < n; ++i) network.feedForward(inputs, NUM_INPUTS);
+            sink = sink + network.getOutput(0);
+        });
+
+        measure("genome.createNeuralNetwork", params, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                std::unique_ptr<neuralNetwork> network = genome.createNeuralNetwork();
+                sink = sink + network->getHiddenNodes().size();
+            }
+        });
+
+        measure("genome.compatibilityDistance", params, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) sink = sink + genome.compatibilityDistance(other);
+        });
+
+        measure("genome.crossover", params, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) sink = sink + Genome::crossover(genome, other).m_connections.size();
+        });
+
+        string text = GenomeDeltaEncoder::genomeToJSON(genome, 1, NUM_INPUTS, NUM_OUTPUTS).dump();
+        json textParams = params;
+        textParams["bytes"] = text.size();
+        measure("genomeToJSON", textParams, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                sink = sink + GenomeDeltaEncoder::genomeToJSON(genome, 1, NUM_INPUTS, NUM_OUTPUTS).dump().size();
+            }
+        }, static_cast<double>(text.size()));
+
+        measure("json::parse", textParams, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) sink = sink + json::parse(text)["connections"].size();
+        }, static_cast<double>(text.size()));
+    }
+}
+
+// Re-speciation of whole populations of mid-sized genomes
+void runSpeciationBenchmarks() {
+    const int populationSizes[] = { 150, 1000 };
+    std::mt19937 rng(2);
+
+    for (int populationSize : populationSizes) {
+        NEAT::Config config;
+        config.populationSize = populationSize;
+        config.numInputs = NUM_INPUTS;
+        config.numOutputs = NUM_OUTPUTS;
+        NEAT neat(config);
+        neat.initializePopulation();
+        for (Genome* genome : neat.getPopulation()) {
+            *genome = makeGenome(8, 4, rng);
+        }
+        neat.speciate();
+
+        json params = { {"population", populationSize}, {"species", neat.getNumSpecies()} };
+        measure("neat.speciate", params, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) neat.speciate();
+            sink = sink + neat.getNumSpecies();
+        });
+    }
+}
+
+// Frames from the client: masked on encode, unmasked in place by the parser on decode
+void runFrameBenchmarks() {
+    const size_t payloadSizes[] = { 100, 4096, 65536 };
+    const uint8_t maskKey[4] = { 0x12, 0x34, 0x56, 0x78 };
+
+    for (size_t payloadSize : payloadSizes) {
+        std::vector<uint8_t> payload(payloadSize);
+        for (size_t i = 0; i < payloadSize; ++i) payload[i] = static_cast<uint8_t>('a' + i % 26);
+        std::vector<uint8_t> frame(WebSocketFrameParser::MAX_HEADER_SIZE + payloadSize);
+        json params = { {"payloadBytes", payloadSize} };
+
+        measure("websocket.encodeFrame", params, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                int headerSize = WebSocketFrameParser::encodeHeader(frame.data(), payloadSize, WebSocketFrameParser::OPCODE_TEXT, maskKey);
+                std::memcpy(frame.data() + headerSize, payload.data(), payloadSize);
+                WebSocketFrameParser::applyMask(frame.data() + headerSize, payloadSize, maskKey);
+                sink = sink + frame[headerSize + payloadSize - 1];
+            }
+        }, static_cast<double>(payloadSize));
+
+        int headerSize = WebSocketFrameParser::encodeHeader(frame.data(), payloadSize, WebSocketFrameParser::OPCODE_TEXT, maskKey);
+        std::memcpy(frame.data() + headerSize, payload.data(), payloadSize);
+        WebSocketFrameParser::applyMask(frame.data() + headerSize, payloadSize, maskKey);
+        frame.resize(headerSize + payloadSize);
+
+        WebSocketFrameParser parser(1 << 20, true);
+        measure("websocket.decodeFrame", params, [&](uint64_t n) {
+            WebSocketFrameParser::Frame decoded;
+            for (uint64_t i = 0; i < n; ++i) {
+                parser.append(frame.data(), frame.size());
+                if (parser.next(decoded) != WebSocketFrameParser::RESULT_MESSAGE) {
+                    cerr << "websocket.decodeFrame: frame not decoded" << endl;
+                    std::exit(1);
+                }
+                sink = sink + decoded.data[decoded.size - 1];
+            }
+        }, static_cast<double>(payloadSize));
+    }
+}
+
+// Synthetic task for the evolution macrobenchmark: the first output should follow a smooth function
+// of the inputs over a fixed set of cases. Fitness grows as the error shrinks.
+const int NUM_CASES = 16;
+
+double syntheticFitness(const Genome& genome, const std::vector<double>& cases) {
+    CompiledNetwork network = genome.compile();
+    double error = 0.0;
+    for (int c = 0; c < NUM_CASES; ++c) {
+        const double* row = &cases[c * (NUM_INPUTS + 1)];
+        network.resetState();
+        network.feedForward(row, NUM_INPUTS);
+        error += std::fabs(network.getOutput(0) - row[NUM_INPUTS]);
+    }
+    return 1000.0 / (1.0 + error);
+}
+
+// N generations of steady-state evolution (generational reproduction is not implemented), each a
+// population's worth of offspring evaluated on the synthetic task as they are produced
+void runEvolutionBenchmark() {
+    if (!isSelected("neat.evolution")) return;
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<> uniform(-1.0, 1.0);
+    std::vector<double> cases(NUM_CASES * (NUM_INPUTS + 1));
+    for (int c = 0; c < NUM_CASES; ++c) {
+        double* row = &cases[c * (NUM_INPUTS + 1)];
+        for (int i = 0; i < NUM_INPUTS; ++i) row[i] = uniform(rng);
+        row[NUM_INPUTS] = 1.0 / (1.0 + std::exp(-(row[0] * row[1] + row[2] - row[3])));
+    }
+
+    NEAT::Config config;
+    config.populationSize = 150;
+    config.numInputs = NUM_INPUTS;
+    config.numOutputs = NUM_OUTPUTS;
+    config.steadyState = true;
+
+    std::vector<double> samples;
+    uint64_t evaluations = 0;
+    double bestFitness = 0.0;
+    for (int s = 0; s < options.samples; ++s) {
+        auto start = std::chrono::steady_clock::now();
+        NEAT neat(config);
+        neat.initializePopulation();
+        for (Genome* genome : neat.getPopulation()) {
+            neat.reportFitness(genome, syntheticFitness(*genome, cases));
+        }
+        for (int generation = 0; generation < options.generations; ++generation) {
+            for (int i = 0; i < config.populationSize; ++i) {
+                Genome* child = neat.replaceWorst();
+                if (!child) break;
+                neat.reportFitness(child, syntheticFitness(*child, cases));
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        evaluations = neat.getEvaluationCount();
+        Genome* best = neat.getBestGenome();
+        bestFitness = (std::max)(bestFitness, best ? best->getFitness() : 0.0);
+        samples.push_back(seconds * 1e9 / evaluations);
+    }
+
+    // One operation is one evaluation, with its share of selection, breeding and speciation
+    addRun("neat.evolution", { {"population", config.populationSize}, {"generations", options.generations}, {"bestFitness", std::round(bestFitness)} },
+           evaluations, samples);
+}
+
+// Parent draws from one species: a linear roulette scan against the alias table and tournaments
+void runSelectionBenchmarks() {
+    const size_t speciesSizes[] = { 100, 1000, 10000 };
+    std::mt19937 rng(4);
+
+    for (size_t speciesSize : speciesSizes) {
+        std::vector<std::unique_ptr<Genome>> genomes;
+        for (size_t i = 0; i < speciesSize; ++i) {
+            genomes.emplace_back(new Genome());
+            genomes.back()->setFitness(std::uniform_real_distribution<>(0.0, 1000.0)(rng));
+        }
+        Species species(genomes[0].get(), 0);
+        for (size_t i = 1; i < speciesSize; ++i) species.addGenome(genomes[i].get());
+        species.calculateAdjustedFitness();
+        const std::vector<Genome*>& members = species.getGenomes();
+
+        measure("species.selectParent", { {"method", "roulette"}, {"speciesSize", speciesSize} }, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                double random = std::uniform_real_distribution<>(0.0, species.getTotalAdjustedFitness())(rng);
+                double sum = 0.0;
+                const Genome* selected = members.back();
+                for (auto genome : members) {
+                    sum += genome->getAdjustedFitness();
+                    if (sum >= random) {
+                        selected = genome;
+                        break;
+                    }
+                }
+                sink = sink + selected->getFitness();
+            }
+        });
+        measure("species.selectParent", { {"method", "alias"}, {"speciesSize", speciesSize} }, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) sink = sink + species.selectParent()->getFitness();
+        });
+        measure("species.selectParent", { {"method", "tournament"}, {"speciesSize", speciesSize} }, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) sink = sink + species.selectParent(3)->getFitness();
+        });
+    }
+}
+
+// kNN novelty queries against archives of growing size: vantage-point tree against a linear scan.
+// Behaviours are drawn around a few hundred centres, as real descriptors cluster around strategies.
+void runNoveltyBenchmarks() {
+    if (!isSelected("noveltyArchive.query")) return;
+
+    const size_t archiveSizes[] = { 10000, 100000, 300000 };
+    const size_t dimensions = 9;
+    const int numQueries = 200;
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, 0.05f);
+    std::vector<float> centres(256 * dimensions);
+    for (float& value : centres) value = uniform(rng);
+    auto drawBehaviour = [&](float* behaviour) {
+        const float* centre = &centres[std::uniform_int_distribution<size_t>(0, 255)(rng) * dimensions];
+        for (size_t d = 0; d < dimensions; ++d) behaviour[d] = centre[d] + noise(rng);
+    };
+
+    for (size_t archiveSize : archiveSizes) {
+        NoveltyArchive::Config archiveConfig;
+        NoveltyArchive archive(archiveConfig);
+        archive.reset(dimensions);
+        std::vector<float> behaviour(dimensions);
+        for (size_t i = 0; i < archiveSize; ++i) {
+            drawBehaviour(behaviour.data());
+            archive.add(behaviour.data());
+        }
+        std::vector<float> queries(numQueries * dimensions);
+        for (int i = 0; i < numQueries; ++i) drawBehaviour(&queries[i * dimensions]);
+
+        // The tree must find the same neighbours as the scan
+        archive.resetStats();
+        double maxError = 0.0;
+        for (int i = 0; i < numQueries; ++i) {
+            const float* query = &queries[i * dimensions];
+            maxError = (std::max)(maxError, std::fabs(archive.query(query) - archive.queryLinear(query)));
+        }
+        double distancesPerQuery = archive.getStats().getDistancesPerQuery();
+
+        json params = { {"archive", archiveSize}, {"dimensions", dimensions}, {"k", archiveConfig.neighbours} };
+        json treeParams = params;
+        treeParams["method"] = "tree";
+        treeParams["distancesPerQuery"] = std::round(distancesPerQuery);
+        treeParams["maxError"] = maxError;
+        measure("noveltyArchive.query", treeParams, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) sink = sink + archive.query(&queries[(i % numQueries) * dimensions]);
+        });
+        params["method"] = "linear";
+        measure("noveltyArchive.query", params, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) sink = sink + archive.queryLinear(&queries[(i % numQueries) * dimensions]);
+        });
+    }
+}
+
+// Steady-state evolution against the native simulator, a quarter of the population evaluated at a
+// time like the sweeps, until numEvaluations genomes were evaluated
+uint64_t evolveOnSimulator(NEAT& neat, const DinoSimulator::Config& simConfig, int numEvaluations) {
+    int populationSize = neat.getConfig().populationSize;
+    neat.initializePopulation();
+    std::vector<Genome*> batch = neat.getPopulation();
+    DinoSimulator::evaluateGenomes(batch, simConfig);
+    for (Genome* genome : batch) neat.reportFitness(genome, genome->getFitness());
+    int evaluations = static_cast<int>(batch.size());
+    while (evaluations < numEvaluations) {
+        batch.clear();
+        while (static_cast<int>(batch.size()) < (std::max)(1, populationSize / 4)) {
+            Genome* child = neat.replaceWorst();
+            if (!child) break;
+            batch.push_back(child);
+        }
+        if (batch.empty()) break;
+        DinoSimulator::evaluateGenomes(batch, simConfig);
+        for (Genome* genome : batch) neat.reportFitness(genome, genome->getFitness());
+        evaluations += static_cast<int>(batch.size());
+    }
+    return evaluations;
+}
+
+// Cost of the built-in profiler: a timed scope and a counter against an empty loop, enabled and
+// disabled, then the probes hit by a steady-state run against the native simulator. Evolution is not
+// seeded, so runs with and without probes differ by more than the probes cost; the overhead is
+// the probes the run went through times their cost, over its time.
+void runProfilerBenchmarks() {
+    Profiler& profiler = Profiler::instance();
+    bool wasEnabled = profiler.isEnabled();
+
+    double baseline = measure("profiler.emptyLoop", json::object(), [](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) sink = sink + 1;
+    });
+    double scopeNs = 0.0;
+    for (int enabled = 1; enabled >= 0; --enabled) {
+        profiler.setEnabled(enabled != 0);
+        double ns = measure("profiler.scope", { {"enabled", enabled != 0} }, [](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                PROFILE_SCOPE("benchmark.scope");
+                sink = sink + 1;
+            }
+        });
+        if (enabled) scopeNs = ns - baseline;
+        measure("profiler.counter", { {"enabled", enabled != 0} }, [](uint64_t n) {
+            for (uint64_t i = 0; i < n; ++i) {
+                PROFILE_COUNT("benchmark.counter", 1);
+                sink = sink + 1;
+            }
+        });
+    }
+    profiler.setEnabled(wasEnabled);
+
+    if (!isSelected("profiler.evolution") || !wasEnabled) return;
+
+    NEAT::Config config;
+    config.populationSize = 150;
+    config.numInputs = DinoSimulator::NUM_INPUTS;
+    config.numOutputs = NUM_OUTPUTS;
+    config.steadyState = true;
+    DinoSimulator::Config simConfig;
+
+    auto countScopes = [&]() {
+        uint64_t calls = 0;
+        for (const auto& zone : profiler.getStats()) {
+            if (!zone.isCounter) calls += zone.calls;
+        }
+        return calls;
+    };
+
+    std::vector<double> samples;
+    uint64_t evaluations = 0;
+    uint64_t scopes = 0;
+    double seconds = 0.0;
+    for (int s = 0; s < options.samples; ++s) {
+        NEAT neat(config);
+        neat.setEvaluationSeeds({ simConfig.seed });
+        uint64_t scopesBefore = countScopes();
+        auto start = std::chrono::steady_clock::now();
+        evaluations = evolveOnSimulator(neat, simConfig, 3000);
+        double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        scopes += countScopes() - scopesBefore;
+        seconds += runSeconds;
+        samples.push_back(runSeconds * 1e9 / evaluations);
+    }
+
+    // One operation is one evaluation; the overhead needs the scope cost measured above
+    json params = { {"population", config.populationSize}, {"scopesPerEvaluation", roundTo(static_cast<double>(scopes) / (evaluations * samples.size()), 1)} };
+    if (scopeNs > 0.0) params["overheadPercent"] = roundTo(100.0 * scopes * scopeNs * 1e-9 / seconds, 4);
+    addRun("profiler.evolution", params, evaluations, samples);
+}
+
+// Cost of a log call on the calling thread, formatting and I/O excluded. Batches stay below the
+// ring size and pause between each other, so the writer keeps up and only the enqueue path is timed.
+// Sampled and rate-limited calls cost a counter increment when skipped.
+void runLoggerBenchmarks() {
+    if (!isSelected("logger.log") && !isSelected("logger.logRateLimited")) return;
+
+    const int batches = 200;
+    const int callsPerBatch = 1000;
+
+    Logger::Config config;
+    config.filePath = "logger_benchmark.log";
+    config.consoleLevel = Logger::LEVEL_ERROR;
+    Logger::instance().start(config);
+    Logger::Stats before = Logger::instance().getStats();
+
+    std::vector<double> logSamples;
+    std::vector<double> rateLimitedSamples;
+    for (int batch = 0; batch < batches; ++batch) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < callsPerBatch; ++i) {
+            LOG_INFO("Genome {} fitness: {} ({}/{})", i, i * 0.5, batch, batches);
+        }
+        logSamples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / callsPerBatch);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (int batch = 0; batch < batches; ++batch) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < callsPerBatch; ++i) {
+            LOG_RATE_LIMITED(Logger::LEVEL_INFO, 10, "Genome {} fitness: {}", i, i * 0.5);
+        }
+        rateLimitedSamples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / callsPerBatch);
+    }
+
+    Logger::instance().stop();
+    Logger::Stats stats = Logger::instance().getStats();
+
+    json params = { {"logged", stats.logged - before.logged}, {"written", stats.written - before.written},
+                    {"dropped", stats.dropped - before.dropped} };
+    addRun("logger.log", params, callsPerBatch, logSamples);
+    addRun("logger.logRateLimited", { {"perSecond", 10}, {"suppressed", stats.suppressed - before.suppressed} },
+           callsPerBatch, rateLimitedSamples);
+}
+
+// Lockstep simulator throughput for several population sizes and thread counts. One operation is one
+// dino simulated for one frame.
+void runSimulatorBenchmarks() {
+    if (!isSelected("simulator.evaluateGenomes")) return;
+
+    const int populationSizes[] = { 100, 1000, 5000 };
+    int maxThreads = (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    for (int populationSize : populationSizes) {
+        NEAT::Config config;
+        config.populationSize = populationSize;
+        config.numInputs = DinoSimulator::NUM_INPUTS;
+        config.numOutputs = NUM_OUTPUTS;
+        NEAT population(config);
+        population.initializePopulation();
+
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            DinoSimulator::Config simConfig;
+            simConfig.numThreads = threads;
+            std::vector<double> samples;
+            DinoSimulator::Stats stats;
+            for (int s = 0; s < options.samples; ++s) {
+                stats = DinoSimulator::evaluateGenomes(population.getPopulation(), simConfig);
+                samples.push_back(stats.seconds * 1e9 / stats.dinoFrames);
+            }
+            addRun("simulator.evaluateGenomes", { {"population", populationSize}, {"threads", threads}, {"frames", stats.frames} },
+                   stats.dinoFrames, samples);
+        }
+    }
+}
+
+// Inference calls saved by decision policies on an evolved population, and how far scores drift
+// from querying the network every frame. One operation is one game.
+void runDecisionBenchmarks() {
+    if (!isSelected("simulator.decisionPolicy")) return;
+
+    const int generations = 30;
+
+    NEAT::Config config;
+    config.populationSize = 200;
+    config.numInputs = DinoSimulator::NUM_INPUTS;
+    config.numOutputs = NUM_OUTPUTS;
+    config.steadyState = true;
+    NEAT population(config);
+
+    // Evolve first: a random population dies on the first obstacle whatever the policy
+    DinoSimulator::Config simConfig;
+    evolveOnSimulator(population, simConfig, (generations + 1) * config.populationSize);
+
+    const std::vector<Genome*>& genomes = population.getPopulation();
+    DinoSimulator::evaluateGenomes(genomes, simConfig);
+    std::vector<double> baseline;
+    for (const Genome* genome : genomes) baseline.push_back(genome->getFitness());
+
+    struct Policy { const char* name; int interval; bool skipAirborne; double inputEpsilon; };
+    const Policy policies[] = {
+        { "every frame", 1, false, 0.0 },
+        { "every 2", 2, false, 0.0 },
+        { "every 4", 4, false, 0.0 },
+        { "every 8", 8, false, 0.0 },
+        { "airborne skip", 1, true, 0.0 },
+        { "every 4 + air", 4, true, 0.0 },
+        { "every 8 + eps .05", 8, false, 0.05 },
+        { "every 16 + eps .05 + air", 16, true, 0.05 },
+    };
+
+    for (const Policy& policy : policies) {
+        simConfig.decisions.interval = policy.interval;
+        simConfig.decisions.skipAirborne = policy.skipAirborne;
+        simConfig.decisions.inputEpsilon = policy.inputEpsilon;
+        std::vector<double> samples;
+        DinoSimulator::Stats stats;
+        for (int s = 0; s < options.samples; ++s) {
+            stats = DinoSimulator::evaluateGenomes(genomes, simConfig);
+            samples.push_back(stats.seconds * 1e9 / genomes.size());
+        }
+
+        double sum = 0.0, drift = 0.0, maxDrift = 0.0;
+        int changed = 0;
+        for (size_t i = 0; i < genomes.size(); ++i) {
+            double difference = std::abs(genomes[i]->getFitness() - baseline[i]);
+            sum += genomes[i]->getFitness();
+            drift += difference;
+            maxDrift = (std::max)(maxDrift, difference);
+            changed += difference > 0.0;
+        }
+
+        json params = {
+            {"policy", policy.name},
+            {"inferencesPerGame", roundTo(static_cast<double>(stats.inferences) / genomes.size(), 1)},
+            {"inferencesSaved", roundTo(stats.getInferencesSaved(), 3)},
+            {"meanFitness", roundTo(sum / genomes.size(), 1)},
+            {"meanDrift", roundTo(drift / genomes.size(), 1)},
+            {"maxDrift", maxDrift},
+            {"changed", changed}
+        };
+        addRun("simulator.decisionPolicy", params, genomes.size(), samples);
+    }
+}
+
+// Single-course fitness against several courses per genome, with and without stopping the clearly
+// worse genomes early. The best genomes of each run are then scored on courses none of them saw.
+// One sample per run, single runs being too noisy to compare; one operation is one episode played.
+void runEpisodeBenchmarks() {
+    if (!isSelected("neat.episodes")) return;
+
+    const int generations = 30;
+    const int populationSize = 100;
+    const int numEpisodes = 5;
+    const int heldOutCourses = 20;
+    const size_t numBest = 10;
+
+    struct Setup { const char* name; int episodes; int minEpisodes; NEAT::EpisodeAggregate aggregate; };
+    const Setup setups[] = {
+        { "1 course", 1, 0, NEAT::EPISODE_MEAN },
+        { "5 courses, mean", numEpisodes, 0, NEAT::EPISODE_MEAN },
+        { "5 courses, mean, halving", numEpisodes, 2, NEAT::EPISODE_MEAN },
+        { "5 courses, q25, halving", numEpisodes, 2, NEAT::EPISODE_QUANTILE },
+        { "5 courses, min, halving", numEpisodes, 2, NEAT::EPISODE_MIN },
+    };
+
+    DinoSimulator::Config heldOut;
+    heldOut.seed = 1001;
+    heldOut.episodes = heldOutCourses;
+
+    for (const Setup& setup : setups) {
+        uint64_t played = 0, skipped = 0;
+        double trainingBest = 0.0, heldOutMean = 0.0;
+        std::vector<double> samples;
+
+        for (int repeat = 0; repeat < options.samples; ++repeat) {
+            NEAT::Config config;
+            config.populationSize = populationSize;
+            config.numInputs = DinoSimulator::NUM_INPUTS;
+            config.numOutputs = NUM_OUTPUTS;
+            config.steadyState = true;
+            config.minEpisodes = setup.minEpisodes;
+            config.episodeAggregate = setup.aggregate;
+            NEAT population(config);
+
+            DinoSimulator::Config simConfig;
+            simConfig.episodes = setup.episodes;
+            population.setEvaluationSeeds(DinoSimulator::getEpisodeSeeds(simConfig));
+            auto evaluate = [&](const std::vector<Genome*>& genomes) {
+                population.evaluateEpisodes(genomes, [&simConfig](const std::vector<Genome*>& batch, unsigned int seed, std::vector<double>& scores) {
+                    DinoSimulator::evaluateEpisode(batch, simConfig, seed, scores);
+                });
+            };
+
+            auto start = std::chrono::steady_clock::now();
+            population.initializePopulation();
+            evaluate(population.getPopulation());
+            std::vector<Genome*> batch;
+            for (int produced = 0; produced < generations * populationSize; ) {
+                batch.clear();
+                while (batch.size() < static_cast<size_t>(populationSize / 4) && produced < generations * populationSize) {
+                    if (Genome* child = population.replaceWorst()) batch.push_back(child);
+                    produced++;
+                }
+                evaluate(batch);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            samples.push_back(seconds * 1e9 / (std::max)(uint64_t(1), population.getEpisodeStats().played));
+
+            // The genomes the run would pick, replayed on unseen courses
+            std::vector<Genome*> best = population.getPopulation();
+            size_t count = (std::min)(numBest, best.size());
+            std::partial_sort(best.begin(), best.begin() + count, best.end(),
+                [](const Genome* a, const Genome* b) { return a->getFitness() > b->getFitness(); });
+            trainingBest += best[0]->getFitness();
+            best.resize(count);
+            double heldOutSum = 0.0;
+            std::vector<double> scores;
+            for (unsigned int seed : DinoSimulator::getEpisodeSeeds(heldOut)) {
+                DinoSimulator::evaluateEpisode(best, heldOut, seed, scores);
+                for (double score : scores) heldOutSum += score;
+            }
+            heldOutMean += heldOutSum / (count * heldOutCourses);
+
+            played += population.getEpisodeStats().played;
+            skipped += population.getEpisodeStats().skipped;
+        }
+
+        int repeats = options.samples;
+        json params = {
+            {"setup", setup.name},
+            {"generations", generations},
+            {"skippedPercent", roundTo(played + skipped > 0 ? 100.0 * skipped / (played + skipped) : 0.0, 1)},
+            {"trainingBest", roundTo(trainingBest / repeats, 1)},
+            {"heldOutMean", roundTo(heldOutMean / repeats, 1)}
+        };
+        addRun("neat.episodes", params, played / repeats, samples);
+    }
+}
+
+// Scaling of the island model with the number of islands, each island doing the same work. One
+// operation is one evaluation.
+void runIslandBenchmarks() {
+    if (!isSelected("islandModel.run")) return;
+
+    int maxIslands = (std::max)(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    // Powers of two, then every core
+    std::vector<int> islandCounts;
+    for (int numIslands = 1; numIslands < maxIslands; numIslands *= 2) islandCounts.push_back(numIslands);
+    islandCounts.push_back(maxIslands);
+
+    double baseline = 0.0;
+    for (int numIslands : islandCounts) {
+        IslandModel::Config config;
+        config.numIslands = numIslands;
+        config.generations = 20;
+        config.neat.populationSize = 100;
+        config.neat.numInputs = DinoSimulator::NUM_INPUTS;
+        config.neat.numOutputs = NUM_OUTPUTS;
+
+        std::vector<double> samples;
+        IslandModel::Stats stats;
+        double bestFitness = 0.0;
+        for (int s = 0; s < options.samples; ++s) {
+            IslandModel islands(config);
+            stats = islands.run();
+            bestFitness = (std::max)(bestFitness, stats.bestFitness);
+            samples.push_back(stats.seconds * 1e9 / stats.evaluations);
+        }
+
+        double evaluationsPerSecond = stats.getEvaluationsPerSecond();
+        if (numIslands == 1) baseline = evaluationsPerSecond;
+        json params = { {"islands", numIslands}, {"generations", config.generations},
+                        {"speedup", roundTo(baseline > 0.0 ? evaluationsPerSecond / baseline : 0.0, 2)}, {"bestFitness", std::round(bestFitness)} };
+        addRun("islandModel.run", params, stats.evaluations, samples);
+    }
+}
+
+// Transport benchmark helpers: a connected loopback TCP pair and WebSocket frames written by hand
+bool openLoopbackPair(SOCKET& serverSide, SOCKET& clientSide) {
+    SOCKET listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET) return false;
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t addressLength = sizeof(address);
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) == SOCKET_ERROR || listen(listener, 1) == SOCKET_ERROR ||
+        getsockname(listener, (sockaddr*)&address, &addressLength) == SOCKET_ERROR) {
+        closesocket(listener);
+        return false;
+    }
+
+    clientSide = socket(AF_INET, SOCK_STREAM, 0);
+    if (clientSide == INVALID_SOCKET || connect(clientSide, (sockaddr*)&address, sizeof(address)) == SOCKET_ERROR) {
+        closesocket(listener);
+        return false;
+    }
+    serverSide = accept(listener, nullptr, nullptr);
+    closesocket(listener);
+    return serverSide != INVALID_SOCKET;
+}
+
+bool sendAll(SOCKET socket, const string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        int sent = send(socket, data.data() + offset, static_cast<int>(data.size() - offset), 0);
+        if (sent <= 0) return false;
+        offset += sent;
+    }
+    return true;
+}
+
+// Server frames go out unmasked, client frames masked, as in the real protocol
+void appendFrame(string& buffer, const string& payload, bool masked) {
+    const uint8_t maskKey[4] = { 0x12, 0x34, 0x56, 0x78 };
+    uint8_t header[WebSocketFrameParser::MAX_HEADER_SIZE];
+    int headerSize = WebSocketFrameParser::encodeHeader(header, payload.size(), WebSocketFrameParser::OPCODE_TEXT,
+                                                        masked ? maskKey : nullptr);
+    size_t payloadStart = buffer.size() + headerSize;
+    buffer.append(reinterpret_cast<const char*>(header), headerSize);
+    buffer.append(payload);
+    if (masked) WebSocketFrameParser::applyMask(reinterpret_cast<uint8_t*>(&buffer[payloadStart]), payload.size(), maskKey);
+}
+
+// Read WebSocket messages from socket until onMessage returns false or the connection drops.
+// The server side reads client frames, which must be masked.
+template <typename Callback>
+void readMessages(SOCKET socket, bool fromClient, Callback onMessage) {
+    WebSocketFrameParser parser(16 * 1024 * 1024, fromClient);
+    WebSocketFrameParser::Frame frame;
+    while (true) {
+        size_t available = 0;
+        uint8_t* buffer = parser.prepareWrite(4096, available);
+        int received = recv(socket, reinterpret_cast<char*>(buffer), available > (1 << 20) ? (1 << 20) : static_cast<int>(available), 0);
+        if (received <= 0) return;
+        parser.commitWrite(received);
+
+        WebSocketFrameParser::Result result;
+        while ((result = parser.next(frame)) == WebSocketFrameParser::RESULT_MESSAGE) {
+            if (!onMessage(frame)) return;
+        }
+        if (result != WebSocketFrameParser::RESULT_NEED_MORE) return;
+    }
+}
+
+// Round trip of genomes and results through shared memory against the WebSocket path (JSON genome
+// and frame over loopback TCP, JSON fitness back). Evaluation itself is left out. One operation is
+// one genome sent and its result received.
+void runTransportBenchmarks() {
+    const int populationSize = 1000;
+    const int genomesPerSample = 20000;
+    const int totalGenomes = genomesPerSample * options.samples;
+
+    // Mid-sized genomes: a few hidden nodes and extra connections on top of the inputs and outputs
+    std::mt19937 rng(6);
+    std::vector<Genome> genomes;
+    std::vector<int> genomeIds;
+    std::vector<string> messages;
+    size_t numNodes = 0;
+    size_t numConnections = 0;
+    size_t packedBytes = 0;
+    size_t jsonBytes = 0;
+    for (int i = 0; i < populationSize; ++i) {
+        genomes.push_back(makeGenome(8, 4, rng));
+        genomeIds.push_back(i + 1);
+        numNodes += genomes.back().m_nodes.size();
+        numConnections += genomes.back().m_connections.size();
+        packedBytes += SharedMemoryTransport::getPackedSize(genomes.back());
+        json message = { {"type", "genome"}, {"genome", GenomeDeltaEncoder::genomeToJSON(genomes.back(), i + 1, NUM_INPUTS, NUM_OUTPUTS)} };
+        jsonBytes += message.dump().size();
+    }
+    json params = { {"nodes", numNodes / populationSize}, {"connections", numConnections / populationSize} };
+
+    // Shared memory, with a thread attached to the region the way an evaluator process is
+    if (isSelected("transport.sharedMemory")) {
+        SharedMemoryTransport transport;
+        if (transport.create(1, 1 << 20)) {
+            std::thread evaluator([&transport, totalGenomes]() {
+                SharedMemoryTransport worker;
+                if (!worker.open(transport.getName(), 0)) return;
+                Genome genome;
+                int genomeId = 0;
+                int received = 0;
+                while (received < totalGenomes && !worker.isShutdown()) {
+                    if (!worker.waitForGenomes(100)) continue;
+                    while (worker.receiveGenome(genomeId, genome)) {
+                        worker.sendResult(genomeId, static_cast<double>(genome.m_connections.size()));
+                        received++;
+                    }
+                }
+            });
+
+            std::vector<double> samples;
+            SharedMemoryTransport::Result result;
+            for (int s = 0; s < options.samples; ++s) {
+                auto start = std::chrono::steady_clock::now();
+                int sent = 0;
+                int results = 0;
+                while (results < genomesPerSample) {
+                    while (sent < genomesPerSample && transport.sendGenome(genomeIds[sent % populationSize], genomes[sent % populationSize])) {
+                        sent++;
+                    }
+                    if (!transport.receiveResult(result)) {
+                        transport.waitForResults(100);
+                        continue;
+                    }
+                    results++;
+                }
+                samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / genomesPerSample);
+            }
+            evaluator.join();
+            double bytesPerGenome = static_cast<double>(packedBytes) / populationSize;
+            addRun("transport.sharedMemory", params, genomesPerSample, samples, bytesPerGenome);
+        } else {
+            cerr << "transport.sharedMemory: cannot create the region" << endl;
+        }
+        transport.close();
+    }
+
+    // WebSocket path, with a thread standing in for the browser
+    if (!isSelected("transport.websocket")) return;
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        cerr << "transport.websocket: cannot start winsock" << endl;
+        return;
+    }
+#endif
+    SOCKET serverSide = INVALID_SOCKET;
+    SOCKET clientSide = INVALID_SOCKET;
+    if (!openLoopbackPair(serverSide, clientSide)) {
+        cerr << "transport.websocket: cannot open a loopback connection" << endl;
+        return;
+    }
+
+    std::thread client([clientSide, totalGenomes]() {
+        int received = 0;
+        string frames;
+        readMessages(clientSide, false, [&](const WebSocketFrameParser::Frame& frame) {
+            json message = json::parse(frame.data, frame.data + frame.size);
+            json reply = { {"type", "fitness"}, {"genomeId", message["genome"]["id"]}, {"fitness", message["genome"]["connections"].size()} };
+            frames.clear();
+            appendFrame(frames, reply.dump(), true);
+            sendAll(clientSide, frames);
+            return ++received < totalGenomes;
+        });
+    });
+
+    std::vector<double> samples;
+    string frames;
+    for (int s = 0; s < options.samples; ++s) {
+        auto start = std::chrono::steady_clock::now();
+        std::thread resultReader([serverSide, genomesPerSample]() {
+            int results = 0;
+            readMessages(serverSide, true, [&](const WebSocketFrameParser::Frame& frame) {
+                json message = json::parse(frame.data, frame.data + frame.size);
+                sink = sink + message["fitness"].get<double>();
+                return ++results < genomesPerSample;
+            });
+        });
+        for (int i = 0; i < genomesPerSample; ++i) {
+            json message = { {"type", "genome"}, {"genome", GenomeDeltaEncoder::genomeToJSON(genomes[i % populationSize], genomeIds[i % populationSize], NUM_INPUTS, NUM_OUTPUTS)} };
+            frames.clear();
+            appendFrame(frames, message.dump(), false);
+            if (!sendAll(serverSide, frames)) break;
+        }
+        resultReader.join();
+        samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / genomesPerSample);
+    }
+    client.join();
+    addRun("transport.websocket", params, genomesPerSample, samples, static_cast<double>(jsonBytes) / populationSize);
+
+    closesocket(serverSide);
+    closesocket(clientSide);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+string getCompiler() {
+#if defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+    return string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return string("gcc ") + __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+string getTimestamp() {
+    std::time_t now = std::time(nullptr);
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return text;
+}
+
+bool writeReport(const string& path) {
+    json entries = json::array();
+    for (const auto& result : results) {
+        json entry = {
+            {"name", result.name},
+            {"params", result.params},
+            {"iterations", result.iterations},
+            {"samples", result.samples},
+            {"nsPerOp", result.nsPerOp},
+            {"minNsPerOp", result.minNsPerOp},
+            {"opsPerSecond", 1e9 / result.nsPerOp}
+        };
+        if (result.bytesPerOp > 0.0) entry["bytesPerSecond"] = result.bytesPerOp * 1e9 / result.nsPerOp;
+        entries.push_back(std::move(entry));
+    }
+
+#ifdef NDEBUG
+    const char* build = "release";
+#else
+    const char* build = "debug";
+#endif
+    json report = {
+        {"suite", "neat"},
+        {"schemaVersion", 1},
+        {"timestamp", getTimestamp()},
+        {"compiler", getCompiler()},
+        {"build", build},
+        {"profiler", PROFILER_ENABLED && Profiler::instance().isEnabled()},
+        {"minSampleSeconds", options.minSampleSeconds},
+        {"results", std::move(entries)}
+    };
+
+    std::ofstream file(path);
+    if (!file) return false;
+    file << report.dump(2) << endl;
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.minSampleSeconds = std::atof(argv[++i]);
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = (std::max)(1, std::atoi(argv[++i]));
+        } else if (arg == "--generations" && i + 1 < argc) {
+            options.generations = std::atoi(argv[++i]);
+        } else if (arg == "--no-profile") {
+            Profiler::instance().setEnabled(false);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--filter <name>] [--json <path>] [--min-time <seconds>] [--samples <n>]"
+                 << " [--generations <n>] [--no-profile]" << endl;
+            return 1;
+        }
+    }
+
+    printHeader();
+    runGenomeBenchmarks();
+    runSpeciationBenchmarks();
+    runFrameBenchmarks();
+    runSelectionBenchmarks();
+    runNoveltyBenchmarks();
+    runProfilerBenchmarks();
+    runLoggerBenchmarks();
+    runSimulatorBenchmarks();
+    runDecisionBenchmarks();
+    runEpisodeBenchmarks();
+    runIslandBenchmarks();
+    runTransportBenchmarks();
+    runEvolutionBenchmark();
+
+    if (!writeReport(options.jsonPath)) {
+        cerr << "Cannot write " << options.jsonPath << endl;
+        return 1;
+    }
+    cout << results.size() << " results written to " << options.jsonPath << endl;
+    return 0;
+}
@@ -0,0 +1,80 @@
+// File: CompiledNetwork.cpp
+// Description: Implementation of the CompiledNetwork class
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <cmath>
+#include <algorithm>
+#include "CompiledNetwork.h"
+
+CompiledNetwork::CompiledNetwork()
+    : m_uStructureHash(0)
+{
+}
+
+CompiledNetwork::~CompiledNetwork()
+{
+}
+
+void CompiledNetwork::feedForward(const double* _inputs, size_t _numInputs)
+{
+    // Set input values
+    size_t numInputs = _numInputs < m_vInputSlots.size() ? _numInputs : m_vInputSlots.size();
+    for (size_t i = 0; i < numInputs; ++i)
+    {
+        m_vValues[m_vInputSlots[i]] = _inputs[i];
+    }
+
+    // Process nodes in topological order (same arithmetic as Node::activate)
+    double* values = m_vValues.data();
+    const int* edgeFrom = m_vEdgeFrom.data();
+    const double* edgeWeight = m_vEdgeWeight.data();
+
+    int edge = 0;
+    for (size_t step = 0; step < m_vStepNode.size(); ++step)
+    {
+        double sum = 0.0;
+        const int edgeEnd = m_vStepEdgeEnd[step];
+        for (; edge < edgeEnd; ++edge)
+        {
+            sum += values[edgeFrom[edge]] * edgeWeight[edge];
+        }
+        sum += m_vStepBias[step];
+
+        values[m_vStepNode[step]] = 1.0 / (1.0 + std::exp(-sum));
+    }
+}
+
+std::vector<double> CompiledNetwork::getOutputs() const
+{
+    std::vector<double> outputs;
+    outputs.reserve(m_vOutputSlots.size());
+
+    for (int slot : m_vOutputSlots)
+    {
+        outputs.push_back(m_vValues[slot]);
+    }
+
+    return outputs;
+}
+
+void CompiledNetwork::resetState()
+{
+    std::fill(m_vValues.begin(), m_vValues.end(), 0.0);
+}
+
+void CompiledNetwork::setConnectionWeight(size_t _geneIndex, double _weight)
+{
+    if (_geneIndex < m_vConnectionSlots.size() && m_vConnectionSlots[_geneIndex] >= 0)
+    {
+        m_vEdgeWeight[m_vConnectionSlots[_geneIndex]] = _weight;
+    }
+}
+
+void CompiledNetwork::setNodeBias(size_t _geneIndex, double _bias)
+{
+    if (_geneIndex < m_vBiasSlots.size() && m_vBiasSlots[_geneIndex] >= 0)
+    {
+        m_vStepBias[m_vBiasSlots[_geneIndex]] = _bias;
+    }
+}
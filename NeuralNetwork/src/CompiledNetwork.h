@@ -0,0 +1,82 @@
+// File: CompiledNetwork.h
+// Description: Definition of the CompiledNetwork class, a flat executable form of a genome.
+//              Nodes are laid out in evaluation order and every connection/node gene knows
+//              which weight/bias slot it owns, so weight-only changes can be patched in place.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef COMPILED_NETWORK_H
+#define COMPILED_NETWORK_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class CompiledNetwork {
+public:
+    // What the build-time optimisation pass removed
+    struct PruneStats {
+        int disabledEdges = 0;      // Disabled connection genes
+        int danglingEdges = 0;      // Connections to missing nodes or into input nodes
+        int deadEndNodes = 0;       // Nodes with no path to any output
+        int deadEndEdges = 0;
+        int constantNodes = 0;      // Nodes with no path from any input, folded into downstream biases
+        int foldedEdges = 0;
+
+        int getNodesRemoved() const { return deadEndNodes + constantNodes; }
+        int getEdgesRemoved() const { return disabledEdges + danglingEdges + deadEndEdges + foldedEdges; }
+    };
+
+    CompiledNetwork();
+    ~CompiledNetwork();
+
+    void feedForward(const double* _inputs, size_t _numInputs);
+    void feedForward(const std::vector<double>& _inputs) { feedForward(_inputs.data(), _inputs.size()); }
+
+    double getOutput(size_t _index) const { return m_vValues[m_vOutputSlots[_index]]; }
+    size_t getNumOutputs() const { return m_vOutputSlots.size(); }
+    size_t getNumInputs() const { return m_vInputSlots.size(); }
+    std::vector<double> getOutputs() const;
+
+    // Clear node values (they carry over between calls for nodes in cycles)
+    void resetState();
+
+    // Patch a single gene. Genes that are not expressed in the network (disabled, dangling) are ignored.
+    void setConnectionWeight(size_t _geneIndex, double _weight);
+    void setNodeBias(size_t _geneIndex, double _bias);
+
+    uint64_t getStructureHash() const { return m_uStructureHash; }
+    const PruneStats& getPruneStats() const { return m_pruneStats; }
+    
+    // Folded constants depend on the weights they absorbed, so such a network cannot be patched
+    bool isPatchable() const { return m_pruneStats.constantNodes == 0 && m_pruneStats.foldedEdges == 0; }
+    size_t getNumNodes() const { return m_vValues.size(); }
+    size_t getNumEdges() const { return m_vEdgeWeight.size(); }
+
+private:
+    // Value of every node, input nodes first
+    std::vector<double> m_vValues;
+    std::vector<int> m_vInputSlots;
+    std::vector<int> m_vOutputSlots;
+
+    // One step per non-input node, in topological order.
+    // Edges of step i are [m_vStepEdgeEnd[i - 1], m_vStepEdgeEnd[i]).
+    std::vector<int> m_vStepNode;
+    std::vector<int> m_vStepEdgeEnd;
+    std::vector<double> m_vStepBias;
+
+    std::vector<int> m_vEdgeFrom;
+    std::vector<double> m_vEdgeWeight;
+
+    // Genome gene index -> slot, -1 when the gene is not expressed
+    std::vector<int> m_vConnectionSlots;
+    std::vector<int> m_vBiasSlots;
+
+    uint64_t m_uStructureHash;
+    PruneStats m_pruneStats;
+
+    // Genome builds and patches compiled networks
+    friend class Genome;
+};
+
+#endif // COMPILED_NETWORK_H
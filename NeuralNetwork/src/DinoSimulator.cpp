@@ -0,0 +1,452 @@
+// File: DinoSimulator.cpp
+// Description: Implementation of the lockstep Dino game simulator
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+#include "DinoSimulator.h"
+#include "NEAT.h"
+
+namespace
+{
+    // Game constants (matching dinoGame.js and the sprite sizes in web/assets/images)
+    const double GRAVITY = 0.6;
+    const double JUMP_VELOCITY = 16.0;
+    const double START_SPEED = 5.0;
+    const double SPEED_INCREMENT = 0.001;
+    const double DINO_X = 150.0;
+    const double DINO_WIDTH = 96.0 * 0.5;
+    const double DINO_RUN_HEIGHT = 112.0;
+    const double DINO_DUCK_HEIGHT = 68.0;
+    const double SPAWN_X = 1200.0;       // Canvas width
+
+    // Input normalization (matching DinoGame.updateAI)
+    const double NO_OBSTACLE_X = 1000.0;
+    const double INPUT_SCALE_Y = 100.0;
+    const double INPUT_SCALE_VELOCITY = 20.0;
+    const double INPUT_SCALE_X = 1200.0;
+    const double INPUT_SCALE_HEIGHT = 120.0;
+    const double INPUT_SCALE_BIRD_HEIGHT = 160.0;   // BIRD_HIGH
+
+    // Behaviour entry of an obstacle the dino never reacted to
+    const float NOT_REACTED = 1.0f;
+
+    DinoSimulator::Obstacle makeObstacle(const ObstacleSchedule::Spawn& _spawn)
+    {
+        DinoSimulator::Obstacle obstacle;
+        obstacle.positionX = SPAWN_X;
+        obstacle.positionY = _spawn.positionY;
+        obstacle.width = _spawn.width;
+        obstacle.height = _spawn.height;
+        obstacle.type = _spawn.type;
+        return obstacle;
+    }
+}
+
+DinoSimulator::DinoSimulator(const Config& _config)
+    : m_config(_config),
+      m_pool(_config.numThreads),
+      m_numActive(0),
+      m_nextSpawn(0),
+      m_scheduleFrame(0),
+      m_firstObstacle(0),
+      m_endObstacle(0),
+      m_nextAhead(0),
+      m_speed(START_SPEED),
+      m_frame(0)
+{
+    m_config.framesPerBatch = std::max(1, m_config.framesPerBatch);
+    m_inputOffset = (m_config.sensors & SENSOR_DINO) ? 2 : 0;
+    m_numInputs = getNumInputs(m_config.sensors);
+    m_numObstacleInputs = m_numInputs - m_inputOffset;
+    m_config.decisions.interval = std::max(1, m_config.decisions.interval);
+}
+
+DinoSimulator::~DinoSimulator()
+{
+}
+
+int DinoSimulator::getNumInputs(unsigned int _sensors)
+{
+    int numInputs = 0;
+    if (_sensors & SENSOR_DINO) numInputs += 2;
+    if (_sensors & SENSOR_CLOSEST) numInputs += 2;
+    if (_sensors & SENSOR_SECOND) numInputs += 2;
+    if (_sensors & SENSOR_TYPE) numInputs += NUM_OBSTACLE_TYPES;
+    if (_sensors & SENSOR_BIRD_HEIGHT) numInputs += 1;
+    return numInputs;
+}
+
+void DinoSimulator::reset(size_t _numDinos)
+{
+    m_posY.assign(_numDinos, 0.0);
+    m_velY.assign(_numDinos, 0.0);
+    m_crouch.assign(_numDinos, 0);
+    m_alive.assign(_numDinos, 1);
+    m_score.assign(_numDinos, 0);
+    m_actions.assign(_numDinos, ACTION_RUN);
+    // Everybody decides on the first frame
+    m_sinceDecision.assign(_numDinos, static_cast<uint32_t>(m_config.decisions.interval));
+    m_lastInputs.assign(m_config.decisions.inputEpsilon > 0.0 ? _numDinos * m_numInputs : 0, 0.0);
+    m_scores.assign(_numDinos, 0);
+    m_behaviours.assign(_numDinos * getBehaviourSize(), NOT_REACTED);
+
+    m_dinoIds.resize(_numDinos);
+    for (size_t i = 0; i < _numDinos; ++i)
+    {
+        m_dinoIds[i] = static_cast<uint32_t>(i);
+    }
+    m_numActive = _numDinos;
+
+    // Same seed, same course: every reset replays the shared schedule of the seed
+    if (!m_schedule || m_schedule->getSeed() != m_config.seed)
+    {
+        m_schedule = ObstacleSchedule::get(m_config.seed, static_cast<uint32_t>(std::max(0, m_config.maxFrames)));
+    }
+    m_nextSpawn = 0;
+    m_scheduleFrame = 0;
+    m_firstObstacle = 0;
+    m_endObstacle = 0;
+    m_nextAhead = 0;
+    m_speed = START_SPEED;
+    m_frame = 0;
+}
+
+DinoSimulator::Stats DinoSimulator::run(const Controller& _controller)
+{
+    Stats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    while (m_numActive > 0 && m_frame < static_cast<uint64_t>(m_config.maxFrames))
+    {
+        // The obstacle stream does not depend on the dinos, so the shared frames of a
+        // whole batch are computed up front and every thread replays them read-only.
+        size_t numFrames = static_cast<size_t>(std::min<uint64_t>(m_config.framesPerBatch, m_config.maxFrames - m_frame));
+        m_frames.resize(numFrames);
+        for (size_t f = 0; f < numFrames; ++f)
+        {
+            advanceObstacles(m_frames[f]);
+        }
+
+        std::atomic<uint64_t> dinoFrames(0);
+        std::atomic<uint64_t> inferences(0);
+        m_pool.parallelFor(m_numActive, [&](size_t _begin, size_t _end) {
+            uint64_t slotInferences = 0;
+            dinoFrames += simulateSlots(_begin, _end, numFrames, _controller, slotInferences);
+            inferences += slotInferences;
+        });
+
+        stats.dinoFrames += dinoFrames;
+        stats.inferences += inferences;
+        stats.frames += numFrames;
+        m_frame += numFrames;
+
+        compactActiveSet();
+    }
+
+    // Dinos still alive when the frame limit is hit keep their current score
+    for (size_t i = 0; i < m_numActive; ++i)
+    {
+        m_scores[m_dinoIds[i]] = m_score[i];
+    }
+
+    size_t behaviourSize = getBehaviourSize();
+    if (behaviourSize > 0)
+    {
+        for (size_t i = 0; i < m_scores.size(); ++i)
+        {
+            m_behaviours[i * behaviourSize + behaviourSize - 1] = static_cast<float>(m_scores[i]) / m_config.maxFrames;
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+void DinoSimulator::advanceObstacles(FrameInfo& _frame)
+{
+    // Sensors are read before anything moves (DinoGame.updateAI runs before update())
+    const unsigned int sensors = m_config.sensors;
+    const bool hasClosest = m_nextAhead < m_endObstacle;
+    const bool hasSecond = m_nextAhead + 1 < m_endObstacle;
+    const Obstacle& closest = m_obstacles[m_nextAhead & (MAX_OBSTACLES - 1)];
+    const Obstacle& second = m_obstacles[(m_nextAhead + 1) & (MAX_OBSTACLES - 1)];
+
+    _frame.nearestX = hasClosest ? closest.positionX : NO_OBSTACLE_X;
+    _frame.obstacleIndex = m_nextAhead;
+
+    double* input = _frame.obstacleInputs;
+    if (sensors & SENSOR_CLOSEST)
+    {
+        *input++ = _frame.nearestX / INPUT_SCALE_X;
+        *input++ = (hasClosest ? closest.height : 0.0) / INPUT_SCALE_HEIGHT;
+    }
+    if (sensors & SENSOR_SECOND)
+    {
+        *input++ = (hasSecond ? second.positionX : NO_OBSTACLE_X) / INPUT_SCALE_X;
+        *input++ = (hasSecond ? second.height : 0.0) / INPUT_SCALE_HEIGHT;
+    }
+    if (sensors & SENSOR_TYPE)
+    {
+        for (int type = 0; type < NUM_OBSTACLE_TYPES; ++type)
+        {
+            *input++ = (hasClosest && closest.type == type) ? 1.0 : 0.0;
+        }
+    }
+    if (sensors & SENSOR_BIRD_HEIGHT)
+    {
+        *input++ = (hasClosest ? closest.positionY : 0.0) / INPUT_SCALE_BIRD_HEIGHT;
+    }
+
+    // updateSpeed
+    m_speed += SPEED_INCREMENT;
+
+    // addObstacle
+    const std::vector<ObstacleSchedule::Spawn>& spawns = m_schedule->getSpawns();
+    if (m_nextSpawn < spawns.size() && spawns[m_nextSpawn].frame == m_scheduleFrame)
+    {
+        m_obstacles[m_endObstacle++ & (MAX_OBSTACLES - 1)] = makeObstacle(spawns[m_nextSpawn++]);
+    }
+    m_scheduleFrame++;
+
+    // updateObstacles: the dino X position is the same for everybody, so the X axis part of
+    // the collision test is resolved here once and only the Y intervals are left per dino.
+    _frame.numHazards = 0;
+    const double dinoLeft = DINO_X - DINO_WIDTH / 2;
+    const double dinoRight = DINO_X + DINO_WIDTH / 2;
+
+    for (uint32_t i = m_firstObstacle; i != m_endObstacle; ++i)
+    {
+        Obstacle& obstacle = m_obstacles[i & (MAX_OBSTACLES - 1)];
+        obstacle.positionX -= m_speed;
+
+        double obstacleLeft = obstacle.positionX - obstacle.width / 2;
+        double obstacleRight = obstacle.positionX + obstacle.width / 2;
+        if (dinoLeft <= obstacleRight && dinoRight >= obstacleLeft && _frame.numHazards < MAX_HAZARDS)
+        {
+            _frame.hazardBottom[_frame.numHazards] = obstacle.positionY - obstacle.height / 2;
+            _frame.hazardTop[_frame.numHazards] = obstacle.positionY + obstacle.height / 2;
+            _frame.numHazards++;
+        }
+    }
+
+    // Sorted by X: the cursor moves past the obstacles the dinos just passed, and the ones that
+    // left the screen are all at the front
+    while (m_nextAhead != m_endObstacle && m_obstacles[m_nextAhead & (MAX_OBSTACLES - 1)].positionX <= DINO_X)
+    {
+        m_nextAhead++;
+    }
+    while (m_firstObstacle != m_endObstacle)
+    {
+        const Obstacle& obstacle = m_obstacles[m_firstObstacle & (MAX_OBSTACLES - 1)];
+        if (obstacle.positionX + obstacle.width >= 0) break;
+        m_firstObstacle++;
+    }
+}
+
+uint64_t DinoSimulator::simulateSlots(size_t _begin, size_t _end, size_t _numFrames, const Controller& _controller, uint64_t& _inferences)
+{
+    uint64_t dinoFrames = 0;
+    const bool everyFrame = m_config.decisions.isEveryFrame();
+
+    double* posY = m_posY.data();
+    double* velY = m_velY.data();
+    uint8_t* crouch = m_crouch.data();
+    uint8_t* alive = m_alive.data();
+    uint32_t* score = m_score.data();
+    uint8_t* actions = m_actions.data();
+    float* behaviours = m_behaviours.data();
+    const size_t behaviourSize = getBehaviourSize();
+
+    for (size_t f = 0; f < _numFrames; ++f)
+    {
+        const FrameInfo& frame = m_frames[f];
+
+        // Decisions: one controller call per live dino
+        double inputs[MAX_INPUTS];
+        std::copy(frame.obstacleInputs, frame.obstacleInputs + m_numObstacleInputs, inputs + m_inputOffset);
+        for (size_t i = _begin; i < _end; ++i)
+        {
+            if (!alive[i]) continue;
+            if (m_inputOffset > 0)
+            {
+                inputs[0] = posY[i] / INPUT_SCALE_Y;
+                inputs[1] = velY[i] / INPUT_SCALE_VELOCITY;
+            }
+            if (!everyFrame && !needsDecision(i, inputs)) continue;
+            actions[i] = static_cast<uint8_t>(_controller(m_dinoIds[i], inputs));
+            _inferences++;
+        }
+
+        // Behaviour: first reaction of each dino to the obstacle it is facing
+        if (frame.obstacleIndex < static_cast<uint32_t>(m_config.behaviourObstacles) && frame.nearestX != NO_OBSTACLE_X)
+        {
+            const float reaction = static_cast<float>(frame.nearestX / INPUT_SCALE_X);
+            for (size_t i = _begin; i < _end; ++i)
+            {
+                if (!alive[i] || actions[i] == ACTION_RUN) continue;
+                float& entry = behaviours[m_dinoIds[i] * behaviourSize + frame.obstacleIndex];
+                if (entry == NOT_REACTED) entry = actions[i] == ACTION_CROUCH ? -reaction : reaction;
+            }
+        }
+
+        // Physics and collision: branch-free over contiguous arrays so the compiler can vectorize
+        const int numHazards = frame.numHazards;
+        for (size_t i = _begin; i < _end; ++i)
+        {
+            const uint8_t wasAlive = alive[i];
+            const bool jump = actions[i] == ACTION_JUMP;
+            const uint8_t isCrouching = actions[i] == ACTION_CROUCH;
+
+            const double velocity = (jump && posY[i] == 0.0) ? JUMP_VELOCITY : velY[i];
+            const double y = posY[i] + velocity;
+            const bool airborne = y > 0.0;
+            posY[i] = airborne ? y : 0.0;
+            velY[i] = airborne ? velocity - GRAVITY : 0.0;
+            crouch[i] = isCrouching;
+
+            const double height = isCrouching ? DINO_DUCK_HEIGHT : DINO_RUN_HEIGHT;
+            uint8_t hit = 0;
+            for (int h = 0; h < numHazards; ++h)
+            {
+                hit |= static_cast<uint8_t>((posY[i] <= frame.hazardTop[h]) & (posY[i] + height >= frame.hazardBottom[h]));
+            }
+
+            alive[i] = wasAlive & static_cast<uint8_t>(!hit);
+            score[i] += alive[i];
+            dinoFrames += wasAlive;
+        }
+    }
+
+    return dinoFrames;
+}
+
+bool DinoSimulator::needsDecision(size_t _slot, const double* _inputs)
+{
+    const DecisionPolicy& policy = m_config.decisions;
+    uint32_t& since = m_sinceDecision[_slot];
+    if (policy.skipAirborne && m_posY[_slot] > 0.0)
+    {
+        since++;
+        return false;
+    }
+
+    bool decide = since >= static_cast<uint32_t>(policy.interval);
+    double* lastInputs = m_lastInputs.empty() ? nullptr : &m_lastInputs[_slot * m_numInputs];
+    for (int j = 0; lastInputs && !decide && j < m_numInputs; ++j)
+    {
+        decide = std::abs(_inputs[j] - lastInputs[j]) > policy.inputEpsilon;
+    }
+
+    if (!decide)
+    {
+        since++;
+        return false;
+    }
+    since = 1;
+    if (lastInputs) std::copy(_inputs, _inputs + m_numInputs, lastInputs);
+    return true;
+}
+
+void DinoSimulator::compactActiveSet()
+{
+    // Stable compaction: dead dinos record their final score and drop out of the active slots
+    size_t write = 0;
+    for (size_t read = 0; read < m_numActive; ++read)
+    {
+        if (!m_alive[read])
+        {
+            m_scores[m_dinoIds[read]] = m_score[read];
+            continue;
+        }
+
+        if (write != read)
+        {
+            m_posY[write] = m_posY[read];
+            m_velY[write] = m_velY[read];
+            m_crouch[write] = m_crouch[read];
+            m_alive[write] = 1;
+            m_score[write] = m_score[read];
+            m_dinoIds[write] = m_dinoIds[read];
+            m_actions[write] = m_actions[read];
+            m_sinceDecision[write] = m_sinceDecision[read];
+            if (!m_lastInputs.empty())
+            {
+                std::copy(&m_lastInputs[read * m_numInputs], &m_lastInputs[read * m_numInputs] + m_numInputs,
+                          &m_lastInputs[write * m_numInputs]);
+            }
+        }
+        write++;
+    }
+    m_numActive = write;
+}
+
+DinoSimulator::Stats DinoSimulator::evaluateGenomes(const std::vector<Genome*>& _genomes, const Config& _config, std::vector<float>* _behaviours)
+{
+    // Genomes that share a topology (siblings that only went through weight mutation)
+    // reuse the first compiled network of that topology and only patch their weights.
+    std::vector<CompiledNetwork> networks;
+    networks.reserve(_genomes.size());
+    std::unordered_map<uint64_t, size_t> templates;
+    for (const Genome* genome : _genomes)
+    {
+        uint64_t structureHash = genome->computeStructureHash();
+        auto it = templates.find(structureHash);
+        networks.push_back(genome->compile(it != templates.end() ? &networks[it->second] : nullptr));
+        if (it == templates.end()) templates[structureHash] = networks.size() - 1;
+    }
+
+    DinoSimulator simulator(_config);
+    simulator.reset(_genomes.size());
+
+    const size_t numInputs = static_cast<size_t>(getNumInputs(_config.sensors));
+    Stats stats = simulator.run([&networks, numInputs](size_t _dino, const double* _inputs) {
+        CompiledNetwork& network = networks[_dino];
+        network.feedForward(_inputs, numInputs);
+
+        // Same decision rule as DinoGame.updateAI
+        const size_t numOutputs = network.getNumOutputs();
+        if (numOutputs > 0 && network.getOutput(0) > 0.5) return static_cast<int>(ACTION_JUMP);
+        if (numOutputs > 1 && network.getOutput(1) > 0.5) return static_cast<int>(ACTION_CROUCH);
+        return static_cast<int>(ACTION_RUN);
+    });
+
+    const auto& scores = simulator.getScores();
+    for (size_t i = 0; i < _genomes.size(); ++i)
+    {
+        _genomes[i]->setFitness(scores[i]);
+        stats.nodesPruned += networks[i].getPruneStats().getNodesRemoved();
+        stats.edgesPruned += networks[i].getPruneStats().getEdgesRemoved();
+    }
+    if (_behaviours) *_behaviours = simulator.getBehaviours();
+
+    return stats;
+}
+
+DinoSimulator::Stats DinoSimulator::evaluateEpisode(const std::vector<Genome*>& _genomes, const Config& _config, unsigned int _seed, std::vector<double>& _scores)
+{
+    Config config = _config;
+    config.seed = _seed;
+    Stats stats = evaluateGenomes(_genomes, config);
+
+    _scores.resize(_genomes.size());
+    for (size_t i = 0; i < _genomes.size(); ++i)
+    {
+        _scores[i] = _genomes[i]->getFitness();
+    }
+    return stats;
+}
+
+std::vector<unsigned int> DinoSimulator::getEpisodeSeeds(const Config& _config)
+{
+    std::vector<unsigned int> seeds;
+    for (int i = 0; i < std::max(1, _config.episodes); ++i)
+    {
+        seeds.push_back(_config.seed + i);
+    }
+    return seeds;
+}
@@ -0,0 +1,188 @@
+// File: DinoSimulator.h
+// Description: Definition of the lockstep Dino game simulator. Every dino of a population runs
+//              against the same obstacle stream, using the rules of web/js/dinoGame.js.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef DINO_SIMULATOR_H
+#define DINO_SIMULATOR_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+#include "ThreadPool.h"
+#include "ObstacleSchedule.h"
+
+class Genome;
+
+class DinoSimulator {
+public:
+    // Actions returned by a controller, matching DinoGame.updateAI
+    enum Action {
+        ACTION_RUN = 0,
+        ACTION_JUMP = 1,
+        ACTION_CROUCH = 2
+    };
+
+    // Obstacle types (matching Obstacle in dinoGame.js)
+    enum ObstacleType {
+        SMALL_CACTUS = 0,
+        SMALL_CACTUS_MANY = 1,
+        BIG_CACTUS = 2,
+        BIRD_LOW = 3,
+        BIRD_MIDDLE = 4,
+        BIRD_HIGH = 5,
+        NUM_OBSTACLE_TYPES = 6
+    };
+
+    // Sensor groups fed to the network, in this order: dino height and vertical velocity; X position
+    // and height of the closest obstacle ahead; the same for the second closest; one-hot type of the
+    // closest; height above the ground of the closest (birds). Missing obstacles read as NO_OBSTACLE_X, 0.
+    enum Sensor {
+        SENSOR_DINO = 1 << 0,
+        SENSOR_CLOSEST = 1 << 1,
+        SENSOR_SECOND = 1 << 2,
+        SENSOR_TYPE = 1 << 3,
+        SENSOR_BIRD_HEIGHT = 1 << 4,
+        SENSORS_DEFAULT = SENSOR_DINO | SENSOR_CLOSEST     // The inputs of DinoGame.updateAI
+    };
+
+    // When a dino queries its controller. Between two queries it keeps its last action, which is
+    // what a held key does in the game. The default queries every frame, like DinoGame.updateAI.
+    struct DecisionPolicy {
+        int interval = 1;               // Query at least every interval frames
+        bool skipAirborne = false;      // No queries while in the air, where a jump cannot start
+        double inputEpsilon = 0.0;      // Query early when an input moved more than this since the last query, 0 disables
+
+        bool isEveryFrame() const { return interval <= 1 && !skipAirborne; }
+    };
+
+    struct Config {
+        int numThreads = 1;
+        int maxFrames = 20000;          // Hard stop so a perfect dino cannot run forever
+        int framesPerBatch = 64;        // Frames simulated between two thread synchronizations
+        unsigned int seed = 1;          // Course: obstacles come from ObstacleSchedule::get(seed)
+        int episodes = 1;               // Courses per evaluation with NEAT::evaluateEpisodes: seed, seed + 1, ...
+        int behaviourObstacles = 0;     // Obstacles covered by the behaviour descriptors, 0 disables them
+        unsigned int sensors = SENSORS_DEFAULT;     // Sensor bits, see getNumInputs
+        DecisionPolicy decisions;
+    };
+
+    struct Obstacle {
+        double positionX;
+        double positionY;
+        double width;
+        double height;
+        int type;
+    };
+
+    struct Stats {
+        uint64_t dinoFrames = 0;        // Sum over all frames of the number of dinos alive
+        uint64_t frames = 0;
+        uint64_t inferences = 0;        // Controller calls, dinoFrames under the every-frame policy
+        double seconds = 0.0;
+        uint64_t nodesPruned = 0;       // Removed by the network optimisation pass, all genomes together
+        uint64_t edgesPruned = 0;
+
+        double getDinoFramesPerSecond() const { return seconds > 0.0 ? dinoFrames / seconds : 0.0; }
+        double getInferencesSaved() const { return dinoFrames > 0 ? 1.0 - static_cast<double>(inferences) / dinoFrames : 0.0; }
+    };
+
+    static const int NUM_INPUTS = 4;    // dinoY, dinoVelocity, obstacleX, obstacleHeight (SENSORS_DEFAULT)
+    static const int MAX_INPUTS = 2 + 2 + 2 + NUM_OBSTACLE_TYPES + 1;
+
+    // Network inputs produced by a set of sensor bits
+    static int getNumInputs(unsigned int _sensors);
+
+    // Called once per alive dino per frame with the normalized sensor inputs.
+    // Must be safe to call concurrently for different dinos.
+    using Controller = std::function<int(size_t _dino, const double* _inputs)>;
+
+    DinoSimulator(const Config& _config);
+    ~DinoSimulator();
+
+    void reset(size_t _numDinos);
+    Stats run(const Controller& _controller);
+
+    // Convenience: run one game with one network per genome and store the score as fitness.
+    // With behaviourObstacles set, _behaviours receives the descriptor of every genome back to back.
+    static Stats evaluateGenomes(const std::vector<Genome*>& _genomes, const Config& _config, std::vector<float>* _behaviours = nullptr);
+    // One episode of NEAT::evaluateEpisodes: evaluateGenomes on the course of _seed, scores copied to _scores
+    static Stats evaluateEpisode(const std::vector<Genome*>& _genomes, const Config& _config, unsigned int _seed, std::vector<double>& _scores);
+    static std::vector<unsigned int> getEpisodeSeeds(const Config& _config);
+
+    const std::vector<uint32_t>& getScores() const { return m_scores; }
+    size_t getNumAlive() const { return m_numActive; }
+    size_t getNumDinos() const { return m_scores.size(); }
+    // Obstacles on screen, oldest first
+    size_t getNumObstacles() const { return static_cast<size_t>(m_endObstacle - m_firstObstacle); }
+    const Obstacle& getObstacle(size_t _index) const { return m_obstacles[(m_firstObstacle + _index) & (MAX_OBSTACLES - 1)]; }
+
+    // Behaviour descriptor of each dino, getBehaviourSize() floats per dino index: for each of the
+    // first behaviourObstacles obstacles, the normalized distance to it when the dino first reacted
+    // (negative for a crouch, 1 if it never did), then the survival time as a fraction of maxFrames
+    size_t getBehaviourSize() const { return m_config.behaviourObstacles > 0 ? m_config.behaviourObstacles + 1 : 0; }
+    const std::vector<float>& getBehaviours() const { return m_behaviours; }
+
+private:
+    static const int MAX_HAZARDS = 2;
+    // Obstacles spawn at least 101 frames apart and leave the screen within 253 frames, so no more
+    // than 3 are ever alive at once. Power of two so ring positions are a mask away.
+    static const uint32_t MAX_OBSTACLES = 8;
+
+    // What every dino needs to know about the obstacles for one frame
+    struct FrameInfo {
+        double nearestX;
+        uint32_t obstacleIndex;         // Obstacles already passed by the dinos, the nearest one is the next
+        double obstacleInputs[MAX_INPUTS - 2];  // Every sensor but the dino's, in input order
+        int numHazards;
+        double hazardBottom[MAX_HAZARDS];   // Obstacles overlapping the dino on the X axis
+        double hazardTop[MAX_HAZARDS];
+    };
+
+    Config m_config;
+    ThreadPool m_pool;
+
+    // Dino state in structure-of-arrays form, indexed by active slot.
+    // Slots [0, m_numActive) are alive at the start of a batch.
+    // Doubles rather than floats so trajectories match the JavaScript game exactly.
+    std::vector<double> m_posY;
+    std::vector<double> m_velY;
+    std::vector<uint8_t> m_crouch;
+    std::vector<uint8_t> m_alive;
+    std::vector<uint32_t> m_score;
+    std::vector<uint32_t> m_dinoIds;    // Slot -> dino index
+    std::vector<uint8_t> m_actions;
+    std::vector<uint32_t> m_sinceDecision;  // Frames since the last controller call
+    std::vector<double> m_lastInputs;   // Inputs of the last controller call, only with inputEpsilon
+    size_t m_numActive;
+
+    std::vector<uint32_t> m_scores;     // Final score per dino index
+    std::vector<float> m_behaviours;    // Per dino index, filled only when behaviourObstacles > 0
+
+    // Shared obstacle stream, replayed from the read-only schedule of the seed
+    std::shared_ptr<const ObstacleSchedule> m_schedule;
+    size_t m_nextSpawn;
+    uint32_t m_scheduleFrame;
+    // Obstacles alive, in spawn order, at ring positions [m_firstObstacle, m_endObstacle). They all
+    // move left at the same speed, so they stay sorted by X and the ones ahead of the dinos start
+    // at m_nextAhead, which also counts the obstacles passed.
+    Obstacle m_obstacles[MAX_OBSTACLES];
+    uint32_t m_firstObstacle;
+    uint32_t m_endObstacle;
+    uint32_t m_nextAhead;
+    int m_inputOffset;                  // Position of the obstacle sensors in the inputs
+    int m_numObstacleInputs;
+    int m_numInputs;
+    std::vector<FrameInfo> m_frames;
+    double m_speed;
+    uint64_t m_frame;
+
+    void advanceObstacles(FrameInfo& _frame);
+    uint64_t simulateSlots(size_t _begin, size_t _end, size_t _numFrames, const Controller& _controller, uint64_t& _inferences);
+    bool needsDecision(size_t _slot, const double* _inputs);
+    void compactActiveSet();
+};
+
+#endif // DINO_SIMULATOR_H
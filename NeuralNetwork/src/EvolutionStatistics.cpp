@@ -0,0 +1,303 @@
+// File: EvolutionStatistics.cpp
+// Description: Implementation of the streaming evolution statistics
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include "EvolutionStatistics.h"
+#include "Logger.h"
+
+void EvolutionStatistics::RunningStats::add(double _value)
+{
+    count++;
+    double delta = _value - mean;
+    mean += delta / count;
+    m2 += delta * (_value - mean);
+
+    if (count == 1 || _value < min) min = _value;
+    if (count == 1 || _value > max) max = _value;
+}
+
+double EvolutionStatistics::RunningStats::getStdDev() const
+{
+    return std::sqrt(getVariance());
+}
+
+EvolutionStatistics::QuantileSketch::QuantileSketch(double _quantile)
+    : m_quantile(_quantile)
+{
+    reset();
+}
+
+void EvolutionStatistics::QuantileSketch::reset()
+{
+    m_count = 0;
+    for (int i = 0; i < 5; ++i)
+    {
+        m_heights[i] = 0.0;
+        m_positions[i] = i + 1.0;
+    }
+    m_desired[0] = 1.0;
+    m_desired[1] = 1.0 + 2.0 * m_quantile;
+    m_desired[2] = 1.0 + 4.0 * m_quantile;
+    m_desired[3] = 3.0 + 2.0 * m_quantile;
+    m_desired[4] = 5.0;
+    m_increments[0] = 0.0;
+    m_increments[1] = m_quantile / 2.0;
+    m_increments[2] = m_quantile;
+    m_increments[3] = (1.0 + m_quantile) / 2.0;
+    m_increments[4] = 1.0;
+}
+
+void EvolutionStatistics::QuantileSketch::add(double _value)
+{
+    // The first five values are kept sorted and become the markers
+    if (m_count < 5)
+    {
+        m_heights[m_count++] = _value;
+        std::sort(m_heights, m_heights + m_count);
+        return;
+    }
+    m_count++;
+
+    // Cell of the new value, stretching the extreme markers if it falls outside
+    int cell;
+    if (_value < m_heights[0])
+    {
+        m_heights[0] = _value;
+        cell = 0;
+    }
+    else if (_value >= m_heights[4])
+    {
+        m_heights[4] = _value;
+        cell = 3;
+    }
+    else
+    {
+        cell = 0;
+        while (_value >= m_heights[cell + 1]) cell++;
+    }
+
+    for (int i = cell + 1; i < 5; ++i)
+    {
+        m_positions[i] += 1.0;
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+        m_desired[i] += m_increments[i];
+    }
+
+    // Move each middle marker at most one position towards where it should be, along the
+    // parabola through its neighbours, or linearly when that would break the ordering
+    for (int i = 1; i < 4; ++i)
+    {
+        double offset = m_desired[i] - m_positions[i];
+        if ((offset >= 1.0 && m_positions[i + 1] - m_positions[i] > 1.0) ||
+            (offset <= -1.0 && m_positions[i - 1] - m_positions[i] < -1.0))
+        {
+            double d = offset > 0.0 ? 1.0 : -1.0;
+            double parabolic = m_heights[i] + d / (m_positions[i + 1] - m_positions[i - 1]) *
+                ((m_positions[i] - m_positions[i - 1] + d) * (m_heights[i + 1] - m_heights[i]) / (m_positions[i + 1] - m_positions[i]) +
+                 (m_positions[i + 1] - m_positions[i] - d) * (m_heights[i] - m_heights[i - 1]) / (m_positions[i] - m_positions[i - 1]));
+
+            if (m_heights[i - 1] < parabolic && parabolic < m_heights[i + 1])
+            {
+                m_heights[i] = parabolic;
+            }
+            else
+            {
+                int j = i + static_cast<int>(d);
+                m_heights[i] += d * (m_heights[j] - m_heights[i]) / (m_positions[j] - m_positions[i]);
+            }
+            m_positions[i] += d;
+        }
+    }
+}
+
+double EvolutionStatistics::QuantileSketch::get() const
+{
+    if (m_count == 0) return 0.0;
+    // Exact while the values are still all there
+    if (m_count <= 5)
+    {
+        size_t index = static_cast<size_t>(std::round(m_quantile * (m_count - 1)));
+        return m_heights[index];
+    }
+    return m_heights[2];
+}
+
+EvolutionStatistics::EvolutionStatistics(const Config& _config)
+    : m_config(_config),
+      m_log(nullptr),
+      m_median(0.5),
+      m_p90(0.9)
+{
+    m_config.populationSize = std::max(1, m_config.populationSize);
+    if (!m_config.logPath.empty())
+    {
+        m_log = std::fopen(m_config.logPath.c_str(), "w");
+        if (m_log)
+        {
+            std::fprintf(m_log, "seconds,evaluations,evaluationsPerSecond,results,meanFitness,stdDevFitness,minFitness,"
+                                "maxFitness,medianFitness,p90Fitness,bestFitness,species,meanHiddenNodes,meanConnections\n");
+        }
+        else
+        {
+            LOG_ERROR("Cannot open the statistics log {}", m_config.logPath);
+        }
+    }
+    reset();
+}
+
+EvolutionStatistics::~EvolutionStatistics()
+{
+    if (m_log) std::fclose(m_log);
+}
+
+void EvolutionStatistics::reset()
+{
+    m_start = std::chrono::steady_clock::now();
+    m_evaluations = 0;
+    m_bestFitness = 0.0;
+    m_species.clear();
+    resetWindow();
+}
+
+void EvolutionStatistics::resetWindow()
+{
+    m_windowStart = std::chrono::steady_clock::now();
+    m_fitness = RunningStats();
+    m_median.reset();
+    m_p90.reset();
+    m_hiddenNodes = RunningStats();
+    m_connections = RunningStats();
+    std::fill(m_hiddenNodeBins, m_hiddenNodeBins + NUM_COMPLEXITY_BINS, 0u);
+    std::fill(m_connectionBins, m_connectionBins + NUM_COMPLEXITY_BINS, 0u);
+    for (auto& species : m_species)
+    {
+        species.second.window = RunningStats();
+    }
+}
+
+int EvolutionStatistics::getComplexityBin(int _count)
+{
+    int bin = 0;
+    while (_count > 0 && bin < NUM_COMPLEXITY_BINS - 1)
+    {
+        _count >>= 1;
+        bin++;
+    }
+    return bin;
+}
+
+void EvolutionStatistics::addResult(const Genome& _genome, double _fitness)
+{
+    m_evaluations++;
+    m_bestFitness = m_evaluations == 1 ? _fitness : std::max(m_bestFitness, _fitness);
+
+    m_fitness.add(_fitness);
+    m_median.add(_fitness);
+    m_p90.add(_fitness);
+
+    int hiddenNodes = 0;
+    for (const auto& node : _genome.m_nodes)
+    {
+        if (!node.isInput && !node.isOutput) hiddenNodes++;
+    }
+    int connections = 0;
+    for (const auto& connection : _genome.m_connections)
+    {
+        if (connection.enabled) connections++;
+    }
+    m_hiddenNodes.add(hiddenNodes);
+    m_connections.add(connections);
+    m_hiddenNodeBins[getComplexityBin(hiddenNodes)]++;
+    m_connectionBins[getComplexityBin(connections)]++;
+
+    if (_genome.m_speciesId >= 0)
+    {
+        SpeciesTrack& species = m_species[_genome.m_speciesId];
+        species.window.add(_fitness);
+        if (!species.seen || _fitness > species.bestFitness)
+        {
+            species.bestFitness = _fitness;
+            species.improvedAt = m_evaluations;
+            species.seen = true;
+        }
+    }
+}
+
+bool EvolutionStatistics::isSnapshotDue() const
+{
+    if (m_config.snapshotIntervalMs <= 0 || m_fitness.count == 0) return false;
+    return std::chrono::steady_clock::now() - m_windowStart >= std::chrono::milliseconds(m_config.snapshotIntervalMs);
+}
+
+const EvolutionStatistics::Snapshot& EvolutionStatistics::takeSnapshot(const NEAT& _neat)
+{
+    auto now = std::chrono::steady_clock::now();
+    double windowSeconds = std::chrono::duration<double>(now - m_windowStart).count();
+
+    Snapshot& snapshot = m_snapshot;
+    snapshot.seconds = std::chrono::duration<double>(now - m_start).count();
+    snapshot.evaluations = m_evaluations;
+    snapshot.evaluationsPerSecond = windowSeconds > 0.0 ? m_fitness.count / windowSeconds : 0.0;
+    snapshot.bestFitness = m_bestFitness;
+    snapshot.fitness = m_fitness;
+    snapshot.medianFitness = m_median.get();
+    snapshot.p90Fitness = m_p90.get();
+    snapshot.hiddenNodes = m_hiddenNodes;
+    snapshot.connections = m_connections;
+    std::copy(m_hiddenNodeBins, m_hiddenNodeBins + NUM_COMPLEXITY_BINS, snapshot.hiddenNodeBins);
+    std::copy(m_connectionBins, m_connectionBins + NUM_COMPLEXITY_BINS, snapshot.connectionBins);
+
+    // A few dozen species at most, their genomes are not visited
+    snapshot.species.clear();
+    std::unordered_set<int> alive;
+    for (const Species* species : _neat.getSpecies())
+    {
+        SpeciesSnapshot entry;
+        entry.id = species->getId();
+        entry.size = static_cast<int>(species->getSize());
+        auto it = m_species.find(entry.id);
+        if (it != m_species.end())
+        {
+            const SpeciesTrack& track = it->second;
+            entry.staleness = static_cast<int>((m_evaluations - track.improvedAt) / m_config.populationSize);
+            entry.results = track.window.count;
+            entry.meanFitness = track.window.mean;
+            entry.maxFitness = track.window.max;
+        }
+        snapshot.species.push_back(entry);
+        alive.insert(entry.id);
+    }
+    std::sort(snapshot.species.begin(), snapshot.species.end(), [](const SpeciesSnapshot& _a, const SpeciesSnapshot& _b) {
+        return _a.id < _b.id;
+    });
+
+    // Forget species that are gone from the population
+    for (auto it = m_species.begin(); it != m_species.end(); )
+    {
+        if (alive.count(it->first)) ++it;
+        else it = m_species.erase(it);
+    }
+
+    writeLog(snapshot);
+    resetWindow();
+    return snapshot;
+}
+
+void EvolutionStatistics::writeLog(const Snapshot& _snapshot)
+{
+    if (!m_log) return;
+
+    std::fprintf(m_log, "%.3f,%llu,%.1f,%llu,%.2f,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f,%zu,%.2f,%.2f\n", _snapshot.seconds,
+                 static_cast<unsigned long long>(_snapshot.evaluations), _snapshot.evaluationsPerSecond,
+                 static_cast<unsigned long long>(_snapshot.fitness.count), _snapshot.fitness.mean, _snapshot.fitness.getStdDev(),
+                 _snapshot.fitness.min, _snapshot.fitness.max, _snapshot.medianFitness, _snapshot.p90Fitness,
+                 _snapshot.bestFitness, _snapshot.species.size(), _snapshot.hiddenNodes.mean, _snapshot.connections.mean);
+    // A run that is killed keeps everything up to its last snapshot
+    std::fflush(m_log);
+}
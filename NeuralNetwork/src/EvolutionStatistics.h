@@ -0,0 +1,136 @@
+// File: EvolutionStatistics.h
+// Description: Definition of the streaming evolution statistics. Every fitness result is folded in
+//              as it arrives: running mean and variance, P² quantile sketches, genome complexity
+//              histograms and per-species accumulators, so a snapshot never scans the population.
+//              Snapshots are taken at a throttled rate and appended to a time-series log.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef EVOLUTION_STATISTICS_H
+#define EVOLUTION_STATISTICS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdint>
+#include "NEAT.h"
+
+class EvolutionStatistics {
+public:
+    struct Config {
+        int snapshotIntervalMs = 1000;  // Minimum time between snapshots, 0 = never due
+        int populationSize = 150;       // Staleness is counted in populations' worth of evaluations
+        std::string logPath;            // One CSV line per snapshot, empty = no log
+    };
+
+    // Streaming mean and variance (Welford), minimum and maximum
+    struct RunningStats {
+        uint64_t count = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+
+        void add(double _value);
+        double getVariance() const { return count > 1 ? m2 / (count - 1) : 0.0; }
+        double getStdDev() const;
+    };
+
+    // P² estimate of one quantile (Jain and Chlamtac): five markers, constant memory and time
+    class QuantileSketch {
+    public:
+        explicit QuantileSketch(double _quantile = 0.5);
+        void add(double _value);
+        double get() const;
+        void reset();
+
+    private:
+        double m_quantile;
+        uint64_t m_count;
+        double m_heights[5];
+        double m_positions[5];
+        double m_desired[5];
+        double m_increments[5];
+    };
+
+    // Genomes by hidden nodes or enabled connections: 0, 1, 2-3, 4-7, ... the last bin takes the rest
+    static const int NUM_COMPLEXITY_BINS = 8;
+
+    struct SpeciesSnapshot {
+        int id = 0;
+        int size = 0;
+        int staleness = 0;              // Generations (populations' worth of evaluations) without a better result
+        uint64_t results = 0;           // Fitness results in the window
+        double meanFitness = 0.0;
+        double maxFitness = 0.0;
+    };
+
+    struct Snapshot {
+        double seconds = 0.0;           // Since reset()
+        uint64_t evaluations = 0;       // Since reset()
+        double evaluationsPerSecond = 0.0; // Over the window
+        double bestFitness = 0.0;       // Since reset()
+        // Results of the window, the time since the previous snapshot
+        RunningStats fitness;
+        double medianFitness = 0.0;
+        double p90Fitness = 0.0;
+        RunningStats hiddenNodes;
+        RunningStats connections;
+        uint32_t hiddenNodeBins[NUM_COMPLEXITY_BINS];
+        uint32_t connectionBins[NUM_COMPLEXITY_BINS];
+        std::vector<SpeciesSnapshot> species; // Every species of the population, by id
+    };
+
+    EvolutionStatistics(const Config& _config);
+    ~EvolutionStatistics();
+
+    // Start a new run: forget everything and restart the clock. The log is kept open.
+    void reset();
+
+    void addResult(const Genome& _genome, double _fitness);
+
+    // A result came in and snapshotIntervalMs passed since the last snapshot
+    bool isSnapshotDue() const;
+
+    // Close the window, read the size of every species from _neat (not its genomes), and append the
+    // snapshot to the log. The reference stays valid until the next call.
+    const Snapshot& takeSnapshot(const NEAT& _neat);
+
+    uint64_t getEvaluations() const { return m_evaluations; }
+    const Config& getConfig() const { return m_config; }
+
+private:
+    // Per species: the window's results, and the best result ever for staleness
+    struct SpeciesTrack {
+        RunningStats window;
+        double bestFitness = 0.0;
+        uint64_t improvedAt = 0;        // m_evaluations when bestFitness was set
+        bool seen = false;
+    };
+
+    Config m_config;
+    std::FILE* m_log;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_windowStart;
+    uint64_t m_evaluations;
+    double m_bestFitness;
+
+    RunningStats m_fitness;
+    QuantileSketch m_median;
+    QuantileSketch m_p90;
+    RunningStats m_hiddenNodes;
+    RunningStats m_connections;
+    uint32_t m_hiddenNodeBins[NUM_COMPLEXITY_BINS];
+    uint32_t m_connectionBins[NUM_COMPLEXITY_BINS];
+    std::unordered_map<int, SpeciesTrack> m_species;
+
+    Snapshot m_snapshot;
+
+    void resetWindow();
+    void writeLog(const Snapshot& _snapshot);
+    static int getComplexityBin(int _count);
+};
+
+#endif // EVOLUTION_STATISTICS_H
@@ -0,0 +1,70 @@
+// File: FitnessCache.cpp
+// Description: Implementation of the bounded LRU fitness cache
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include "FitnessCache.h"
+
+FitnessCache::FitnessCache(size_t _capacity)
+    : m_capacity(_capacity)
+{
+    m_index.reserve(_capacity);
+}
+
+FitnessCache::~FitnessCache()
+{
+}
+
+bool FitnessCache::find(uint64_t _hash, double& _fitness)
+{
+    auto it = m_index.find(_hash);
+    if (it == m_index.end())
+    {
+        m_stats.misses++;
+        return false;
+    }
+
+    // Move to the front so it is evicted last
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    _fitness = it->second->second;
+    m_stats.hits++;
+    return true;
+}
+
+void FitnessCache::insert(uint64_t _hash, double _fitness)
+{
+    if (m_capacity == 0) return;
+
+    auto it = m_index.find(_hash);
+    if (it != m_index.end())
+    {
+        it->second->second = _fitness;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+
+    m_entries.emplace_front(_hash, _fitness);
+    m_index[_hash] = m_entries.begin();
+    evict();
+}
+
+void FitnessCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+}
+
+void FitnessCache::setCapacity(size_t _capacity)
+{
+    m_capacity = _capacity;
+    evict();
+}
+
+void FitnessCache::evict()
+{
+    while (m_entries.size() > m_capacity)
+    {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
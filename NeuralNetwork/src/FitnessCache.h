@@ -0,0 +1,52 @@
+// File: FitnessCache.h
+// Description: Definition of a bounded LRU cache of fitness results keyed by genome hash
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef FITNESS_CACHE_H
+#define FITNESS_CACHE_H
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+class FitnessCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+
+        uint64_t getLookups() const { return hits + misses; }
+        double getHitRate() const { return getLookups() > 0 ? static_cast<double>(hits) / getLookups() : 0.0; }
+    };
+
+    // A capacity of 0 disables the cache: every lookup misses and nothing is stored
+    FitnessCache(size_t _capacity);
+    ~FitnessCache();
+
+    bool find(uint64_t _hash, double& _fitness);
+    void insert(uint64_t _hash, double _fitness);
+    void clear();
+
+    size_t getSize() const { return m_entries.size(); }
+    size_t getCapacity() const { return m_capacity; }
+    void setCapacity(size_t _capacity);
+
+    const Stats& getStats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+private:
+    // Most recently used entries at the front
+    typedef std::list<std::pair<uint64_t, double>> EntryList;
+
+    size_t m_capacity;
+    EntryList m_entries;
+    std::unordered_map<uint64_t, EntryList::iterator> m_index;
+    Stats m_stats;
+
+    void evict();
+};
+
+#endif // FITNESS_CACHE_H
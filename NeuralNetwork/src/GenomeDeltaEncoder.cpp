@@ -0,0 +1,302 @@
+// File: GenomeDeltaEncoder.cpp
+// Description: Implementation of the GenomeDeltaEncoder class
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include "GenomeDeltaEncoder.h"
+
+using json = nlohmann::json;
+
+namespace {
+    // Cost of each delta entry in JSON values
+    const int COST_CHANGED_VALUE = 2;   // id + value
+    const int COST_TOGGLED = 1;
+    const int COST_REMOVED = 1;
+    const int COST_NODE = 4;            // id, layer, type, bias
+    const int COST_CONNECTION = 5;      // fromNode, toNode, weight, enabled, innovationNumber
+    const int COST_DELTA_HEADER = 2;    // baseId and the per-array overhead
+
+    // Bases tried per genome: the parent, then the most recently used snapshots. Offspring are
+    // sent right after their parents were, so the close bases are there, and encoding costs at
+    // most this many deltaCost calls whatever the size of the client's cache.
+    const size_t MAX_BASE_CANDIDATES = 8;
+}
+
+GenomeDeltaEncoder::GenomeDeltaEncoder()
+    : m_capacity(0),
+      m_epoch(0)
+{
+}
+
+GenomeDeltaEncoder::~GenomeDeltaEncoder()
+{
+}
+
+void GenomeDeltaEncoder::reset(size_t _capacity)
+{
+    m_capacity = _capacity;
+    m_epoch++;
+    m_lru.clear();
+    m_snapshots.clear();
+}
+
+bool GenomeDeltaEncoder::encode(int _genomeId, const Genome& _genome, json& _delta, int _parentId)
+{
+    if (m_capacity == 0)
+    {
+        m_stats.fullGenomes++;
+        return false;
+    }
+
+    // Cheapest base among the candidates
+    int limit = fullCost(_genome);
+    int bestCost = limit;
+    int bestId = 0;
+    const Snapshot* best = nullptr;
+    auto consider = [&](int _baseId, const Snapshot& _base)
+    {
+        int cost = deltaCost(_base, _genome, bestCost);
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            bestId = _baseId;
+            best = &_base;
+        }
+    };
+
+    size_t candidates = 0;
+    auto parent = m_snapshots.find(_parentId);
+    if (parent != m_snapshots.end())
+    {
+        consider(parent->first, parent->second);
+        candidates++;
+    }
+    for (auto it = m_lru.begin(); it != m_lru.end() && candidates < MAX_BASE_CANDIDATES; ++it)
+    {
+        if (*it == _parentId) continue;
+        consider(*it, m_snapshots.find(*it)->second);
+        candidates++;
+    }
+
+    bool useDelta = best != nullptr;
+    if (useDelta)
+    {
+        _delta = buildDelta(_genomeId, bestId, *best, _genome);
+
+        // The client touches the base when it reads it, before storing the new genome
+        touch(m_snapshots[bestId]);
+        m_stats.deltaGenomes++;
+    }
+    else
+    {
+        m_stats.fullGenomes++;
+    }
+
+    insert(_genomeId, _genome);
+    return useDelta;
+}
+
+json GenomeDeltaEncoder::nodeToJSON(const Genome::NodeGene& _node)
+{
+    std::string type;
+    if (_node.isInput) type = "input";
+    else if (_node.isOutput) type = "output";
+    else type = "hidden";
+    // For visualization, try to infer layer: input=0, output=last, hidden=1 (or more if needed)
+    int layer = _node.isInput ? 0 : (_node.isOutput ? 2 : 1);
+    return {
+        {"id", _node.nodeId},
+        {"layer", layer},
+        {"type", type},
+        {"bias", _node.bias}
+    };
+}
+
+json GenomeDeltaEncoder::connectionToJSON(const Genome::ConnectionGene& _connection)
+{
+    return {
+        {"fromNode", _connection.fromNode},
+        {"toNode", _connection.toNode},
+        {"weight", _connection.weight},
+        {"enabled", _connection.enabled},
+        {"innovationNumber", _connection.innovationNumber}
+    };
+}
+
+json GenomeDeltaEncoder::genomeToJSON(const Genome& _genome, int _genomeId, int _numInputs, int _numOutputs)
+{
+    json nodes = json::array();
+    for (const auto& node : _genome.m_nodes)
+    {
+        nodes.push_back(nodeToJSON(node));
+    }
+    json connections = json::array();
+    for (const auto& connection : _genome.m_connections)
+    {
+        connections.push_back(connectionToJSON(connection));
+    }
+    return {
+        {"id", _genomeId},
+        {"numInputs", _numInputs},
+        {"numOutputs", _numOutputs},
+        {"nodes", std::move(nodes)},
+        {"connections", std::move(connections)}
+    };
+}
+
+int GenomeDeltaEncoder::deltaCost(const Snapshot& _base, const Genome& _genome, int _limit)
+{
+    int cost = COST_DELTA_HEADER;
+
+    size_t matchedNodes = 0;
+    for (const auto& node : _genome.m_nodes)
+    {
+        auto it = _base.nodeIndex.find(node.nodeId);
+        if (it == _base.nodeIndex.end())
+        {
+            cost += COST_NODE;
+        }
+        else
+        {
+            matchedNodes++;
+            if (_base.nodes[it->second].bias != node.bias) cost += COST_CHANGED_VALUE;
+        }
+        if (cost >= _limit) return cost;
+    }
+    cost += static_cast<int>(_base.nodes.size() - matchedNodes) * COST_REMOVED;
+
+    size_t matchedConnections = 0;
+    for (const auto& connection : _genome.m_connections)
+    {
+        auto it = _base.connectionIndex.find(connection.innovationNumber);
+        const Genome::ConnectionGene* baseConnection = it == _base.connectionIndex.end() ? nullptr : &_base.connections[it->second];
+        if (!baseConnection || baseConnection->fromNode != connection.fromNode || baseConnection->toNode != connection.toNode)
+        {
+            cost += COST_CONNECTION;
+        }
+        else
+        {
+            matchedConnections++;
+            if (baseConnection->weight != connection.weight) cost += COST_CHANGED_VALUE;
+            if (baseConnection->enabled != connection.enabled) cost += COST_TOGGLED;
+        }
+        if (cost >= _limit) return cost;
+    }
+    cost += static_cast<int>(_base.connections.size() - matchedConnections) * COST_REMOVED;
+
+    return cost;
+}
+
+int GenomeDeltaEncoder::fullCost(const Genome& _genome)
+{
+    return static_cast<int>(_genome.m_nodes.size()) * COST_NODE + static_cast<int>(_genome.m_connections.size()) * COST_CONNECTION;
+}
+
+json GenomeDeltaEncoder::buildDelta(int _genomeId, int _baseId, const Snapshot& _base, const Genome& _genome)
+{
+    json biases = json::array();
+    json weights = json::array();
+    json toggled = json::array();
+    json addedNodes = json::array();
+    json addedConnections = json::array();
+    json removedNodes = json::array();
+    json removedConnections = json::array();
+
+    std::vector<bool> keptNodes(_base.nodes.size(), false);
+    for (const auto& node : _genome.m_nodes)
+    {
+        auto it = _base.nodeIndex.find(node.nodeId);
+        if (it == _base.nodeIndex.end())
+        {
+            addedNodes.push_back(nodeToJSON(node));
+            continue;
+        }
+        keptNodes[it->second] = true;
+        if (_base.nodes[it->second].bias != node.bias)
+        {
+            biases.push_back(node.nodeId);
+            biases.push_back(node.bias);
+        }
+    }
+    for (size_t i = 0; i < _base.nodes.size(); ++i)
+    {
+        if (!keptNodes[i]) removedNodes.push_back(_base.nodes[i].nodeId);
+    }
+
+    std::vector<bool> keptConnections(_base.connections.size(), false);
+    for (const auto& connection : _genome.m_connections)
+    {
+        auto it = _base.connectionIndex.find(connection.innovationNumber);
+        if (it == _base.connectionIndex.end() ||
+            _base.connections[it->second].fromNode != connection.fromNode ||
+            _base.connections[it->second].toNode != connection.toNode)
+        {
+            addedConnections.push_back(connectionToJSON(connection));
+            continue;
+        }
+        keptConnections[it->second] = true;
+        const Genome::ConnectionGene& baseConnection = _base.connections[it->second];
+        if (baseConnection.weight != connection.weight)
+        {
+            weights.push_back(connection.innovationNumber);
+            weights.push_back(connection.weight);
+        }
+        if (baseConnection.enabled != connection.enabled)
+        {
+            toggled.push_back(connection.innovationNumber);
+        }
+    }
+    for (size_t i = 0; i < _base.connections.size(); ++i)
+    {
+        if (!keptConnections[i]) removedConnections.push_back(_base.connections[i].innovationNumber);
+    }
+
+    // Flat [id, value, id, value, ...] arrays; empty ones are left out
+    json delta;
+    delta["id"] = _genomeId;
+    delta["baseId"] = _baseId;
+    if (!biases.empty()) delta["biases"] = std::move(biases);
+    if (!weights.empty()) delta["weights"] = std::move(weights);
+    if (!toggled.empty()) delta["toggled"] = std::move(toggled);
+    if (!addedNodes.empty()) delta["addedNodes"] = std::move(addedNodes);
+    if (!addedConnections.empty()) delta["addedConnections"] = std::move(addedConnections);
+    if (!removedNodes.empty()) delta["removedNodes"] = std::move(removedNodes);
+    if (!removedConnections.empty()) delta["removedConnections"] = std::move(removedConnections);
+    return delta;
+}
+
+void GenomeDeltaEncoder::touch(Snapshot& _snapshot)
+{
+    m_lru.splice(m_lru.begin(), m_lru, _snapshot.lruPosition);
+}
+
+void GenomeDeltaEncoder::insert(int _genomeId, const Genome& _genome)
+{
+    // Genome ids can be reused once a genome is deleted; the client overwrites its entry the same way
+    auto existing = m_snapshots.find(_genomeId);
+    if (existing != m_snapshots.end())
+    {
+        m_lru.erase(existing->second.lruPosition);
+        m_snapshots.erase(existing);
+    }
+
+    m_lru.push_front(_genomeId);
+    Snapshot& snapshot = m_snapshots[_genomeId];
+    snapshot.nodes = _genome.m_nodes;
+    snapshot.connections = _genome.m_connections;
+    snapshot.lruPosition = m_lru.begin();
+    for (size_t i = 0; i < snapshot.nodes.size(); ++i)
+    {
+        snapshot.nodeIndex[snapshot.nodes[i].nodeId] = i;
+    }
+    for (size_t i = 0; i < snapshot.connections.size(); ++i)
+    {
+        snapshot.connectionIndex[snapshot.connections[i].innovationNumber] = i;
+    }
+
+    while (m_lru.size() > m_capacity)
+    {
+        m_snapshots.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+}
@@ -0,0 +1,79 @@
+// File: GenomeDeltaEncoder.h
+// Description: Definition of the GenomeDeltaEncoder class. It mirrors the LRU genome cache the web
+//              client advertises and encodes each genome as a delta against the closest of a few
+//              cached genomes, its parent and the most recent ones (changed weights/biases,
+//              toggled, added and removed genes).
+//              The client applies the same LRU updates in the same order, so both caches stay in sync.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef GENOME_DELTA_ENCODER_H
+#define GENOME_DELTA_ENCODER_H
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include "NEAT.h"
+
+class GenomeDeltaEncoder {
+public:
+    struct Stats {
+        uint64_t fullGenomes = 0;
+        uint64_t deltaGenomes = 0;
+    };
+
+    GenomeDeltaEncoder();
+    ~GenomeDeltaEncoder();
+
+    // The client (re)advertised a cache of _capacity genomes, empty at this point. 0 disables deltas.
+    // Starts a new cache epoch.
+    void reset(size_t _capacity);
+    size_t getCapacity() const { return m_capacity; }
+
+    // Number of resets so far. Genomes are sent tagged with it, so the client can tell the ones
+    // still in flight from before a reset, encoded against the cache it has since dropped.
+    int getEpoch() const { return m_epoch; }
+
+    // Record that _genome is being sent to the client as _genomeId. Returns true and fills _delta
+    // when a delta is smaller than the full genome; otherwise the caller sends the full genome.
+    // _parentId, the id its parent was sent as, is tried first as the base.
+    bool encode(int _genomeId, const Genome& _genome, nlohmann::json& _delta, int _parentId);
+
+    const Stats& getStats() const { return m_stats; }
+
+    // Wire format of single genes, shared with the full genome message
+    static nlohmann::json nodeToJSON(const Genome::NodeGene& _node);
+    static nlohmann::json connectionToJSON(const Genome::ConnectionGene& _connection);
+    // Full genome, sent to the client as _genomeId
+    static nlohmann::json genomeToJSON(const Genome& _genome, int _genomeId, int _numInputs, int _numOutputs);
+
+private:
+    // What the client holds for one genome id
+    struct Snapshot {
+        std::vector<Genome::NodeGene> nodes;
+        std::vector<Genome::ConnectionGene> connections;
+        std::unordered_map<int, size_t> nodeIndex;          // nodeId -> index
+        std::unordered_map<int, size_t> connectionIndex;    // innovationNumber -> index
+        std::list<int>::iterator lruPosition;
+    };
+
+    size_t m_capacity;
+    int m_epoch;
+    std::list<int> m_lru;   // Most recently used genome ids at the front
+    std::unordered_map<int, Snapshot> m_snapshots;
+    Stats m_stats;
+
+    // Wire cost of a delta from _base in JSON values, stops counting once it exceeds _limit.
+    // Linear in the genome size.
+    static int deltaCost(const Snapshot& _base, const Genome& _genome, int _limit);
+    static int fullCost(const Genome& _genome);
+    static nlohmann::json buildDelta(int _genomeId, int _baseId, const Snapshot& _base, const Genome& _genome);
+
+    void touch(Snapshot& _snapshot);
+    void insert(int _genomeId, const Genome& _genome);
+};
+
+#endif // GENOME_DELTA_ENCODER_H
@@ -0,0 +1,271 @@
+// File: HyperparameterSweep.cpp
+// Description: Implementation of the hyperparameter sweep runner
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "HyperparameterSweep.h"
+#include "Logger.h"
+
+HyperparameterSweep::HyperparameterSweep(const Config& _config)
+    : m_config(_config),
+      m_pool(std::max(1, _config.numThreads)),
+      m_runsFile(nullptr),
+      m_seriesFile(nullptr)
+{
+    // Every run evaluates inline on the pool thread that steps it
+    m_config.simulator.numThreads = 1;
+
+    // Both size or divide the per-generation bookkeeping
+    if (m_config.generations < 1)
+    {
+        LOG_WARNING("Sweep generations must be at least 1, got {}: using 1", m_config.generations);
+        m_config.generations = 1;
+    }
+    if (m_config.checkInterval < 1)
+    {
+        LOG_WARNING("Sweep check interval must be at least 1, got {}: using 1", m_config.checkInterval);
+        m_config.checkInterval = 1;
+    }
+}
+
+HyperparameterSweep::~HyperparameterSweep()
+{
+    if (m_runsFile) std::fclose(m_runsFile);
+    if (m_seriesFile) std::fclose(m_seriesFile);
+}
+
+std::vector<NEAT::Config> HyperparameterSweep::makeGrid(const NEAT::Config& _base, const Grid& _grid)
+{
+    std::vector<NEAT::Config> configs(1, _base);
+
+    // Expand one parameter at a time: every config so far times every value of the parameter
+    auto expand = [&configs](const std::vector<double>& _values, double NEAT::Config::* _field) {
+        if (_values.empty()) return;
+        std::vector<NEAT::Config> expanded;
+        expanded.reserve(configs.size() * _values.size());
+        for (const auto& config : configs)
+        {
+            for (double value : _values)
+            {
+                expanded.push_back(config);
+                expanded.back().*_field = value;
+            }
+        }
+        configs.swap(expanded);
+    };
+
+    expand(_grid.compatibilityThreshold, &NEAT::Config::compatibilityThreshold);
+    expand(_grid.weightMutationRate, &NEAT::Config::weightMutationRate);
+    expand(_grid.weightMutationPower, &NEAT::Config::weightMutationPower);
+    expand(_grid.toggleConnectionRate, &NEAT::Config::toggleConnectionRate);
+    expand(_grid.crossoverRate, &NEAT::Config::crossoverRate);
+    return configs;
+}
+
+HyperparameterSweep::Stats HyperparameterSweep::run()
+{
+    Stats stats;
+    auto start = std::chrono::steady_clock::now();
+
+    std::string runsPath = m_config.outputPrefix + "_runs.csv";
+    std::string seriesPath = m_config.outputPrefix + "_series.csv";
+    m_runsFile = std::fopen(runsPath.c_str(), "w");
+    m_seriesFile = std::fopen(seriesPath.c_str(), "w");
+    if (!m_runsFile || !m_seriesFile)
+    {
+        LOG_ERROR("Cannot open the sweep output files {} and {}", runsPath, seriesPath);
+    }
+    if (m_runsFile)
+    {
+        std::fprintf(m_runsFile, "run,compatibilityThreshold,weightMutationRate,weightMutationPower,toggleConnectionRate,"
+                                 "crossoverRate,generations,stoppedEarly,bestFitness,evaluations,seconds\n");
+    }
+    if (m_seriesFile)
+    {
+        std::fprintf(m_seriesFile, "run,generation,bestFitness,meanFitness,species\n");
+    }
+
+    size_t maxActiveRuns = m_config.maxActiveRuns > 0 ? m_config.maxActiveRuns : 4 * m_pool.getNumThreads();
+    std::vector<std::unique_ptr<Run>> active;
+    size_t nextRun = 0;
+    m_leaderFitness.assign(m_config.generations, 0.0);
+
+    while (true)
+    {
+        while (active.size() < maxActiveRuns && nextRun < m_config.runs.size())
+        {
+            active.push_back(startRun(static_cast<int>(nextRun++)));
+        }
+        if (active.empty()) break;
+
+        // One generation of every active run. Each thread pulls runs one at a time, so a slow run
+        // (long games, big genomes) only holds up its own thread.
+        std::atomic<size_t> nextActive(0);
+        m_pool.parallelFor(m_pool.getNumThreads(), [&](size_t, size_t) {
+            size_t i;
+            while ((i = nextActive++) < active.size())
+            {
+                if (!active[i]->finished) stepRun(*active[i]);
+            }
+        });
+
+        for (const auto& run : active)
+        {
+            double& leader = m_leaderFitness[run->generation - 1];
+            leader = std::max(leader, run->bestFitness);
+        }
+
+        for (size_t i = 0; i < active.size(); )
+        {
+            Run& run = *active[i];
+            checkDominance(run);
+            if (!run.finished)
+            {
+                ++i;
+                continue;
+            }
+
+            writeRun(run);
+            RunResult result;
+            result.index = run.index;
+            result.generations = run.generation;
+            result.stoppedEarly = run.stoppedEarly;
+            result.bestFitness = run.bestFitness;
+            result.evaluations = run.neat->getEvaluationCount();
+            result.seconds = run.seconds;
+            stats.runs.push_back(result);
+            stats.evaluations += result.evaluations;
+            stats.stoppedEarly += run.stoppedEarly;
+            if (stats.bestRun < 0 || result.bestFitness > stats.runs[stats.bestRun].bestFitness)
+            {
+                stats.bestRun = static_cast<int>(stats.runs.size() - 1);
+            }
+
+            LOG_INFO("Sweep run {}/{} {} at generation {}: best fitness {}", run.index + 1, m_config.runs.size(),
+                     run.stoppedEarly ? "stopped" : "finished", run.generation, run.bestFitness);
+            active.erase(active.begin() + i);
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+std::unique_ptr<HyperparameterSweep::Run> HyperparameterSweep::startRun(int _index)
+{
+    std::unique_ptr<Run> run(new Run());
+    run->index = _index;
+    NEAT::Config config = m_config.runs[_index];
+    // Generational reproduction is not implemented, runs evolve by steady-state replacement
+    config.steadyState = true;
+    run->neat.reset(new NEAT(config));
+    run->neat->setEvaluationSeeds(DinoSimulator::getEpisodeSeeds(m_config.simulator));
+    run->bestHistory.reserve(m_config.generations);
+    run->meanHistory.reserve(m_config.generations);
+    run->speciesHistory.reserve(m_config.generations);
+    return run;
+}
+
+void HyperparameterSweep::stepRun(Run& _run)
+{
+    auto start = std::chrono::steady_clock::now();
+    NEAT& neat = *_run.neat;
+
+    if (_run.generation == 0)
+    {
+        neat.initializePopulation();
+        _run.batch = neat.getPopulation();
+        evaluate(_run);
+    }
+
+    // Same schedule as the island model: a population's worth of offspring, a quarter at a time
+    int populationSize = neat.getConfig().populationSize;
+    size_t batchSize = static_cast<size_t>(std::max(1, populationSize / 4));
+    for (int produced = 0; produced < populationSize; )
+    {
+        _run.batch.clear();
+        while (_run.batch.size() < batchSize && produced < populationSize)
+        {
+            Genome* child = neat.replaceWorst();
+            if (!child) break;
+            _run.batch.push_back(child);
+            produced++;
+        }
+        if (_run.batch.empty()) break;
+        evaluate(_run);
+    }
+
+    double sum = 0.0;
+    for (const Genome* genome : neat.getPopulation())
+    {
+        sum += genome->getFitness();
+    }
+    _run.bestHistory.push_back(static_cast<float>(_run.bestFitness));
+    _run.meanHistory.push_back(static_cast<float>(neat.getPopulation().empty() ? 0.0 : sum / neat.getPopulation().size()));
+    _run.speciesHistory.push_back(static_cast<uint16_t>(std::min<size_t>(neat.getNumSpecies(), UINT16_MAX)));
+
+    _run.generation++;
+    if (_run.generation >= m_config.generations) _run.finished = true;
+    _run.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void HyperparameterSweep::evaluate(Run& _run)
+{
+    if (m_config.simulator.episodes > 1)
+    {
+        const DinoSimulator::Config& simulator = m_config.simulator;
+        _run.neat->evaluateEpisodes(_run.batch, [&simulator](const std::vector<Genome*>& _batch, unsigned int _seed, std::vector<double>& _scores) {
+            DinoSimulator::evaluateEpisode(_batch, simulator, _seed, _scores);
+        });
+    }
+    else
+    {
+        DinoSimulator::evaluateGenomes(_run.batch, m_config.simulator);
+        for (Genome* genome : _run.batch)
+        {
+            _run.neat->reportFitness(genome, genome->getFitness());
+        }
+    }
+
+    for (Genome* genome : _run.batch)
+    {
+        _run.bestFitness = std::max(_run.bestFitness, genome->getFitness());
+    }
+}
+
+void HyperparameterSweep::checkDominance(Run& _run)
+{
+    if (_run.finished || _run.generation < m_config.minGenerations || _run.generation % m_config.checkInterval != 0) return;
+
+    if (_run.bestFitness < m_config.dominanceRatio * m_leaderFitness[_run.generation - 1])
+    {
+        _run.stoppedEarly = true;
+        _run.finished = true;
+    }
+}
+
+void HyperparameterSweep::writeRun(const Run& _run)
+{
+    const NEAT::Config& config = _run.neat->getConfig();
+    if (m_runsFile)
+    {
+        std::fprintf(m_runsFile, "%d,%g,%g,%g,%g,%g,%d,%d,%.1f,%llu,%.2f\n", _run.index,
+                     config.compatibilityThreshold, config.weightMutationRate, config.weightMutationPower,
+                     config.toggleConnectionRate, config.crossoverRate, _run.generation, _run.stoppedEarly ? 1 : 0,
+                     _run.bestFitness, _run.neat->getEvaluationCount(), _run.seconds);
+        std::fflush(m_runsFile);
+    }
+    if (m_seriesFile)
+    {
+        for (size_t g = 0; g < _run.bestHistory.size(); ++g)
+        {
+            std::fprintf(m_seriesFile, "%d,%zu,%.1f,%.1f,%u\n", _run.index, g + 1, _run.bestHistory[g],
+                         _run.meanHistory[g], static_cast<unsigned>(_run.speciesHistory[g]));
+        }
+        // Finished runs survive a crash or an interrupted overnight sweep
+        std::fflush(m_seriesFile);
+    }
+}
@@ -0,0 +1,103 @@
+// File: HyperparameterSweep.h
+// Description: Definition of the hyperparameter sweep runner. Many independent NEAT runs with
+//              different configurations evolve in one process against the native simulator,
+//              sharing a single worker pool. Runs that fall clearly behind the leader are stopped
+//              early, and every run's progress is written to a per-generation time series.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef HYPERPARAMETER_SWEEP_H
+#define HYPERPARAMETER_SWEEP_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include "NEAT.h"
+#include "DinoSimulator.h"
+#include "ThreadPool.h"
+
+class HyperparameterSweep {
+public:
+    struct Config {
+        std::vector<NEAT::Config> runs;
+        int generations = 100;          // Per run, at least 1. A generation is one population's worth of offspring.
+        int numThreads = 1;             // Shared by every run
+        int maxActiveRuns = 0;          // Runs evolving at the same time, 0 = 4 per thread
+        // Early stopping: from minGenerations on, every checkInterval generations, a run whose best
+        // score is under dominanceRatio times the best any run had at the same generation is stopped
+        int minGenerations = 10;
+        int checkInterval = 5;          // At least 1
+        double dominanceRatio = 0.5;
+        std::string outputPrefix = "sweep"; // <prefix>_runs.csv and <prefix>_series.csv
+        DinoSimulator::Config simulator;
+    };
+
+    // Values tried for each parameter; the sweep covers every combination. Only parameters the
+    // steady-state engine reads: add-node/connection mutations are not implemented and culling
+    // belongs to generational reproduction.
+    struct Grid {
+        std::vector<double> compatibilityThreshold;
+        std::vector<double> weightMutationRate;
+        std::vector<double> weightMutationPower;
+        std::vector<double> toggleConnectionRate;
+        std::vector<double> crossoverRate;
+    };
+
+    struct RunResult {
+        int index = 0;
+        int generations = 0;
+        bool stoppedEarly = false;
+        double bestFitness = 0.0;
+        uint64_t evaluations = 0;
+        double seconds = 0.0;           // Time spent evolving this run, summed over threads
+    };
+
+    struct Stats {
+        std::vector<RunResult> runs;
+        int stoppedEarly = 0;
+        int bestRun = -1;               // Position in runs, -1 when nothing ran
+        uint64_t evaluations = 0;
+        double seconds = 0.0;
+    };
+
+    HyperparameterSweep(const Config& _config);
+    ~HyperparameterSweep();
+
+    // Every combination of _grid applied on top of _base. An empty list keeps the base value.
+    static std::vector<NEAT::Config> makeGrid(const NEAT::Config& _base, const Grid& _grid);
+
+    // Evolve every run, at most maxActiveRuns at a time. Blocks until the sweep is over.
+    Stats run();
+
+private:
+    struct Run {
+        int index;
+        std::unique_ptr<NEAT> neat;
+        std::vector<Genome*> batch;
+        int generation = 0;
+        double bestFitness = 0.0;
+        double seconds = 0.0;
+        bool finished = false;
+        bool stoppedEarly = false;
+        // One sample per generation: best score so far, mean score of the population, species
+        std::vector<float> bestHistory;
+        std::vector<float> meanHistory;
+        std::vector<uint16_t> speciesHistory;
+    };
+
+    Config m_config;
+    ThreadPool m_pool;
+    std::vector<double> m_leaderFitness;   // Best score reached by any run at each generation
+    std::FILE* m_runsFile;
+    std::FILE* m_seriesFile;
+
+    std::unique_ptr<Run> startRun(int _index);
+    void stepRun(Run& _run);
+    void evaluate(Run& _run);
+    void checkDominance(Run& _run);
+    void writeRun(const Run& _run);
+};
+
+#endif // HYPERPARAMETER_SWEEP_H
@@ -0,0 +1,188 @@
+// File: IslandModel.cpp
+// Description: Implementation of the island model
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "IslandModel.h"
+#include "Logger.h"
+
+IslandModel::Island::Island(const NEAT::Config& _config, const DinoSimulator::Config& _simulator)
+    : neat(new NEAT(_config))
+{
+    neat->setEvaluationSeeds(DinoSimulator::getEpisodeSeeds(_simulator));
+}
+
+IslandModel::IslandModel(const Config& _config)
+    : m_config(_config)
+{
+    // The islands evolve with steady-state replacement, generational reproduction is not implemented
+    m_config.neat.steadyState = true;
+    m_config.simulator.numThreads = 1;
+    if (m_config.neat.noveltySearch && m_config.simulator.behaviourObstacles <= 0)
+    {
+        m_config.simulator.behaviourObstacles = 8;
+    }
+}
+
+IslandModel::~IslandModel()
+{
+}
+
+IslandModel::Stats IslandModel::run()
+{
+    m_islands.clear();
+    for (int i = 0; i < std::max(1, m_config.numIslands); ++i)
+    {
+        m_islands.emplace_back(new Island(m_config.neat, m_config.simulator));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < m_islands.size(); ++i)
+    {
+        threads.emplace_back(&IslandModel::runIsland, this, i);
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    Stats stats;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& island : m_islands)
+    {
+        stats.islands.push_back(island->stats);
+        stats.evaluations += island->stats.evaluations;
+        stats.bestFitness = std::max(stats.bestFitness, island->stats.bestFitness);
+    }
+    return stats;
+}
+
+const Genome* IslandModel::getBestGenome() const
+{
+    const Genome* best = nullptr;
+    for (const auto& island : m_islands)
+    {
+        const Genome* candidate = island->neat->getBestGenome();
+        if (candidate && (!best || candidate->getFitness() > best->getFitness())) best = candidate;
+    }
+    return best;
+}
+
+void IslandModel::runIsland(size_t _index)
+{
+    Island& island = *m_islands[_index];
+    Island& neighbour = *m_islands[(_index + 1) % m_islands.size()];
+    NEAT& neat = *island.neat;
+    auto start = std::chrono::steady_clock::now();
+
+    neat.initializePopulation();
+    std::vector<Genome*> batch(neat.getPopulation());
+    evaluate(island, batch);
+
+    // Offspring are simulated a quarter of a population at a time: enough dinos per run to keep
+    // the simulator efficient, while later offspring still come from updated parents
+    int populationSize = m_config.neat.populationSize;
+    size_t batchSize = static_cast<size_t>(std::max(1, populationSize / 4));
+
+    for (int generation = 1; generation <= m_config.generations; ++generation)
+    {
+        for (int produced = 0; produced < populationSize; )
+        {
+            batch.clear();
+            while (batch.size() < batchSize && produced < populationSize)
+            {
+                Genome* child = neat.replaceWorst();
+                if (!child) break;
+                batch.push_back(child);
+                produced++;
+            }
+            if (batch.empty()) break;
+            evaluate(island, batch);
+        }
+
+        if (m_config.migrationInterval > 0 && generation % m_config.migrationInterval == 0 && m_islands.size() > 1)
+        {
+            emigrate(island, neighbour);
+            LOG_INFO("Island {} generation {}: best fitness {}", _index, generation, island.stats.bestFitness);
+        }
+        immigrate(island);
+    }
+
+    island.stats.evaluations = neat.getEvaluationCount();
+    island.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void IslandModel::evaluate(Island& _island, const std::vector<Genome*>& _genomes)
+{
+    // Several courses per genome, aggregated and reported by NEAT. Novelty search plays one.
+    const bool multiEpisode = m_config.simulator.episodes > 1 && !m_config.neat.noveltySearch;
+    if (multiEpisode)
+    {
+        const DinoSimulator::Config& simulator = m_config.simulator;
+        _island.neat->evaluateEpisodes(_genomes, [&simulator](const std::vector<Genome*>& _batch, unsigned int _seed, std::vector<double>& _scores) {
+            DinoSimulator::evaluateEpisode(_batch, simulator, _seed, _scores);
+        });
+    }
+    else
+    {
+        DinoSimulator::evaluateGenomes(_genomes, m_config.simulator, m_config.neat.noveltySearch ? &_island.behaviours : nullptr);
+    }
+
+    // bestFitness is the game score in every mode, novelty search only changes what is selected on
+    for (Genome* genome : _genomes)
+    {
+        _island.stats.bestFitness = std::max(_island.stats.bestFitness, genome->getFitness());
+    }
+
+    if (multiEpisode) return;
+    if (m_config.neat.noveltySearch)
+    {
+        _island.neat->reportBehaviours(_genomes, _island.behaviours);
+        return;
+    }
+    for (Genome* genome : _genomes)
+    {
+        _island.neat->reportFitness(genome, genome->getFitness());
+    }
+}
+
+void IslandModel::emigrate(Island& _island, Island& _neighbour)
+{
+    std::vector<Genome*> candidates;
+    for (Genome* genome : _island.neat->getPopulation())
+    {
+        if (genome->m_evaluated) candidates.push_back(genome);
+    }
+
+    size_t count = std::min(candidates.size(), static_cast<size_t>(std::max(0, m_config.migrantsPerMigration)));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+        [](const Genome* a, const Genome* b) { return a->getFitness() > b->getFitness(); });
+
+    // Copies: the genomes stay on this island too
+    std::lock_guard<std::mutex> lock(_neighbour.inboxMutex);
+    for (size_t i = 0; i < count; ++i)
+    {
+        _neighbour.inbox.push_back(*candidates[i]);
+    }
+    _island.stats.migrantsSent += count;
+}
+
+void IslandModel::immigrate(Island& _island)
+{
+    std::vector<Genome> migrants;
+    {
+        std::lock_guard<std::mutex> lock(_island.inboxMutex);
+        migrants.swap(_island.inbox);
+    }
+    for (const Genome& migrant : migrants)
+    {
+        if (_island.neat->importGenome(migrant))
+        {
+            _island.stats.migrantsReceived++;
+        }
+    }
+}
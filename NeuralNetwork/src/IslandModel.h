@@ -0,0 +1,78 @@
+// File: IslandModel.h
+// Description: Definition of the island model. K independent NEAT instances (islands) evolve on
+//              their own threads with the native simulator, and every M generations each island
+//              sends copies of its best genomes to the inbox of the next island of a ring. Migrants
+//              are renumbered to the receiving island's innovations on arrival. Islands never wait
+//              on each other, so throughput scales with the number of cores.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef ISLAND_MODEL_H
+#define ISLAND_MODEL_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "NEAT.h"
+#include "DinoSimulator.h"
+
+class IslandModel {
+public:
+    struct Config {
+        int numIslands = 4;
+        int generations = 50;           // Per island. A generation is one population's worth of offspring.
+        int migrationInterval = 5;      // Generations between two migrations, 0 disables migration
+        int migrantsPerMigration = 2;   // Best genomes copied to the next island
+        NEAT::Config neat;              // Used by every island
+        DinoSimulator::Config simulator;
+    };
+
+    struct IslandStats {
+        uint64_t evaluations = 0;
+        uint64_t migrantsSent = 0;
+        uint64_t migrantsReceived = 0;
+        double bestFitness = 0.0;
+        double seconds = 0.0;
+    };
+
+    struct Stats {
+        std::vector<IslandStats> islands;
+        uint64_t evaluations = 0;
+        double bestFitness = 0.0;
+        double seconds = 0.0;
+
+        double getEvaluationsPerSecond() const { return seconds > 0.0 ? evaluations / seconds : 0.0; }
+    };
+
+    IslandModel(const Config& _config);
+    ~IslandModel();
+
+    // Evolve every island for the configured number of generations, one thread per island
+    Stats run();
+
+    // Best genome over all islands, valid until the next run()
+    const Genome* getBestGenome() const;
+
+private:
+    struct Island {
+        std::unique_ptr<NEAT> neat;
+        IslandStats stats;
+        // Migrants waiting to be imported. Only touched once per generation, a lock is cheap here.
+        std::mutex inboxMutex;
+        std::vector<Genome> inbox;
+        std::vector<float> behaviours;  // Novelty search: descriptors of the batch being evaluated
+
+        Island(const NEAT::Config& _config, const DinoSimulator::Config& _simulator);
+    };
+
+    Config m_config;
+    std::vector<std::unique_ptr<Island>> m_islands;
+
+    void runIsland(size_t _index);
+    void evaluate(Island& _island, const std::vector<Genome*>& _genomes);
+    void emigrate(Island& _island, Island& _neighbour);
+    void immigrate(Island& _island);
+};
+
+#endif // ISLAND_MODEL_H
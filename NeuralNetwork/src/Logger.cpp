@@ -0,0 +1,302 @@
+// File: Logger.cpp
+// Description: Implementation of the asynchronous logger and its background writer
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "Logger.h"
+
+namespace {
+    const char* levelName(int _level)
+    {
+        switch (_level)
+        {
+        case Logger::LEVEL_DEBUG: return "DEBUG";
+        case Logger::LEVEL_INFO: return "INFO";
+        case Logger::LEVEL_WARNING: return "WARN";
+        default: return "ERROR";
+        }
+    }
+
+    int64_t steadyNow()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    // Thread-local owner of a thread's ring, retires it when the thread exits
+    template <typename Buffer>
+    struct BufferOwner
+    {
+        Buffer* buffer = nullptr;
+
+        ~BufferOwner()
+        {
+            if (buffer) buffer->retire();
+        }
+    };
+}
+
+void Logger::Record::addText(const char* _text, size_t _length)
+{
+    if (numArgs == MAX_ARGS) return;
+
+    size_t length = std::min(_length, static_cast<size_t>(MAX_TEXT - textUsed));
+    std::memcpy(text + textUsed, _text, length);
+
+    argTypes[numArgs] = ARG_TEXT;
+    args[numArgs++].text = (static_cast<uint32_t>(textUsed) << 16) | static_cast<uint32_t>(length);
+    textUsed = static_cast<uint16_t>(textUsed + length);
+}
+
+Logger::ThreadBuffer::ThreadBuffer(size_t _capacity, int _threadIndex)
+    : m_threadIndex(_threadIndex),
+      m_pendingHead(0),
+      m_retired(false),
+      m_head(0),
+      m_tail(0)
+{
+    size_t capacity = 2;
+    while (capacity < _capacity) capacity <<= 1;
+    m_records.resize(capacity);
+    m_mask = capacity - 1;
+}
+
+Logger::Record* Logger::ThreadBuffer::beginWrite()
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) > m_mask) return nullptr;
+
+    m_pendingHead = head + 1;
+    return &m_records[head & m_mask];
+}
+
+bool Logger::ThreadBuffer::read(Record& _record)
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire)) return false;
+
+    _record = m_records[tail & m_mask];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+Logger& Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_minLevel(LEVEL_DEBUG),
+      m_startTime(std::chrono::steady_clock::now()),
+      m_running(false),
+      m_nextThreadIndex(0),
+      m_file(nullptr),
+      m_logged(0),
+      m_dropped(0),
+      m_suppressed(0),
+      m_written(0)
+{
+}
+
+Logger::~Logger()
+{
+    stop();
+}
+
+void Logger::start(const Config& _config)
+{
+    stop();
+
+    m_config = _config;
+    m_minLevel.store(_config.minLevel, std::memory_order_relaxed);
+    m_startTime = std::chrono::steady_clock::now();
+
+    if (!m_config.filePath.empty())
+    {
+        m_file = std::fopen(m_config.filePath.c_str(), "w");
+        if (!m_file)
+        {
+            std::cerr << "Could not open log file " << m_config.filePath << ", logging to the console only" << std::endl;
+        }
+    }
+
+    m_running = true;
+    m_writer = std::thread(&Logger::writerLoop, this);
+}
+
+void Logger::stop()
+{
+    if (!m_running.exchange(false)) return;
+
+    m_writer.join();
+    drain();
+
+    if (m_file)
+    {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+Logger::Stats Logger::getStats() const
+{
+    Stats stats;
+    stats.logged = m_logged.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.suppressed = m_suppressed.load(std::memory_order_relaxed);
+    stats.written = m_written.load(std::memory_order_relaxed);
+    return stats;
+}
+
+Logger::ThreadBuffer* Logger::getThreadBuffer()
+{
+    // Registered once per thread, the only time a log call takes a lock
+    thread_local BufferOwner<ThreadBuffer> owner;
+    if (!owner.buffer)
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        m_buffers.emplace_back(new ThreadBuffer(m_config.recordsPerThread, m_nextThreadIndex++));
+        owner.buffer = m_buffers.back().get();
+    }
+    return owner.buffer;
+}
+
+void Logger::writerLoop()
+{
+    while (m_running.load())
+    {
+        if (!drain())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_config.flushIntervalMs));
+        }
+    }
+}
+
+bool Logger::drain()
+{
+    m_pending.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        PendingRecord pending;
+        bool anyRetired = false;
+        for (auto& buffer : m_buffers)
+        {
+            // Checked before reading: a retired ring gets no more writes, so this drains it for good
+            bool retired = buffer->isRetired();
+            pending.threadIndex = buffer->getThreadIndex();
+            while (buffer->read(pending.record))
+            {
+                m_pending.push_back(pending);
+            }
+            if (retired)
+            {
+                buffer.reset();
+                anyRetired = true;
+            }
+        }
+        if (anyRetired)
+        {
+            m_buffers.erase(std::remove(m_buffers.begin(), m_buffers.end(), nullptr), m_buffers.end());
+        }
+    }
+    if (m_pending.empty()) return false;
+
+    // Interleave the threads back into call order
+    std::stable_sort(m_pending.begin(), m_pending.end(), [](const PendingRecord& _a, const PendingRecord& _b) {
+        return _a.record.timestamp < _b.record.timestamp;
+    });
+
+    std::string line;
+    bool echoed = false;
+    for (const auto& pending : m_pending)
+    {
+        formatRecord(pending, line);
+        if (m_file)
+        {
+            std::fwrite(line.data(), 1, line.size(), m_file);
+        }
+        if (pending.record.level >= m_config.consoleLevel)
+        {
+            std::ostream& console = pending.record.level >= LEVEL_WARNING ? std::cerr : std::cout;
+            console.write(line.data(), line.size());
+            echoed = true;
+        }
+    }
+
+    // One flush per batch instead of one per line
+    if (m_file) std::fflush(m_file);
+    if (echoed) std::cout.flush();
+
+    m_written.fetch_add(m_pending.size(), std::memory_order_relaxed);
+    return true;
+}
+
+void Logger::formatRecord(const PendingRecord& _pending, std::string& _line) const
+{
+    const Record& record = _pending.record;
+    char number[64];
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::duration(record.timestamp) - m_startTime.time_since_epoch()).count();
+    std::snprintf(number, sizeof(number), "[%10.3f] [T%d] %-5s ", seconds, _pending.threadIndex, levelName(record.level));
+    _line.assign(number);
+
+    // Substitute "{}" placeholders in order; extra placeholders are kept as-is
+    int arg = 0;
+    for (const char* c = record.format; *c; ++c)
+    {
+        if (c[0] != '{' || c[1] != '}' || arg >= record.numArgs)
+        {
+            _line.push_back(*c);
+            continue;
+        }
+
+        switch (record.argTypes[arg])
+        {
+        case ARG_INT:
+            std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(record.args[arg].i));
+            _line.append(number);
+            break;
+        case ARG_UINT:
+            std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(record.args[arg].u));
+            _line.append(number);
+            break;
+        case ARG_DOUBLE:
+            std::snprintf(number, sizeof(number), "%g", record.args[arg].d);
+            _line.append(number);
+            break;
+        case ARG_BOOL:
+            _line.append(record.args[arg].u ? "true" : "false");
+            break;
+        case ARG_TEXT:
+            _line.append(record.text + (record.args[arg].text >> 16), record.args[arg].text & 0xFFFF);
+            break;
+        }
+        ++arg;
+        ++c;
+    }
+    _line.push_back('\n');
+}
+
+RateLimiter::RateLimiter(int _perSecond)
+    : m_perSecond(_perSecond),
+      m_windowStart(steadyNow()),
+      m_count(0)
+{
+}
+
+bool RateLimiter::allow()
+{
+    const int64_t oneSecond = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)).count();
+
+    int64_t now = steadyNow();
+    int64_t windowStart = m_windowStart.load(std::memory_order_relaxed);
+    if (now - windowStart >= oneSecond && m_windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+    {
+        m_count.store(0, std::memory_order_relaxed);
+    }
+
+    return m_count.fetch_add(1, std::memory_order_relaxed) < m_perSecond;
+}
@@ -0,0 +1,240 @@
+// File: Logger.h
+// Description: Definition of the asynchronous logger. A log call only copies its format pointer and
+//              raw arguments into a lock-free ring owned by the calling thread; a background writer
+//              formats the records and writes them to the log file (and console), so hot paths never
+//              block on I/O. Formats use "{}" placeholders, e.g. LOG_INFO("Genome {} fitness: {}", id, f).
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class Logger {
+public:
+    // Prefixed because <windows.h> defines ERROR
+    enum Level { LEVEL_DEBUG, LEVEL_INFO, LEVEL_WARNING, LEVEL_ERROR };
+
+    struct Config {
+        std::string filePath = "neat_server.log";   // Empty to disable the log file
+        Level minLevel = LEVEL_DEBUG;                // Records below this level are not even queued
+        Level consoleLevel = LEVEL_INFO;             // Records at or above this level are echoed to the console
+        size_t recordsPerThread = 4096;              // Ring size for each logging thread
+        int flushIntervalMs = 5;
+    };
+
+    struct Stats {
+        uint64_t logged = 0;        // Records queued
+        uint64_t dropped = 0;       // Records lost because a thread's ring was full
+        uint64_t suppressed = 0;    // Records skipped by sampling or rate limiting
+        uint64_t written = 0;       // Records formatted by the writer
+    };
+
+    static const int MAX_ARGS = 8;
+    static const int MAX_TEXT = 96;
+
+    static Logger& instance();
+
+    void start(const Config& _config);
+    // Drain every queued record and stop the writer
+    void stop();
+
+    bool isEnabled(Level _level) const { return _level >= m_minLevel.load(std::memory_order_relaxed); }
+
+    template <typename... Args>
+    void log(Level _level, const char* _format, const Args&... _args)
+    {
+        if (!isEnabled(_level)) return;
+
+        ThreadBuffer* buffer = getThreadBuffer();
+        Record* record = buffer->beginWrite();
+        if (!record)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        record->timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        record->format = _format;
+        record->level = static_cast<uint8_t>(_level);
+        record->numArgs = 0;
+        record->textUsed = 0;
+        int unpack[] = { 0, (record->addArg(_args), 0)... };
+        (void)unpack;
+
+        buffer->endWrite();
+        m_logged.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void addSuppressed(uint64_t _count) { m_suppressed.fetch_add(_count, std::memory_order_relaxed); }
+    Stats getStats() const;
+
+private:
+    enum ArgType : uint8_t { ARG_INT, ARG_UINT, ARG_DOUBLE, ARG_BOOL, ARG_TEXT };
+
+    // One log call, stored unformatted
+    struct Record {
+        int64_t timestamp;
+        const char* format;
+        uint8_t level;
+        uint8_t numArgs;
+        uint16_t textUsed;
+        ArgType argTypes[MAX_ARGS];
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+            uint32_t text;      // Offset and length packed as (offset << 16) | length
+        } args[MAX_ARGS];
+        char text[MAX_TEXT];
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type addArg(const T& _value)
+        {
+            if (numArgs == MAX_ARGS) return;
+            argTypes[numArgs] = ARG_INT;
+            args[numArgs++].i = _value;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value && !std::is_same<T, bool>::value>::type addArg(const T& _value)
+        {
+            if (numArgs == MAX_ARGS) return;
+            argTypes[numArgs] = ARG_UINT;
+            args[numArgs++].u = _value;
+        }
+
+        template <typename T>
+        typename std::enable_if<std::is_floating_point<T>::value>::type addArg(const T& _value)
+        {
+            if (numArgs == MAX_ARGS) return;
+            argTypes[numArgs] = ARG_DOUBLE;
+            args[numArgs++].d = _value;
+        }
+
+        void addArg(const bool& _value)
+        {
+            if (numArgs == MAX_ARGS) return;
+            argTypes[numArgs] = ARG_BOOL;
+            args[numArgs++].u = _value ? 1 : 0;
+        }
+
+        // Strings are the only arguments copied by value, truncated to the space left
+        void addArg(const char* _value) { addText(_value, std::char_traits<char>::length(_value)); }
+        void addArg(const std::string& _value) { addText(_value.data(), _value.size()); }
+        template <size_t N>
+        void addArg(const char (&_value)[N]) { addText(_value, std::char_traits<char>::length(_value)); }
+
+        void addText(const char* _text, size_t _length);
+    };
+
+    // Single-producer (owning thread) / single-consumer (writer) ring of records
+    class ThreadBuffer {
+    public:
+        ThreadBuffer(size_t _capacity, int _threadIndex);
+
+        Record* beginWrite();
+        void endWrite() { m_head.store(m_pendingHead, std::memory_order_release); }
+        bool read(Record& _record);
+
+        int getThreadIndex() const { return m_threadIndex; }
+
+        // Set when the owning thread exits, after its last write. The writer frees the ring once drained.
+        void retire() { m_retired.store(true, std::memory_order_release); }
+        bool isRetired() const { return m_retired.load(std::memory_order_acquire); }
+
+    private:
+        std::vector<Record> m_records;
+        size_t m_mask;
+        int m_threadIndex;
+        size_t m_pendingHead;
+        std::atomic<bool> m_retired;
+
+        // Padded rather than alignas: heap-allocated, and C++14 new ignores extended alignment
+        std::atomic<size_t> m_head;
+        char m_headPadding[64 - sizeof(std::atomic<size_t>)];
+        std::atomic<size_t> m_tail;
+    };
+
+    struct PendingRecord {
+        Record record;
+        int threadIndex;
+    };
+
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    ThreadBuffer* getThreadBuffer();
+    void writerLoop();
+    bool drain();
+    void formatRecord(const PendingRecord& _pending, std::string& _line) const;
+
+    std::atomic<int> m_minLevel;
+    Config m_config;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    // One ring per live thread: a thread's ring is retired when it exits and freed by drain() once
+    // empty, so short-lived threads (one per WebSocket connection) do not accumulate rings
+    std::mutex m_buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+    int m_nextThreadIndex;
+
+    std::thread m_writer;
+    std::atomic<bool> m_running;
+    std::FILE* m_file;
+    std::vector<PendingRecord> m_pending;
+
+    std::atomic<uint64_t> m_logged;
+    std::atomic<uint64_t> m_dropped;
+    std::atomic<uint64_t> m_suppressed;
+    std::atomic<uint64_t> m_written;
+};
+
+// Lets at most a fixed number of events per second through; the rest are counted as suppressed
+class RateLimiter {
+public:
+    RateLimiter(int _perSecond);
+
+    bool allow();
+
+private:
+    int m_perSecond;
+    std::atomic<int64_t> m_windowStart;
+    std::atomic<int> m_count;
+};
+
+#define LOG_DEBUG(...)   Logger::instance().log(Logger::LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)    Logger::instance().log(Logger::LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARNING(...) Logger::instance().log(Logger::LEVEL_WARNING, __VA_ARGS__)
+#define LOG_ERROR(...)   Logger::instance().log(Logger::LEVEL_ERROR, __VA_ARGS__)
+
+// Per-event logging for hot paths: keep one call in _n from this call site
+#define LOG_EVERY_N(_level, _n, ...) \
+    do { \
+        static std::atomic<uint64_t> logEveryNCounter(0); \
+        if (logEveryNCounter.fetch_add(1, std::memory_order_relaxed) % (_n) == 0) Logger::instance().log(_level, __VA_ARGS__); \
+        else Logger::instance().addSuppressed(1); \
+    } while (0)
+
+// Per-event logging for hot paths: at most _perSecond records per second from this call site
+#define LOG_RATE_LIMITED(_level, _perSecond, ...) \
+    do { \
+        static RateLimiter logRateLimiter(_perSecond); \
+        if (logRateLimiter.allow()) Logger::instance().log(_level, __VA_ARGS__); \
+        else Logger::instance().addSuppressed(1); \
+    } while (0)
+
+#endif // LOGGER_H
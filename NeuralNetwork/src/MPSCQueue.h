@@ -0,0 +1,151 @@
+// File: MPSCQueue.h
+// Description: Bounded lock-free multi-producer / single-consumer queue used to hand work between
+//              the socket thread and the evolution thread. Based on Dmitry Vyukov's bounded queue:
+//              every cell carries a sequence number, producers claim a cell with one CAS and the
+//              single consumer never needs one.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T>
+class MPSCQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit MPSCQueue(size_t _capacity)
+        : m_enqueuePos(0),
+          m_dequeuePos(0),
+          m_consumerWaiting(false)
+    {
+        size_t capacity = 2;
+        while (capacity < _capacity) capacity <<= 1;
+
+        m_mask = capacity - 1;
+        m_cells.reset(new Cell[capacity]);
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // Any thread. Returns false when the queue is full, in which case _value is left untouched.
+    bool tryPush(T&& _value)
+    {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(_value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        wakeConsumer();
+        return true;
+    }
+
+    // Any thread. Yields while the queue is full, which back-pressures a producer that
+    // outruns the consumer instead of dropping work.
+    void push(T _value)
+    {
+        while (!tryPush(std::move(_value)))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Consumer thread only
+    bool tryPop(T& _value)
+    {
+        Cell* cell = &m_cells[m_dequeuePos & m_mask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (sequence != m_dequeuePos + 1) return false;
+
+        _value = std::move(cell->value);
+        cell->value = T();
+        cell->sequence.store(m_dequeuePos + m_mask + 1, std::memory_order_release);
+        ++m_dequeuePos;
+        return true;
+    }
+
+    // Consumer thread only. Blocks until a value arrives or the timeout expires.
+    bool waitPop(T& _value, std::chrono::milliseconds _timeout)
+    {
+        if (tryPop(_value)) return true;
+
+        // Producers only touch the mutex when the consumer is actually asleep
+        std::unique_lock<std::mutex> lock(m_waitMutex);
+        m_consumerWaiting.store(true, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_wakeCondition.wait_for(lock, _timeout, [this]() { return !isEmpty(); });
+        m_consumerWaiting.store(false, std::memory_order_relaxed);
+        lock.unlock();
+
+        return tryPop(_value);
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
+
+    // Producer and consumer positions on separate cache lines
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) size_t m_dequeuePos;
+
+    std::mutex m_waitMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<bool> m_consumerWaiting;
+
+    bool isEmpty() const
+    {
+        return m_cells[m_dequeuePos & m_mask].sequence.load(std::memory_order_acquire) != m_dequeuePos + 1;
+    }
+
+    void wakeConsumer()
+    {
+        // Pairs with the fence in waitPop: either the consumer sees the new value
+        // when it re-checks, or we see it waiting and notify
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_consumerWaiting.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(m_waitMutex);
+            m_wakeCondition.notify_one();
+        }
+    }
+};
+
+#endif // MPSC_QUEUE_H
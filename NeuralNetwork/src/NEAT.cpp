@@ -7,7 +7,52 @@
 #include <random>
 #include <functional>
 #include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <unordered_set>
 #include "NEAT.h"
+#include "Profiler.h"
+
+namespace
+{
+    // splitmix64 finalizer, used to spread the bits of every hashed field
+    uint64_t mixHash(uint64_t _x)
+    {
+        _x += 0x9E3779B97F4A7C15ULL;
+        _x = (_x ^ (_x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        _x = (_x ^ (_x >> 27)) * 0x94D049BB133111EBULL;
+        return _x ^ (_x >> 31);
+    }
+
+    uint64_t hashDouble(double _value)
+    {
+        if (_value == 0.0) _value = 0.0; // -0.0 and 0.0 behave the same
+        uint64_t bits;
+        std::memcpy(&bits, &_value, sizeof(bits));
+        return bits;
+    }
+
+    NoveltyArchive::Config makeNoveltyConfig(const NEAT::Config& _config)
+    {
+        NoveltyArchive::Config config;
+        config.neighbours = _config.noveltyNeighbours;
+        config.archiveRate = _config.noveltyArchiveRate;
+        return config;
+    }
+
+    Genome::MutationRates makeMutationRates(const NEAT::Config& _config)
+    {
+        Genome::MutationRates rates;
+        rates.weight = _config.weightMutationRate;
+        rates.weightPower = _config.weightMutationPower;
+        rates.addConnection = _config.addConnectionRate;
+        rates.addNode = _config.addNodeRate;
+        rates.toggleConnection = _config.toggleConnectionRate;
+        return rates;
+    }
+}
 
 // Innovation implementation
 Innovation::Innovation(Type _type, int _fromNode, int _toNode, int _innovationNumber, int _newNodeId)
@@ -22,7 +67,10 @@ Innovation::Innovation(Type _type, int _fromNode, int _toNode, int _innovationNu
 // Genome implementation
 Genome::Genome() 
     : m_fitness(0.0), 
-      m_adjustedFitness(0.0)
+      m_adjustedFitness(0.0),
+      m_evaluated(false),
+      m_speciesId(-1),
+      m_parent(nullptr)
 {
 }
 
@@ -40,53 +88,53 @@ void Genome::addConnection(int _fromNode, int _toNode, double _weight, int _inno
     m_connections.emplace_back(_fromNode, _toNode, _weight, true, _innovationNumber);
 }
 
-void Genome::mutate()
+void Genome::mutate(const MutationRates& _rates)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 1.0);
+    static thread_local std::random_device rd;
+    static thread_local std::mt19937 gen(rd());
+    static thread_local std::uniform_real_distribution<> dis(0.0, 1.0);
     
     // Weight mutations
-    if (dis(gen) < 0.8) // 80% chance
+    if (dis(gen) < _rates.weight)
     {
-        mutateWeights();
+        mutateWeights(_rates.weightPower);
     }
     
     // Add connection mutation
-    if (dis(gen) < 0.05) // 5% chance
+    if (dis(gen) < _rates.addConnection)
     {
         mutateAddConnection();
     }
     
     // Add node mutation
-    if (dis(gen) < 0.03) // 3% chance
+    if (dis(gen) < _rates.addNode)
     {
         mutateAddNode();
     }
     
     // Toggle connection mutation
-    if (dis(gen) < 0.1) // 10% chance
+    if (dis(gen) < _rates.toggleConnection)
     {
         mutateToggleConnection();
     }
 }
 
-void Genome::mutateWeights()
+void Genome::mutateWeights(double _power)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(-0.1, 0.1);
+    static thread_local std::random_device rd;
+    static thread_local std::mt19937 gen(rd());
+    static thread_local std::uniform_real_distribution<> dis(-1.0, 1.0);
     
     for (auto& connection : m_connections)
     {
-        connection.weight += dis(gen);
+        connection.weight += _power * dis(gen);
     }
     
     for (auto& node : m_nodes)
     {
         if (!node.isInput)
         {
-            node.bias += dis(gen);
+            node.bias += _power * dis(gen);
         }
     }
 }
@@ -105,12 +153,13 @@ void Genome::mutateAddNode()
 
 void Genome::mutateToggleConnection()
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(0, m_connections.size() - 1);
+    static thread_local std::random_device rd;
+    static thread_local std::mt19937 gen(rd());
     
     if (!m_connections.empty())
     {
+        // The range depends on this genome, so the distribution cannot be static
+        std::uniform_int_distribution<> dis(0, static_cast<int>(m_connections.size()) - 1);
         int index = dis(gen);
         m_connections[index].enabled = !m_connections[index].enabled;
     }
@@ -169,6 +218,265 @@ double Genome::compatibilityDistance(const Genome& _other) const
     return (c1 * excess + c2 * disjoint) / N + c3 * (matching > 0 ? weightDiff / matching : 0);
 }
 
+uint64_t Genome::computeHash(uint64_t _salt) const
+{
+    // Every gene is hashed on its own and the results are summed, so the hash does not
+    // depend on gene order or on innovation numbers: structurally identical clones collide.
+    uint64_t hash = mixHash(_salt);
+
+    for (const auto& node : m_nodes)
+    {
+        uint64_t h = mixHash(static_cast<uint64_t>(static_cast<uint32_t>(node.nodeId)) | (uint64_t(node.isInput) << 32) | (uint64_t(node.isOutput) << 33));
+        hash += mixHash(h ^ hashDouble(node.bias));
+    }
+
+    for (const auto& connection : m_connections)
+    {
+        if (!connection.enabled) continue;
+
+        uint64_t h = mixHash((static_cast<uint64_t>(static_cast<uint32_t>(connection.fromNode)) << 32) | static_cast<uint32_t>(connection.toNode));
+        hash += mixHash(h ^ mixHash(hashDouble(connection.weight)));
+    }
+
+    return mixHash(hash);
+}
+
+uint64_t Genome::computeStructureHash() const
+{
+    // Order matters here: compiled networks map genes to slots by index
+    uint64_t hash = mixHash(m_nodes.size());
+
+    for (const auto& node : m_nodes)
+    {
+        hash = mixHash(hash ^ (static_cast<uint64_t>(static_cast<uint32_t>(node.nodeId)) | (uint64_t(node.isInput) << 32) | (uint64_t(node.isOutput) << 33)));
+    }
+
+    hash = mixHash(hash ^ m_connections.size());
+    for (const auto& connection : m_connections)
+    {
+        hash = mixHash(hash ^ ((static_cast<uint64_t>(static_cast<uint32_t>(connection.fromNode)) << 32) | static_cast<uint32_t>(connection.toNode)));
+        hash = mixHash(hash ^ uint64_t(connection.enabled));
+    }
+
+    return hash;
+}
+
+CompiledNetwork Genome::compile(const CompiledNetwork* _parent, bool _prune) const
+{
+    uint64_t structureHash = computeStructureHash();
+
+    // Weight-only change: same layout as the parent, just copy and patch
+    if (_parent && _parent->getStructureHash() == structureHash && _parent->isPatchable())
+    {
+        CompiledNetwork network(*_parent);
+        network.resetState();
+        patchCompiledNetwork(network);
+        return network;
+    }
+
+    CompiledNetwork network;
+    network.m_uStructureHash = structureHash;
+
+    // Assign a value slot to every node, inputs first
+    std::unordered_map<int, int> slotOfNode;
+    std::vector<int> geneOfSlot;
+    geneOfSlot.reserve(m_nodes.size());
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            if (m_nodes[i].isInput != (pass == 0)) continue;
+            if (slotOfNode.count(m_nodes[i].nodeId)) continue;
+
+            int slot = static_cast<int>(geneOfSlot.size());
+            slotOfNode[m_nodes[i].nodeId] = slot;
+            geneOfSlot.push_back(static_cast<int>(i));
+            if (m_nodes[i].isInput) network.m_vInputSlots.push_back(slot);
+        }
+    }
+    for (const auto& node : m_nodes)
+    {
+        if (node.isOutput) network.m_vOutputSlots.push_back(slotOfNode[node.nodeId]);
+    }
+
+    const size_t numSlots = geneOfSlot.size();
+    network.m_vValues.assign(numSlots, 0.0);
+    network.m_vConnectionSlots.assign(m_connections.size(), -1);
+    network.m_vBiasSlots.assign(m_nodes.size(), -1);
+
+    // Adjacency of the enabled connections
+    std::vector<std::vector<int>> incoming(numSlots);
+    std::vector<std::vector<int>> outgoing(numSlots);
+    std::vector<int> inDegree(numSlots, 0);
+    CompiledNetwork::PruneStats& stats = network.m_pruneStats;
+    for (size_t i = 0; i < m_connections.size(); ++i)
+    {
+        const auto& connection = m_connections[i];
+        if (!connection.enabled)
+        {
+            stats.disabledEdges++;
+            continue;
+        }
+
+        auto fromIt = slotOfNode.find(connection.fromNode);
+        auto toIt = slotOfNode.find(connection.toNode);
+        if (fromIt == slotOfNode.end() || toIt == slotOfNode.end() || m_nodes[geneOfSlot[toIt->second]].isInput)
+        {
+            // Dangling, or into an input node which is never activated
+            stats.danglingEdges++;
+            continue;
+        }
+
+        incoming[toIt->second].push_back(static_cast<int>(i));
+        outgoing[fromIt->second].push_back(toIt->second);
+        inDegree[toIt->second]++;
+    }
+
+    // Kahn's algorithm, once, at build time
+    std::vector<int> order;
+    order.reserve(numSlots);
+    std::queue<int> zeroInDegree;
+    for (size_t slot = 0; slot < numSlots; ++slot)
+    {
+        if (inDegree[slot] == 0) zeroInDegree.push(static_cast<int>(slot));
+    }
+    while (!zeroInDegree.empty())
+    {
+        int slot = zeroInDegree.front();
+        zeroInDegree.pop();
+        order.push_back(slot);
+
+        for (int next : outgoing[slot])
+        {
+            if (--inDegree[next] == 0) zeroInDegree.push(next);
+        }
+    }
+
+    // Optimisation pass: find what can influence the outputs
+    std::vector<bool> reachesOutput(numSlots, !_prune);
+    std::vector<bool> isConstant(numSlots, false);
+    std::vector<double> constantValue(numSlots, 0.0);
+    if (_prune)
+    {
+        // Backward from the outputs: anything else is a dead end
+        std::vector<int> stack(network.m_vOutputSlots.begin(), network.m_vOutputSlots.end());
+        for (int slot : stack) reachesOutput[slot] = true;
+        while (!stack.empty())
+        {
+            int slot = stack.back();
+            stack.pop_back();
+            for (int geneIndex : incoming[slot])
+            {
+                int from = slotOfNode[m_connections[geneIndex].fromNode];
+                if (!reachesOutput[from])
+                {
+                    reachesOutput[from] = true;
+                    stack.push_back(from);
+                }
+            }
+        }
+
+        // Forward from the inputs: acyclic nodes no input can reach always produce the same value.
+        // Nodes placed by Kahn's algorithm are exactly the acyclic ones, and they are visited
+        // after all their sources, so constants can be evaluated in that order.
+        std::vector<bool> fromInput(numSlots, false);
+        for (int slot : network.m_vInputSlots) fromInput[slot] = true;
+        for (int slot : order)
+        {
+            for (int next : outgoing[slot])
+            {
+                if (fromInput[slot]) fromInput[next] = true;
+            }
+        }
+        for (int slot : order)
+        {
+            if (fromInput[slot]) continue;
+
+            double sum = 0.0;
+            for (int geneIndex : incoming[slot])
+            {
+                sum += constantValue[slotOfNode[m_connections[geneIndex].fromNode]] * m_connections[geneIndex].weight;
+            }
+            sum += m_nodes[geneOfSlot[slot]].bias;
+            constantValue[slot] = 1.0 / (1.0 + std::exp(-sum));
+            isConstant[slot] = true;
+        }
+    }
+
+    // Nodes in cycles go last, like neuralNetwork::topologicalSort
+    if (order.size() != numSlots)
+    {
+        std::vector<bool> placed(numSlots, false);
+        for (int slot : order) placed[slot] = true;
+        for (size_t slot = 0; slot < numSlots; ++slot)
+        {
+            if (!placed[slot]) order.push_back(static_cast<int>(slot));
+        }
+    }
+
+    // Emit one step per non-input node that matters
+    for (int slot : order)
+    {
+        const NodeGene& node = m_nodes[geneOfSlot[slot]];
+        if (node.isInput) continue;
+
+        if (!reachesOutput[slot])
+        {
+            stats.deadEndNodes++;
+            stats.deadEndEdges += static_cast<int>(incoming[slot].size());
+            continue;
+        }
+
+        // A constant output still needs a value; a constant hidden node only lives on in the biases
+        bool isOutputNode = node.isOutput;
+        if (isConstant[slot] && !isOutputNode)
+        {
+            stats.constantNodes++;
+            stats.foldedEdges += static_cast<int>(incoming[slot].size());
+            continue;
+        }
+
+        int step = static_cast<int>(network.m_vStepNode.size());
+        double bias = node.bias;
+
+        for (int geneIndex : incoming[slot])
+        {
+            const auto& connection = m_connections[geneIndex];
+            int from = slotOfNode[connection.fromNode];
+            if (isConstant[from])
+            {
+                bias += constantValue[from] * connection.weight;
+                stats.foldedEdges++;
+                continue;
+            }
+
+            network.m_vConnectionSlots[geneIndex] = static_cast<int>(network.m_vEdgeWeight.size());
+            network.m_vEdgeFrom.push_back(from);
+            network.m_vEdgeWeight.push_back(connection.weight);
+        }
+
+        network.m_vStepNode.push_back(slot);
+        network.m_vStepBias.push_back(bias);
+        network.m_vStepEdgeEnd.push_back(static_cast<int>(network.m_vEdgeWeight.size()));
+        network.m_vBiasSlots[geneOfSlot[slot]] = step;
+    }
+
+    return network;
+}
+
+void Genome::patchCompiledNetwork(CompiledNetwork& _network) const
+{
+    for (size_t i = 0; i < m_connections.size(); ++i)
+    {
+        _network.setConnectionWeight(i, m_connections[i].weight);
+    }
+
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        _network.setNodeBias(i, m_nodes[i].bias);
+    }
+}
+
 std::unique_ptr<neuralNetwork> Genome::createNeuralNetwork() const
 {
     // Count input and output nodes
@@ -277,9 +585,9 @@ Genome Genome::crossover(const Genome& _parent1, const Genome& _parent2)
         if (it1 != _parent1.m_connections.end() && it2 != _parent2.m_connections.end())
         {
             // Both parents have this gene - randomly choose one
-            static std::random_device rd;
-            static std::mt19937 gen(rd());
-            static std::uniform_int_distribution<> dis(0, 1);
+            static thread_local std::random_device rd;
+            static thread_local std::mt19937 gen(rd());
+            static thread_local std::uniform_int_distribution<> dis(0, 1);
             
             const ConnectionGene& chosen = (dis(gen) == 0) ? *it1 : *it2;
             child.m_connections.push_back(chosen);
@@ -300,8 +608,8 @@ Genome Genome::crossover(const Genome& _parent1, const Genome& _parent2)
 }
 
 // Species implementation
-Species::Species(Genome* _representative) 
-    : m_representative(_representative), m_totalAdjustedFitness(0.0), m_staleness(0)
+Species::Species(Genome* _representative, int _id) 
+    : m_id(_id), m_representative(_representative), m_totalAdjustedFitness(0.0), m_staleness(0), m_aliasValid(false)
 {
     addGenome(_representative);
 }
@@ -313,6 +621,8 @@ Species::~Species()
 void Species::addGenome(Genome* _genome)
 {
     m_genomes.push_back(_genome);
+    _genome->m_speciesId = m_id;
+    m_aliasValid = false;
 }
 
 void Species::removeGenome(Genome* _genome)
@@ -321,59 +631,134 @@ void Species::removeGenome(Genome* _genome)
     if (it != m_genomes.end())
     {
         m_genomes.erase(it);
+        m_aliasValid = false;
+    }
+    
+    // Never keep a dangling representative around
+    if (m_representative == _genome)
+    {
+        m_representative = m_genomes.empty() ? nullptr : m_genomes.front();
     }
 }
 
-bool Species::isCompatible(const Genome& _genome) const
+bool Species::contains(const Genome* _genome) const
 {
-    return m_representative->compatibilityDistance(_genome) < 3.0; // Compatibility threshold
+    return std::find(m_genomes.begin(), m_genomes.end(), _genome) != m_genomes.end();
+}
+
+bool Species::isCompatible(const Genome& _genome, double _threshold) const
+{
+    if (!m_representative) return false;
+    return m_representative->compatibilityDistance(_genome) < _threshold;
 }
 
 void Species::calculateAdjustedFitness()
 {
+    // Explicit fitness sharing: a genome's fitness is shared with the rest of its species
     m_totalAdjustedFitness = 0.0;
     for (auto genome : m_genomes)
     {
+        genome->setAdjustedFitness(genome->getFitness() / m_genomes.size());
         m_totalAdjustedFitness += genome->getAdjustedFitness();
     }
+    m_aliasValid = false;
 }
 
-Genome* Species::selectParent() const
+Genome* Species::selectParent(int _tournamentSize) const
 {
     if (m_genomes.empty()) return nullptr;
     
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> dis(0.0, 1.0);
-    
-    double random = dis(gen) * m_totalAdjustedFitness;
-    double sum = 0.0;
+    static thread_local std::random_device rd;
+    static thread_local std::mt19937 gen(rd());
+    static thread_local std::uniform_real_distribution<> dis(0.0, 1.0);
     
-    for (auto genome : m_genomes)
+    if (_tournamentSize > 0)
     {
-        sum += genome->getAdjustedFitness();
-        if (sum >= random)
+        std::uniform_int_distribution<size_t> pick(0, m_genomes.size() - 1);
+        Genome* best = m_genomes[pick(gen)];
+        for (int i = 1; i < _tournamentSize; ++i)
         {
-            return genome;
+            Genome* candidate = m_genomes[pick(gen)];
+            if (candidate->getAdjustedFitness() > best->getAdjustedFitness()) best = candidate;
         }
+        return best;
     }
     
-    return m_genomes.back();
+    if (!m_aliasValid) buildAliasTable();
+    
+    // One uniform number gives both the slot (integer part) and the coin flip (fractional part)
+    double scaled = dis(gen) * m_genomes.size();
+    size_t slot = std::min(static_cast<size_t>(scaled), m_genomes.size() - 1);
+    return m_genomes[scaled - slot < m_aliasProbability[slot] ? slot : m_alias[slot]];
 }
 
-void Species::cull(bool _keepBest)
+void Species::buildAliasTable() const
 {
-    if (m_genomes.size() <= 2) return;
+    // Vose's method: slots under the mean weight are topped up by one slot over it
+    const size_t count = m_genomes.size();
+    m_aliasProbability.assign(count, 1.0);
+    m_alias.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_alias[i] = static_cast<uint32_t>(i);
+    }
+    m_aliasValid = true;
     
-    // Sort by fitness
-    std::sort(m_genomes.begin(), m_genomes.end(),
-        [](const Genome* a, const Genome* b) { return a->getFitness() > b->getFitness(); });
+    double total = 0.0;
+    for (auto genome : m_genomes)
+    {
+        total += std::max(0.0, genome->getAdjustedFitness());
+    }
+    if (total <= 0.0) return; // Uniform draw
+    
+    std::vector<double> weights(count);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < count; ++i)
+    {
+        weights[i] = std::max(0.0, m_genomes[i]->getAdjustedFitness()) * count / total;
+        (weights[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t under = small.back();
+        small.pop_back();
+        uint32_t over = large.back();
+        large.pop_back();
+        
+        m_aliasProbability[under] = weights[under];
+        m_alias[under] = over;
+        weights[over] = (weights[over] + weights[under]) - 1.0;
+        (weights[over] < 1.0 ? small : large).push_back(over);
+    }
+    // Whatever is left is 1 up to rounding and keeps its own slot
+}
+
+void Species::cull(double _survivalThreshold, bool _keepBest)
+{
+    if (m_genomes.size() <= 2) return;
     
-    // Keep only the best 20%
-    size_t keepCount = std::max(size_t(1), m_genomes.size() / 5);
+    size_t keepCount = std::min(m_genomes.size(), static_cast<size_t>(m_genomes.size() * _survivalThreshold));
     if (_keepBest) keepCount = std::max(size_t(1), keepCount);
     
+    if (keepCount > 0)
+    {
+        // The order of the survivors does not matter, so a partition is enough. Only the
+        // champion is moved to the front.
+        auto better = [](const Genome* a, const Genome* b) { return a->getFitness() > b->getFitness(); };
+        std::nth_element(m_genomes.begin(), m_genomes.begin() + (keepCount - 1), m_genomes.end(), better);
+        if (_keepBest)
+        {
+            std::iter_swap(m_genomes.begin(), std::min_element(m_genomes.begin(), m_genomes.begin() + keepCount, better));
+        }
+    }
+    
     m_genomes.resize(keepCount);
+    if (!contains(m_representative))
+    {
+        m_representative = m_genomes.empty() ? nullptr : m_genomes.front();
+    }
+    m_aliasValid = false;
 }
 
 void Species::reproduce()
@@ -384,7 +769,18 @@ void Species::reproduce()
 
 // NEAT implementation
 NEAT::NEAT(const Config& _config) 
-    : m_config(_config), m_nextInnovationNumber(0), m_nextNodeId(0)
+    : m_config(_config), 
+      m_fitnessCache(_config.fitnessCacheSize > 0 ? _config.fitnessCacheSize : 0),
+      m_noveltyArchive(makeNoveltyConfig(_config)),
+      m_evaluationSeedHash(0),
+      m_nextInnovationNumber(0), 
+      m_nextNodeId(0),
+      m_nextSpeciesId(0),
+      m_evaluationCount(0),
+      m_replacementCount(0),
+      m_resultsSinceSpeciation(0),
+      m_bestGenome(nullptr),
+      m_bestGenomeValid(false)
 {
 }
 
@@ -402,6 +798,19 @@ NEAT::~NEAT()
 
 void NEAT::initializePopulation()
 {
+    m_bestGenomeValid = false;
+    
+    // Number every input -> output connection up front, so genes are sorted by innovation
+    // number in every genome and the same connection matches across genomes
+    for (int input = 0; input < m_config.numInputs; ++input)
+    {
+        for (int output = 0; output < m_config.numOutputs; ++output)
+        {
+            getConnectionInnovation(input, m_config.numInputs + output);
+        }
+    }
+    m_nextNodeId = std::max(m_nextNodeId, m_config.numInputs + m_config.numOutputs);
+    
     // Create initial minimal genomes
     for (int i = 0; i < m_config.populationSize; ++i)
     {
@@ -420,10 +829,10 @@ void NEAT::initializePopulation()
         }
         
         // Add random connections from inputs to outputs
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_real_distribution<> weightDis(-1.0, 1.0);
-        static std::uniform_real_distribution<> connectionDis(0.0, 1.0);
+        static thread_local std::random_device rd;
+        static thread_local std::mt19937 gen(rd());
+        static thread_local std::uniform_real_distribution<> weightDis(-1.0, 1.0);
+        static thread_local std::uniform_real_distribution<> connectionDis(0.0, 1.0);
         
         for (int input = 0; input < m_config.numInputs; ++input)
         {
@@ -433,7 +842,7 @@ void NEAT::initializePopulation()
                 if (connectionDis(gen) < 0.7)
                 {
                     double weight = weightDis(gen);
-                    int innovation = getNextInnovationNumber();
+                    int innovation = getConnectionInnovation(input, m_config.numInputs + output);
                     genome->addConnection(input, m_config.numInputs + output, weight, innovation);
                 }
             }
@@ -445,6 +854,8 @@ void NEAT::initializePopulation()
 
 void NEAT::evolve()
 {
+    PROFILE_SCOPE("NEAT::evolve");
+    m_bestGenomeValid = false;
     speciate();
     calculateAdjustedFitness();
     removeStaleSpecies();
@@ -456,21 +867,425 @@ void NEAT::evaluateFitness(std::function<double(const Genome&)> _fitnessFunction
 {
     for (auto genome : m_population)
     {
-        double fitness = _fitnessFunction(*genome);
+        double fitness;
+        if (!lookupFitness(*genome, fitness))
+        {
+            fitness = _fitnessFunction(*genome);
+            storeFitness(*genome, fitness);
+        }
         genome->setFitness(fitness);
     }
+    m_bestGenomeValid = false;
+}
+
+void NEAT::evaluateNovelty(std::function<void(const Genome&, float*)> _behaviourFunction, size_t _behaviourSize)
+{
+    // Novelty depends on the archive, which keeps changing, so it never goes through the fitness cache
+    std::vector<float> behaviours(m_population.size() * _behaviourSize);
+    for (size_t i = 0; i < m_population.size(); ++i)
+    {
+        _behaviourFunction(*m_population[i], &behaviours[i * _behaviourSize]);
+    }
+
+    if (m_noveltyArchive.getDimensions() != _behaviourSize) m_noveltyArchive.reset(_behaviourSize);
+    m_noveltyArchive.computeNovelty(behaviours.data(), m_population.size(), m_novelty);
+    for (size_t i = 0; i < m_population.size(); ++i)
+    {
+        m_population[i]->setFitness(m_novelty[i]);
+    }
+    m_bestGenomeValid = false;
+    m_noveltyArchive.archive(behaviours.data(), m_population.size());
+}
+
+void NEAT::reportBehaviours(const std::vector<Genome*>& _genomes, const std::vector<float>& _behaviours)
+{
+    if (_genomes.empty()) return;
+    size_t behaviourSize = _behaviours.size() / _genomes.size();
+    if (m_noveltyArchive.getDimensions() != behaviourSize) m_noveltyArchive.reset(behaviourSize);
+
+    m_noveltyArchive.computeNovelty(_behaviours.data(), _genomes.size(), m_novelty);
+    for (size_t i = 0; i < _genomes.size(); ++i)
+    {
+        reportFitness(_genomes[i], m_novelty[i]);
+    }
+    m_noveltyArchive.archive(_behaviours.data(), _genomes.size());
+}
+
+void NEAT::reportFitness(Genome* _genome, double _fitness)
+{
+    PROFILE_SCOPE("NEAT::reportFitness");
+    _genome->setFitness(_fitness);
+    _genome->m_evaluated = true;
+    m_evaluationCount++;
+    updateBestGenome(_genome);
+
+    // Speciation is the expensive part, so it is only refreshed periodically
+    int interval = m_config.speciationInterval > 0 ? m_config.speciationInterval : std::max(1, m_config.populationSize / 4);
+    if (++m_resultsSinceSpeciation >= interval || m_species.empty())
+    {
+        speciate();
+        calculateAdjustedFitness();
+        m_resultsSinceSpeciation = 0;
+    }
+    else
+    {
+        for (auto species : m_species)
+        {
+            if (species->contains(_genome))
+            {
+                species->calculateAdjustedFitness();
+                break;
+            }
+        }
+    }
+}
+
+Genome* NEAT::replaceWorst()
+{
+    PROFILE_SCOPE("NEAT::replaceWorst");
+    if (m_species.empty())
+    {
+        speciate();
+        calculateAdjustedFitness();
+    }
+
+    Genome* worst = findWorstEvaluated();
+    if (!worst) return nullptr;
+
+    Species* parentSpecies = selectSpecies();
+    if (!parentSpecies) return nullptr;
+
+    // Breed before removing the worst genome, it may well be one of the parents
+    Genome* child = createOffspring(*parentSpecies);
+    removeGenome(worst);
+
+    m_population.push_back(child);
+    addToSpecies(child);
+    m_replacementCount++;
+
+    return child;
+}
+
+int NEAT::getConnectionInnovation(int _fromNode, int _toNode)
+{
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(_fromNode)) << 32) | static_cast<uint32_t>(_toNode);
+    auto it = m_connectionInnovations.find(key);
+    if (it != m_connectionInnovations.end()) return it->second;
+
+    int innovation = getNextInnovationNumber();
+    m_connectionInnovations[key] = innovation;
+    return innovation;
+}
+
+Genome* NEAT::importGenome(const Genome& _migrant)
+{
+    if (m_species.empty() && !m_population.empty())
+    {
+        speciate();
+        calculateAdjustedFitness();
+    }
+
+    // Inputs and outputs have the same ids everywhere. Hidden node ids are local to the island
+    // that created them, so each gets a fresh id here.
+    Genome* genome = new Genome(_migrant);
+    int fixedNodes = m_config.numInputs + m_config.numOutputs;
+    std::unordered_map<int, int> nodeIds;
+    for (auto& node : genome->m_nodes)
+    {
+        if (node.nodeId < fixedNodes) continue;
+        int localId = getNextNodeId();
+        nodeIds[node.nodeId] = localId;
+        node.nodeId = localId;
+    }
+
+    // Innovation numbers are renumbered from the connection endpoints, then the genes are put
+    // back in innovation order as crossover and compatibility distance expect
+    for (auto& connection : genome->m_connections)
+    {
+        auto from = nodeIds.find(connection.fromNode);
+        if (from != nodeIds.end()) connection.fromNode = from->second;
+        auto to = nodeIds.find(connection.toNode);
+        if (to != nodeIds.end()) connection.toNode = to->second;
+        connection.innovationNumber = getConnectionInnovation(connection.fromNode, connection.toNode);
+    }
+    std::sort(genome->m_connections.begin(), genome->m_connections.end(),
+        [](const Genome::ConnectionGene& a, const Genome::ConnectionGene& b) { return a.innovationNumber < b.innovationNumber; });
+
+    if (static_cast<int>(m_population.size()) >= m_config.populationSize)
+    {
+        Genome* worst = findWorstEvaluated();
+        if (!worst)
+        {
+            delete genome;
+            return nullptr;
+        }
+        removeGenome(worst);
+    }
+
+    m_population.push_back(genome);
+    updateBestGenome(genome);
+    addToSpecies(genome);
+    for (auto species : m_species)
+    {
+        if (species->contains(genome))
+        {
+            species->calculateAdjustedFitness();
+            break;
+        }
+    }
+    return genome;
+}
+
+Genome* NEAT::findWorstEvaluated() const
+{
+    // Only genomes that have been evaluated are candidates (never one still being tested)
+    Genome* worst = nullptr;
+    for (auto genome : m_population)
+    {
+        if (genome->m_evaluated && (!worst || genome->getAdjustedFitness() < worst->getAdjustedFitness()))
+        {
+            worst = genome;
+        }
+    }
+    return worst;
+}
+
+void NEAT::removeGenome(Genome* _genome)
+{
+    for (auto species : m_species)
+    {
+        if (species->contains(_genome))
+        {
+            species->removeGenome(_genome);
+            species->calculateAdjustedFitness();
+            break;
+        }
+    }
+    m_population.erase(std::find(m_population.begin(), m_population.end(), _genome));
+    if (_genome == m_bestGenome) m_bestGenomeValid = false;
+    delete _genome;
+
+    m_species.erase(
+        std::remove_if(m_species.begin(), m_species.end(),
+            [](Species* species) {
+                if (species->getSize() > 0) return false;
+                delete species;
+                return true;
+            }),
+        m_species.end()
+    );
+}
+
+Species* NEAT::selectSpecies() const
+{
+    if (m_species.empty()) return nullptr;
+
+    static thread_local std::random_device rd;
+    static thread_local std::mt19937 gen(rd());
+
+    // Roulette wheel on average adjusted fitness, as in rtNEAT
+    double total = 0.0;
+    for (auto species : m_species)
+    {
+        total += species->getAverageAdjustedFitness();
+    }
+    if (total <= 0.0)
+    {
+        std::uniform_int_distribution<> dis(0, static_cast<int>(m_species.size()) - 1);
+        return m_species[dis(gen)];
+    }
+
+    double random = std::uniform_real_distribution<>(0.0, total)(gen);
+    double sum = 0.0;
+    for (auto species : m_species)
+    {
+        sum += species->getAverageAdjustedFitness();
+        if (sum >= random)
+        {
+            return species;
+        }
+    }
+
+    return m_species.back();
+}
+
+Genome* NEAT::createOffspring(const Species& _species) const
+{
+    static thread_local std::random_device rd;
+    static thread_local std::mt19937 gen(rd());
+    static thread_local std::uniform_real_distribution<> dis(0.0, 1.0);
+
+    Genome* parent1 = _species.selectParent(m_config.tournamentSize);
+    Genome* child = nullptr;
+
+    if (_species.getSize() > 1 && dis(gen) < m_config.crossoverRate)
+    {
+        Genome* parent2 = _species.selectParent(m_config.tournamentSize);
+        child = new Genome(Genome::crossover(*parent1, *parent2));
+    }
+    else
+    {
+        child = new Genome(*parent1);
+    }
+
+    child->m_parent = parent1;
+    child->mutate(makeMutationRates(m_config));
+    child->setFitness(0.0);
+    child->setAdjustedFitness(0.0);
+    child->m_evaluated = false;
+
+    return child;
+}
+
+void NEAT::setEvaluationSeeds(const std::vector<unsigned int>& _seeds)
+{
+    m_evaluationSeeds = _seeds;
+    m_evaluationSeedHash = mixHash(_seeds.size());
+    for (unsigned int seed : _seeds)
+    {
+        m_evaluationSeedHash = mixHash(m_evaluationSeedHash ^ seed);
+    }
+}
+
+void NEAT::evaluateEpisodes(const std::vector<Genome*>& _genomes, const EpisodeFunction& _episodeFunction)
+{
+    if (_genomes.empty()) return;
+    // Without evaluation seeds every genome plays the default course once
+    const std::vector<unsigned int> defaultSeeds(1, 1);
+    const std::vector<unsigned int>& seeds = m_evaluationSeeds.empty() ? defaultSeeds : m_evaluationSeeds;
+    const size_t numEpisodes = seeds.size();
+
+    // Elite outside the batch: the best genome already evaluated that this batch does not re-evaluate
+    std::unordered_set<const Genome*> inBatch(_genomes.begin(), _genomes.end());
+    double outsideElite = -std::numeric_limits<double>::infinity();
+    for (const Genome* genome : m_population)
+    {
+        if (genome->m_evaluated && !inBatch.count(genome)) outsideElite = std::max(outsideElite, genome->getFitness());
+    }
+
+    m_episodeScores.assign(_genomes.size() * numEpisodes, 0.0);
+    m_episodeActive.resize(_genomes.size());
+    for (size_t i = 0; i < _genomes.size(); ++i)
+    {
+        m_episodeActive[i] = i;
+    }
+    std::vector<size_t> played(_genomes.size(), 0);
+
+    for (size_t episode = 0; episode < numEpisodes && !m_episodeActive.empty(); ++episode)
+    {
+        m_episodeBatch.clear();
+        for (size_t index : m_episodeActive)
+        {
+            m_episodeBatch.push_back(_genomes[index]);
+        }
+        m_episodeResults.assign(m_episodeBatch.size(), 0.0);
+        _episodeFunction(m_episodeBatch, seeds[episode], m_episodeResults);
+        m_episodeStats.played += m_episodeBatch.size();
+
+        for (size_t j = 0; j < m_episodeActive.size(); ++j)
+        {
+            size_t index = m_episodeActive[j];
+            m_episodeScores[index * numEpisodes + episode] = m_episodeResults[j];
+            played[index]++;
+        }
+
+        const size_t episodesPlayed = episode + 1;
+        if (m_config.minEpisodes <= 0 || episodesPlayed < static_cast<size_t>(m_config.minEpisodes) || episodesPlayed == numEpisodes) continue;
+
+        // Successive halving: race the genomes on a confidence interval of their mean score
+        m_episodeResults.resize(m_episodeActive.size());   // Upper bound of each running genome
+        double elite = outsideElite;
+        for (size_t j = 0; j < m_episodeActive.size(); ++j)
+        {
+            const double* scores = &m_episodeScores[m_episodeActive[j] * numEpisodes];
+            double mean = 0.0;
+            for (size_t e = 0; e < episodesPlayed; ++e) mean += scores[e];
+            mean /= episodesPlayed;
+            double variance = 0.0;
+            for (size_t e = 0; e < episodesPlayed; ++e) variance += (scores[e] - mean) * (scores[e] - mean);
+            double margin = m_config.episodeConfidence * std::sqrt(variance / (episodesPlayed - 1) / episodesPlayed);
+
+            m_episodeResults[j] = mean + margin;
+            elite = std::max(elite, mean - margin);
+        }
+
+        size_t write = 0;
+        for (size_t j = 0; j < m_episodeActive.size(); ++j)
+        {
+            if (m_episodeResults[j] < elite)
+            {
+                m_episodeStats.skipped += numEpisodes - episodesPlayed;
+                m_episodeStats.genomesStopped++;
+                continue;
+            }
+            m_episodeActive[write++] = m_episodeActive[j];
+        }
+        m_episodeActive.resize(write);
+    }
+
+    for (size_t i = 0; i < _genomes.size(); ++i)
+    {
+        reportFitness(_genomes[i], aggregateEpisodes(&m_episodeScores[i * numEpisodes], played[i]));
+    }
+}
+
+double NEAT::aggregateEpisodes(double* _scores, size_t _count) const
+{
+    if (_count == 0) return 0.0;
+
+    switch (m_config.episodeAggregate)
+    {
+    case EPISODE_MIN:
+        return *std::min_element(_scores, _scores + _count);
+    case EPISODE_QUANTILE:
+    {
+        // Linear interpolation between the two closest order statistics
+        std::sort(_scores, _scores + _count);
+        double position = std::min(std::max(m_config.episodeQuantile, 0.0), 1.0) * (_count - 1);
+        size_t below = static_cast<size_t>(position);
+        size_t above = std::min(below + 1, _count - 1);
+        return _scores[below] + (position - below) * (_scores[above] - _scores[below]);
+    }
+    default:
+        return std::accumulate(_scores, _scores + _count, 0.0) / _count;
+    }
+}
+
+bool NEAT::lookupFitness(const Genome& _genome, double& _fitness)
+{
+    if (m_fitnessCache.getCapacity() == 0) return false;
+    return m_fitnessCache.find(_genome.computeHash(m_evaluationSeedHash), _fitness);
+}
+
+void NEAT::storeFitness(const Genome& _genome, double _fitness)
+{
+    if (m_fitnessCache.getCapacity() == 0) return;
+    m_fitnessCache.insert(_genome.computeHash(m_evaluationSeedHash), _fitness);
 }
 
 Genome* NEAT::getBestGenome() const
 {
     if (m_population.empty()) return nullptr;
+    if (m_bestGenomeValid && m_bestGenome) return m_bestGenome;
     
-    return *std::max_element(m_population.begin(), m_population.end(),
+    m_bestGenome = *std::max_element(m_population.begin(), m_population.end(),
         [](const Genome* a, const Genome* b) { return a->getFitness() < b->getFitness(); });
+    m_bestGenomeValid = true;
+    return m_bestGenome;
+}
+
+void NEAT::updateBestGenome(Genome* _genome)
+{
+    if (!m_bestGenomeValid) return;
+    
+    // A new result for the best genome itself may have lowered it, the next call rescans
+    if (_genome == m_bestGenome) m_bestGenomeValid = false;
+    else if (!m_bestGenome || _genome->getFitness() > m_bestGenome->getFitness()) m_bestGenome = _genome;
 }
 
 void NEAT::speciate()
 {
+    PROFILE_SCOPE("NEAT::speciate");
     // Clear existing species
     for (auto species : m_species)
     {
@@ -487,6 +1302,7 @@ void NEAT::speciate()
 
 void NEAT::calculateAdjustedFitness()
 {
+    PROFILE_SCOPE("NEAT::calculateAdjustedFitness");
     for (auto species : m_species)
     {
         species->calculateAdjustedFitness();
@@ -495,6 +1311,7 @@ void NEAT::calculateAdjustedFitness()
 
 void NEAT::removeStaleSpecies()
 {
+    PROFILE_SCOPE("NEAT::removeStaleSpecies");
     // Remove species that haven't improved for many generations
     m_species.erase(
         std::remove_if(m_species.begin(), m_species.end(),
@@ -505,6 +1322,7 @@ void NEAT::removeStaleSpecies()
 
 void NEAT::removeWeakSpecies()
 {
+    PROFILE_SCOPE("NEAT::removeWeakSpecies");
     double totalFitness = 0.0;
     for (auto species : m_species)
     {
@@ -514,7 +1332,9 @@ void NEAT::removeWeakSpecies()
     m_species.erase(
         std::remove_if(m_species.begin(), m_species.end(),
             [totalFitness](Species* species) {
-                return species->getTotalAdjustedFitness() / totalFitness < 0.001;
+                if (species->getTotalAdjustedFitness() / totalFitness >= 0.001) return false;
+                delete species;
+                return true;
             }),
         m_species.end()
     );
@@ -522,6 +1342,7 @@ void NEAT::removeWeakSpecies()
 
 void NEAT::reproduce()
 {
+    PROFILE_SCOPE("NEAT::reproduce");
     // This would implement the reproduction strategy
     // Creating new genomes for the next generation
 }
@@ -530,13 +1351,20 @@ void NEAT::addToSpecies(Genome* _genome)
 {
     for (auto species : m_species)
     {
-        if (species->isCompatible(*_genome))
+        if (species->isCompatible(*_genome, m_config.compatibilityThreshold))
         {
             species->addGenome(_genome);
             return;
         }
     }
     
-    // Create new species if no compatible species found
-    m_species.push_back(new Species(_genome));
+    // Create new species if no compatible species found. Re-speciation starts over from scratch, so
+    // a species founded by a member of an old one carries on its id (and its statistics).
+    int id = _genome->m_speciesId;
+    for (auto species : m_species)
+    {
+        if (species->getId() == id) id = -1;
+    }
+    if (id < 0 || id >= m_nextSpeciesId) id = m_nextSpeciesId++; // Also migrants, ids are per instance
+    m_species.push_back(new Species(_genome, id));
 } 
\ No newline at end of file
@@ -10,7 +10,11 @@
 #include <unordered_map>
 #include <memory>
 #include <functional>
+#include <cstdint>
 #include "neuralNetwork.h"
+#include "CompiledNetwork.h"
+#include "FitnessCache.h"
+#include "NoveltyArchive.h"
 
 // Forward declarations
 class Genome;
@@ -65,10 +69,25 @@ public:
             : nodeId(_id), bias(_bias), isInput(_input), isOutput(_output) {}
     };
 
+    // Chance of each mutation of an offspring, and the largest change of a weight or bias
+    struct MutationRates {
+        double weight = 0.8;
+        double weightPower = 0.1;
+        double addConnection = 0.05;
+        double addNode = 0.03;
+        double toggleConnection = 0.1;
+    };
+
     std::vector<NodeGene> m_nodes; // <-- Make public
     std::vector<ConnectionGene> m_connections; // <-- Make public
     double m_fitness;
     double m_adjustedFitness;
+    bool m_evaluated; // Has a fitness result; only evaluated genomes can be replaced in steady-state mode
+    int m_speciesId;  // Id of the species the genome was last added to, -1 before speciation
+    // First parent in createOffspring, nullptr before. Never dereferenced: the parent may have been
+    // deleted since, and a newer genome may have been allocated at the same address. Only used as the
+    // id hint sendGenome passes to GenomeDeltaEncoder, where a wrong guess costs a larger delta.
+    const Genome* m_parent;
 
     Genome();
     ~Genome();
@@ -76,8 +95,8 @@ public:
     // Genome operations
     void addNode(int _nodeId, double _bias, bool _isInput, bool _isOutput);
     void addConnection(int _fromNode, int _toNode, double _weight, int _innovationNumber);
-    void mutate();
-    void mutateWeights();
+    void mutate(const MutationRates& _rates);
+    void mutateWeights(double _power);
     void mutateAddConnection();
     void mutateAddNode();
     void mutateToggleConnection();
@@ -91,9 +110,23 @@ public:
     // Compatibility distance for speciation
     double compatibilityDistance(const Genome& _other) const;
     
+    // Canonical 64-bit hash of everything that affects evaluation: enabled connections,
+    // node biases and weights. Independent of gene order. _salt mixes in the evaluation seeds.
+    uint64_t computeHash(uint64_t _salt = 0) const;
+    
+    // Hash of the topology only (gene order, node ids and types, connection endpoints and
+    // enabled flags). Two genomes with the same structure hash differ only by weights and biases.
+    uint64_t computeStructureHash() const;
+    
     // Convert to neural network
     std::unique_ptr<neuralNetwork> createNeuralNetwork() const;
     
+    // Build the flat executable network. When _parent has the same structure (the common
+    // weight-only mutation) it is copied and its weights/biases patched instead of rebuilt.
+    // _prune drops everything that cannot influence the outputs (see CompiledNetwork::PruneStats).
+    CompiledNetwork compile(const CompiledNetwork* _parent = nullptr, bool _prune = true) const;
+    void patchCompiledNetwork(CompiledNetwork& _network) const;
+    
     // Crossover
     static Genome crossover(const Genome& _parent1, const Genome& _parent2);
 
@@ -107,31 +140,55 @@ private:
 // Species groups similar genomes together
 class Species {
 public:
-    Species(Genome* _representative);
+    Species(Genome* _representative, int _id);
     ~Species();
 
     void addGenome(Genome* _genome);
     void removeGenome(Genome* _genome);
-    bool isCompatible(const Genome& _genome) const;
+    bool isCompatible(const Genome& _genome, double _threshold) const;
     void calculateAdjustedFitness();
-    Genome* selectParent() const;
-    void cull(bool _keepBest = true);
+    // Fitness-proportional draw in O(1) from a Walker alias table, built on the first draw after
+    // the members or their adjusted fitness changed. _tournamentSize > 0 returns the best of that
+    // many uniform draws instead.
+    Genome* selectParent(int _tournamentSize = 0) const;
+    // Keep the best _survivalThreshold fraction of the members. _keepBest keeps at least the
+    // champion, first, even when the fraction rounds down to nothing.
+    void cull(double _survivalThreshold, bool _keepBest = true);
     void reproduce();
     
+    int getId() const { return m_id; }
     double getTotalAdjustedFitness() const { return m_totalAdjustedFitness; }
+    double getAverageAdjustedFitness() const { return m_genomes.empty() ? 0.0 : m_totalAdjustedFitness / m_genomes.size(); }
     size_t getSize() const { return m_genomes.size(); }
+    bool contains(const Genome* _genome) const;
     const std::vector<Genome*>& getGenomes() const { return m_genomes; }
 
 private:
+    int m_id;
     Genome* m_representative;
     std::vector<Genome*> m_genomes;
     double m_totalAdjustedFitness;
     int m_staleness; // Generations without improvement
+    
+    // Alias table: slot i is drawn uniformly, then keeps genome i with probability m_aliasProbability[i]
+    // and gives its draw to genome m_alias[i] otherwise
+    mutable std::vector<double> m_aliasProbability;
+    mutable std::vector<uint32_t> m_alias;
+    mutable bool m_aliasValid;
+    
+    void buildAliasTable() const;
 };
 
 // Main NEAT algorithm class
 class NEAT {
 public:
+    // How the episode scores of a genome become its fitness (evaluateEpisodes)
+    enum EpisodeAggregate {
+        EPISODE_MEAN,
+        EPISODE_MIN,
+        EPISODE_QUANTILE
+    };
+
     struct Config {
         int populationSize = 150;
         int numInputs = 4;
@@ -144,19 +201,85 @@ public:
         double toggleConnectionRate = 0.1;
         double crossoverRate = 0.75;
         double survivalThreshold = 0.2;
+        int tournamentSize = 0;         // Parent selection: 0 = fitness-proportional, k = best of k random members
+        int fitnessCacheSize = 0;       // Max genomes remembered by the fitness cache, 0 disables it
+        bool steadyState = false;       // rtNEAT-style continuous replacement instead of generations
+        int speciationInterval = 0;     // Steady state: re-speciate every N fitness results (0 = populationSize / 4)
+        bool noveltySearch = false;     // Select on behavioural novelty instead of the game score
+        int noveltyNeighbours = 15;     // k of the k-nearest-neighbour novelty
+        double noveltyArchiveRate = 0.1; // Fraction of evaluated behaviours kept in the novelty archive
+        EpisodeAggregate episodeAggregate = EPISODE_MEAN;
+        double episodeQuantile = 0.25;  // EPISODE_QUANTILE: fitness is this quantile of the episode scores
+        int minEpisodes = 2;            // Episodes played before a genome can be stopped early, 0 = never stop
+        double episodeConfidence = 2.0; // Stop when mean + confidence * standard error is under the elite
+    };
+
+    struct EpisodeStats {
+        uint64_t played = 0;            // Genome-episodes simulated
+        uint64_t skipped = 0;           // Genome-episodes saved by stopping genomes early
+        uint64_t genomesStopped = 0;
+
+        double getSkippedFraction() const { return played + skipped > 0 ? static_cast<double>(skipped) / (played + skipped) : 0.0; }
     };
 
+    // Plays _genomes on the course of _seed and writes one score per genome to _scores
+    using EpisodeFunction = std::function<void(const std::vector<Genome*>& _genomes, unsigned int _seed, std::vector<double>& _scores)>;
+
     NEAT(const Config& _config);
     ~NEAT();
 
     void initializePopulation();
     void evolve();
+    // Regroup the whole population into species from scratch. evolve() and reportFitness() call it.
+    void speciate();
     void evaluateFitness(std::function<double(const Genome&)> _fitnessFunction);
+    // Cached between changes. Fitness set directly on a genome (not through reportFitness or the
+    // evaluate functions) is only picked up after the next evolve().
     Genome* getBestGenome() const;
     
+    // Steady-state (rtNEAT) evolution. Results are reported one by one as they arrive, and
+    // replaceWorst() swaps the worst evaluated genome for an offspring of a good species.
+    // The returned offspring is already in the population and can be dispatched immediately.
+    void reportFitness(Genome* _genome, double _fitness);
+    Genome* replaceWorst();
+    unsigned long long getEvaluationCount() const { return m_evaluationCount; }
+    unsigned long long getReplacementCount() const { return m_replacementCount; }
+    size_t getNumSpecies() const { return m_species.size(); }
+    const std::vector<Species*>& getSpecies() const { return m_species; }
+    
+    // Fitness memoization. The seed set is hashed into every key so results obtained
+    // on different courses are never mixed up.
+    void setEvaluationSeeds(const std::vector<unsigned int>& _seeds);
+    bool lookupFitness(const Genome& _genome, double& _fitness);
+    void storeFitness(const Genome& _genome, double _fitness);
+    const FitnessCache::Stats& getFitnessCacheStats() const { return m_fitnessCache.getStats(); }
+    void resetFitnessCacheStats() { m_fitnessCache.resetStats(); }
+    
+    // Multi-episode evaluation: every genome of _genomes plays one episode per evaluation seed, the
+    // genomes still running playing each seed together in one call, and is reported with its
+    // aggregated score. From minEpisodes on, a genome whose mean score is clearly under the elite's
+    // (the best genome outside the batch, or the best lower bound inside it) plays no more episodes.
+    void evaluateEpisodes(const std::vector<Genome*>& _genomes, const EpisodeFunction& _episodeFunction);
+    const EpisodeStats& getEpisodeStats() const { return m_episodeStats; }
+    
+    // Novelty search. A behaviour is a fixed-length float descriptor of how a genome played, and
+    // its novelty (mean distance to the k nearest behaviours in the archive and the rest of the
+    // evaluated set) replaces the fitness. evaluateNovelty() is the generational counterpart of
+    // evaluateFitness(); reportBehaviours() scores a batch and reports it like reportFitness().
+    void evaluateNovelty(std::function<void(const Genome&, float*)> _behaviourFunction, size_t _behaviourSize);
+    void reportBehaviours(const std::vector<Genome*>& _genomes, const std::vector<float>& _behaviours);
+    const NoveltyArchive& getNoveltyArchive() const { return m_noveltyArchive; }
+    
     // Innovation tracking
     int getNextInnovationNumber() { return m_nextInnovationNumber++; }
     int getNextNodeId() { return m_nextNodeId++; }
+    // The same structural connection gets the same innovation number in every genome
+    int getConnectionInnovation(int _fromNode, int _toNode);
+    
+    // Island model: bring in a genome evolved by another NEAT instance in place of the worst
+    // evaluated genome. Its innovation numbers and hidden node ids are translated to this
+    // instance's own, and it keeps its fitness (islands evaluate on the same course).
+    Genome* importGenome(const Genome& _migrant);
     
     const Config& getConfig() const { return m_config; }
     std::vector<Genome*>& getPopulation() { return m_population; }
@@ -166,16 +289,39 @@ private:
     std::vector<Genome*> m_population;
     std::vector<Species*> m_species;
     std::vector<Innovation> m_innovations;
+    std::unordered_map<uint64_t, int> m_connectionInnovations; // (fromNode << 32 | toNode) -> innovation number
+    FitnessCache m_fitnessCache;
+    NoveltyArchive m_noveltyArchive;
+    std::vector<double> m_novelty;
+    uint64_t m_evaluationSeedHash;
+    std::vector<unsigned int> m_evaluationSeeds;
+    EpisodeStats m_episodeStats;
+    std::vector<double> m_episodeScores;    // Genome-major, one row of seeds per genome of the batch
+    std::vector<double> m_episodeResults;
+    std::vector<Genome*> m_episodeBatch;
+    std::vector<size_t> m_episodeActive;
     
     int m_nextInnovationNumber;
     int m_nextNodeId;
+    int m_nextSpeciesId;
+    
+    unsigned long long m_evaluationCount;
+    unsigned long long m_replacementCount;
+    int m_resultsSinceSpeciation;
+    mutable Genome* m_bestGenome;
+    mutable bool m_bestGenomeValid;
     
-    void speciate();
     void calculateAdjustedFitness();
     void removeStaleSpecies();
     void removeWeakSpecies();
     void reproduce();
     void addToSpecies(Genome* _genome);
+    Genome* findWorstEvaluated() const;
+    void removeGenome(Genome* _genome);
+    void updateBestGenome(Genome* _genome);
+    double aggregateEpisodes(double* _scores, size_t _count) const;
+    Species* selectSpecies() const;
+    Genome* createOffspring(const Species& _species) const;
 };
 
 #endif // NEAT_H 
\ No newline at end of file
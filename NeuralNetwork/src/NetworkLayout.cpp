@@ -0,0 +1,265 @@
+// File: NetworkLayout.cpp
+// Description: Implementation of the network layout
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "NetworkLayout.h"
+
+namespace
+{
+    // Only displayed genomes are laid out, a few hundred topologies cover a long run
+    const size_t MAX_CACHED_LAYOUTS = 256;
+    // Alternating down and up passes over the hidden layers
+    const int ORDERING_SWEEPS = 8;
+
+    std::mutex cacheMutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const NetworkLayout>> cache;
+
+    double orientation(double _ax, double _ay, double _bx, double _by, double _cx, double _cy)
+    {
+        return (_bx - _ax) * (_cy - _ay) - (_by - _ay) * (_cx - _ax);
+    }
+
+    // Pairs of edges, drawn as straight lines from (layer, y) to (layer, y), that cross. Edges
+    // sharing a node meet at that node and never count.
+    int countCrossings(const std::vector<std::pair<int, int>>& _edges, const std::vector<int>& _layer, const std::vector<double>& _y)
+    {
+        int crossings = 0;
+        for (size_t i = 0; i < _edges.size(); ++i)
+        {
+            int a = _edges[i].first;
+            int b = _edges[i].second;
+            for (size_t j = i + 1; j < _edges.size(); ++j)
+            {
+                int c = _edges[j].first;
+                int d = _edges[j].second;
+                if (a == c || a == d || b == c || b == d) continue;
+
+                double o1 = orientation(_layer[a], _y[a], _layer[b], _y[b], _layer[c], _y[c]);
+                double o2 = orientation(_layer[a], _y[a], _layer[b], _y[b], _layer[d], _y[d]);
+                double o3 = orientation(_layer[c], _y[c], _layer[d], _y[d], _layer[a], _y[a]);
+                double o4 = orientation(_layer[c], _y[c], _layer[d], _y[d], _layer[b], _y[b]);
+                if (o1 * o2 < 0.0 && o3 * o4 < 0.0) crossings++;
+            }
+        }
+        return crossings;
+    }
+}
+
+NetworkLayout::NetworkLayout(const Genome& _genome)
+    : m_structureHash(_genome.computeStructureHash()),
+      m_numLayers(0),
+      m_crossings(0)
+{
+    const std::vector<Genome::NodeGene>& nodes = _genome.m_nodes;
+    const int numNodes = static_cast<int>(nodes.size());
+
+    std::unordered_map<int, int> indexOfNode;
+    for (int i = 0; i < numNodes; ++i)
+    {
+        indexOfNode.emplace(nodes[i].nodeId, i);
+    }
+
+    // Enabled connections as node indices. Like CompiledNetwork, connections to missing nodes or
+    // into inputs are ignored; so are self-loops, which have nothing to lay out.
+    std::vector<std::pair<int, int>> edges;
+    std::vector<std::vector<int>> outgoing(numNodes);
+    for (const auto& connection : _genome.m_connections)
+    {
+        if (!connection.enabled) continue;
+        auto from = indexOfNode.find(connection.fromNode);
+        auto to = indexOfNode.find(connection.toNode);
+        if (from == indexOfNode.end() || to == indexOfNode.end()) continue;
+        if (from->second == to->second || nodes[to->second].isInput) continue;
+
+        outgoing[from->second].push_back(static_cast<int>(edges.size()));
+        edges.emplace_back(from->second, to->second);
+    }
+
+    // Longest paths need a DAG: a depth-first search, from the inputs first, sets aside the
+    // connections that close a cycle. Its reversed post-order is a topological order of the rest.
+    std::vector<char> state(numNodes, 0); // 0 = unvisited, 1 = on the stack, 2 = done
+    std::vector<bool> closesCycle(edges.size(), false);
+    std::vector<int> postOrder;
+    std::vector<std::pair<int, size_t>> stack;
+    postOrder.reserve(numNodes);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int root = 0; root < numNodes; ++root)
+        {
+            if (nodes[root].isInput != (pass == 0) || state[root] != 0) continue;
+
+            state[root] = 1;
+            stack.emplace_back(root, 0);
+            while (!stack.empty())
+            {
+                int node = stack.back().first;
+                size_t& next = stack.back().second;
+                if (next < outgoing[node].size())
+                {
+                    int edge = outgoing[node][next++];
+                    int target = edges[edge].second;
+                    if (state[target] == 1) closesCycle[edge] = true;
+                    else if (state[target] == 0)
+                    {
+                        state[target] = 1;
+                        stack.emplace_back(target, 0);
+                    }
+                }
+                else
+                {
+                    state[node] = 2;
+                    postOrder.push_back(node);
+                    stack.pop_back();
+                }
+            }
+        }
+    }
+
+    // Hidden nodes and outputs start in layer 1, then every node moves one past its deepest source
+    std::vector<int> layer(numNodes);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        layer[i] = nodes[i].isInput ? 0 : 1;
+    }
+    for (auto it = postOrder.rbegin(); it != postOrder.rend(); ++it)
+    {
+        for (int edge : outgoing[*it])
+        {
+            if (closesCycle[edge]) continue;
+            int target = edges[edge].second;
+            layer[target] = std::max(layer[target], layer[*it] + 1);
+        }
+    }
+
+    // Outputs share the layer after the deepest hidden node
+    int outputLayer = 1;
+    for (int i = 0; i < numNodes; ++i)
+    {
+        if (!nodes[i].isInput && !nodes[i].isOutput) outputLayer = std::max(outputLayer, layer[i] + 1);
+    }
+    for (int i = 0; i < numNodes; ++i)
+    {
+        if (nodes[i].isOutput) layer[i] = outputLayer;
+    }
+    m_numLayers = outputLayer + 1;
+
+    // Start from gene order. Inputs and outputs keep it: the client labels them by index.
+    std::vector<std::vector<int>> layers(m_numLayers);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        layers[layer[i]].push_back(i);
+    }
+
+    // Vertical position of every node in (0, 1), so layers of different sizes compare
+    std::vector<double> y(numNodes, 0.0);
+    auto place = [&](int _layer) {
+        const std::vector<int>& members = layers[_layer];
+        for (size_t k = 0; k < members.size(); ++k)
+        {
+            y[members[k]] = (k + 1.0) / (members.size() + 1.0);
+        }
+    };
+    for (int l = 0; l < m_numLayers; ++l)
+    {
+        place(l);
+    }
+
+    std::vector<std::vector<int>> neighbours(numNodes);
+    for (const auto& edge : edges)
+    {
+        neighbours[edge.first].push_back(edge.second);
+        neighbours[edge.second].push_back(edge.first);
+    }
+
+    // Barycentric ordering: each node moves to the mean height of its neighbours on the side the
+    // sweep comes from. Connections spanning several layers count like adjacent ones.
+    std::vector<std::vector<int>> bestLayers = layers;
+    int bestCrossings = countCrossings(edges, layer, y);
+    std::vector<std::pair<double, int>> keys;
+    for (int sweep = 0; sweep < ORDERING_SWEEPS && bestCrossings > 0 && m_numLayers > 2; ++sweep)
+    {
+        bool down = sweep % 2 == 0;
+        for (int step = 1; step < m_numLayers - 1; ++step)
+        {
+            int l = down ? step : m_numLayers - 1 - step;
+            keys.clear();
+            for (int node : layers[l])
+            {
+                double sum = 0.0;
+                int count = 0;
+                for (int other : neighbours[node])
+                {
+                    if (down ? layer[other] < l : layer[other] > l)
+                    {
+                        sum += y[other];
+                        count++;
+                    }
+                }
+                keys.emplace_back(count > 0 ? sum / count : y[node], node);
+            }
+            std::stable_sort(keys.begin(), keys.end(), [](const std::pair<double, int>& _a, const std::pair<double, int>& _b) {
+                return _a.first < _b.first;
+            });
+            for (size_t k = 0; k < keys.size(); ++k)
+            {
+                layers[l][k] = keys[k].second;
+            }
+            place(l);
+        }
+
+        int crossings = countCrossings(edges, layer, y);
+        if (crossings < bestCrossings)
+        {
+            bestCrossings = crossings;
+            bestLayers = layers;
+        }
+    }
+    m_crossings = bestCrossings;
+
+    std::vector<int> order(numNodes, 0);
+    for (const auto& members : bestLayers)
+    {
+        for (size_t k = 0; k < members.size(); ++k)
+        {
+            order[members[k]] = static_cast<int>(k);
+        }
+    }
+
+    m_positions.resize(numNodes);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        m_positions[i].nodeId = nodes[i].nodeId;
+        m_positions[i].layer = static_cast<uint16_t>(layer[i]);
+        m_positions[i].order = static_cast<uint16_t>(order[i]);
+    }
+}
+
+std::shared_ptr<const NetworkLayout> NetworkLayout::get(const Genome& _genome)
+{
+    uint64_t structureHash = _genome.computeStructureHash();
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(structureHash);
+    if (it != cache.end())
+    {
+        return it->second;
+    }
+
+    // Champions of old topologies are rarely shown again, start over rather than track recency
+    if (cache.size() >= MAX_CACHED_LAYOUTS) cache.clear();
+
+    std::shared_ptr<const NetworkLayout> layout = std::make_shared<NetworkLayout>(_genome);
+    cache[structureHash] = layout;
+    return layout;
+}
+
+void NetworkLayout::clearCache()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+}
@@ -0,0 +1,43 @@
+// File: NetworkLayout.h
+// Description: Definition of the network layout used to draw genomes. Nodes are placed in layers by
+//              longest path from the inputs, with every output in the last layer, and the nodes of
+//              each hidden layer are ordered by barycentric sweeps to reduce edge crossings. A layout
+//              only depends on the topology, so layouts are cached by structure hash.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef NETWORK_LAYOUT_H
+#define NETWORK_LAYOUT_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "NEAT.h"
+
+class NetworkLayout {
+public:
+    struct Position {
+        int nodeId;
+        uint16_t layer;                 // 0 = inputs, getNumLayers() - 1 = outputs
+        uint16_t order;                 // Rank in the layer, from the top
+    };
+
+    // Cached layout of _genome's topology, computed on first use. Safe to call from any thread.
+    static std::shared_ptr<const NetworkLayout> get(const Genome& _genome);
+    static void clearCache();
+
+    explicit NetworkLayout(const Genome& _genome);
+
+    uint64_t getStructureHash() const { return m_structureHash; }
+    int getNumLayers() const { return m_numLayers; }
+    int getCrossings() const { return m_crossings; }      // Edge crossings left after ordering
+    const std::vector<Position>& getPositions() const { return m_positions; } // In node gene order
+
+private:
+    uint64_t m_structureHash;
+    int m_numLayers;
+    int m_crossings;
+    std::vector<Position> m_positions;
+};
+
+#endif // NETWORK_LAYOUT_H
@@ -0,0 +1,252 @@
+// File: NoveltyArchive.cpp
+// Description: Implementation of the novelty search archive
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include "NoveltyArchive.h"
+
+namespace
+{
+    const size_t LEAF_SIZE = 16;
+    // Points added after a rebuild are scanned linearly; the tree is rebuilt once they
+    // outnumber this or an eighth of the indexed points, whichever is larger
+    const size_t MIN_TAIL_SIZE = 256;
+}
+
+float NoveltyArchive::Neighbours::getWorst() const
+{
+    return distances.size() < k ? std::numeric_limits<float>::infinity() : distances.front();
+}
+
+void NoveltyArchive::Neighbours::push(float _distance)
+{
+    if (distances.size() < k)
+    {
+        distances.push_back(_distance);
+        std::push_heap(distances.begin(), distances.end());
+    }
+    else if (k > 0 && _distance < distances.front())
+    {
+        std::pop_heap(distances.begin(), distances.end());
+        distances.back() = _distance;
+        std::push_heap(distances.begin(), distances.end());
+    }
+}
+
+double NoveltyArchive::Neighbours::getMean() const
+{
+    if (distances.empty()) return 0.0;
+    double sum = 0.0;
+    for (float distance : distances)
+    {
+        sum += distance;
+    }
+    return sum / distances.size();
+}
+
+NoveltyArchive::NoveltyArchive(const Config& _config)
+    : m_config(_config),
+      m_dimensions(0),
+      m_size(0),
+      m_indexedSize(0),
+      m_rng(_config.seed)
+{
+    m_config.neighbours = std::max(1, m_config.neighbours);
+}
+
+NoveltyArchive::~NoveltyArchive()
+{
+}
+
+void NoveltyArchive::reset(size_t _dimensions)
+{
+    m_dimensions = _dimensions;
+    m_size = 0;
+    m_indexedSize = 0;
+    m_points.clear();
+    m_order.clear();
+    m_nodes.clear();
+}
+
+void NoveltyArchive::computeNovelty(const float* _descriptors, size_t _count, std::vector<double>& _novelty)
+{
+    _novelty.resize(_count);
+    for (size_t i = 0; i < _count; ++i)
+    {
+        const float* descriptor = _descriptors + i * m_dimensions;
+        m_neighbours.clear(m_config.neighbours);
+        if (!m_nodes.empty()) search(0, descriptor);
+        searchTail(descriptor);
+
+        // The rest of the batch counts as well, the population is small enough for a linear scan
+        for (size_t j = 0; j < _count; ++j)
+        {
+            if (j != i) m_neighbours.push(distance(descriptor, _descriptors + j * m_dimensions));
+        }
+
+        _novelty[i] = m_neighbours.getMean();
+        m_stats.queries++;
+    }
+}
+
+size_t NoveltyArchive::archive(const float* _descriptors, size_t _count)
+{
+    std::bernoulli_distribution keep(m_config.archiveRate);
+    size_t kept = 0;
+    for (size_t i = 0; i < _count && m_size < m_config.maxSize; ++i)
+    {
+        if (!keep(m_rng)) continue;
+        add(_descriptors + i * m_dimensions);
+        kept++;
+    }
+    return kept;
+}
+
+void NoveltyArchive::add(const float* _descriptor)
+{
+    if (m_size >= m_config.maxSize) return;
+
+    m_points.insert(m_points.end(), _descriptor, _descriptor + m_dimensions);
+    m_size++;
+
+    if (m_size - m_indexedSize > std::max(MIN_TAIL_SIZE, m_indexedSize / 8))
+    {
+        rebuild();
+    }
+}
+
+double NoveltyArchive::query(const float* _descriptor)
+{
+    m_neighbours.clear(m_config.neighbours);
+    if (!m_nodes.empty()) search(0, _descriptor);
+    searchTail(_descriptor);
+    m_stats.queries++;
+    return m_neighbours.getMean();
+}
+
+double NoveltyArchive::queryLinear(const float* _descriptor)
+{
+    m_neighbours.clear(m_config.neighbours);
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        m_neighbours.push(distance(_descriptor, &m_points[i * m_dimensions]));
+    }
+    m_stats.queries++;
+    return m_neighbours.getMean();
+}
+
+float NoveltyArchive::distance(const float* _a, const float* _b)
+{
+    m_stats.distances++;
+    float sum = 0.0f;
+    for (size_t d = 0; d < m_dimensions; ++d)
+    {
+        float difference = _a[d] - _b[d];
+        sum += difference * difference;
+    }
+    return std::sqrt(sum);
+}
+
+void NoveltyArchive::rebuild()
+{
+    m_order.resize(m_size);
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        m_order[i] = static_cast<uint32_t>(i);
+    }
+    m_nodes.clear();
+    m_nodes.reserve(2 * m_size / LEAF_SIZE + 1);
+    m_buildScratch.resize(m_size);
+
+    build(0, m_size);
+    m_indexedSize = m_size;
+    m_stats.rebuilds++;
+}
+
+int32_t NoveltyArchive::build(size_t _begin, size_t _end)
+{
+    if (_begin == _end) return -1;
+
+    int32_t index = static_cast<int32_t>(m_nodes.size());
+    m_nodes.push_back(TreeNode());
+
+    if (_end - _begin <= LEAF_SIZE)
+    {
+        TreeNode& leaf = m_nodes[index];
+        leaf.vantage = static_cast<uint32_t>(_begin);
+        leaf.count = static_cast<uint32_t>(_end - _begin);
+        leaf.radius = 0.0f;
+        leaf.inside = -1;
+        leaf.outside = -1;
+        return index;
+    }
+
+    // Random vantage point, the other points are split on the median distance to it
+    size_t pick = std::uniform_int_distribution<size_t>(_begin, _end - 1)(m_rng);
+    std::swap(m_order[_begin], m_order[pick]);
+    const float* vantage = &m_points[m_order[_begin] * m_dimensions];
+
+    for (size_t i = _begin + 1; i < _end; ++i)
+    {
+        m_buildScratch[i] = std::make_pair(distance(vantage, &m_points[m_order[i] * m_dimensions]), m_order[i]);
+    }
+    size_t middle = _begin + 1 + (_end - _begin - 1) / 2;
+    std::nth_element(m_buildScratch.begin() + _begin + 1, m_buildScratch.begin() + middle, m_buildScratch.begin() + _end);
+    for (size_t i = _begin + 1; i < _end; ++i)
+    {
+        m_order[i] = m_buildScratch[i].second;
+    }
+    float radius = m_buildScratch[middle].first;
+
+    int32_t inside = build(_begin + 1, middle);
+    int32_t outside = build(middle, _end);
+
+    TreeNode& node = m_nodes[index];
+    node.vantage = m_order[_begin];
+    node.count = 0;
+    node.radius = radius;
+    node.inside = inside;
+    node.outside = outside;
+    return index;
+}
+
+void NoveltyArchive::search(int32_t _node, const float* _descriptor)
+{
+    const TreeNode& node = m_nodes[_node];
+    if (node.count > 0)
+    {
+        for (uint32_t i = node.vantage; i < node.vantage + node.count; ++i)
+        {
+            m_neighbours.push(distance(_descriptor, &m_points[m_order[i] * m_dimensions]));
+        }
+        return;
+    }
+
+    // Inside points are at most radius from the vantage point and outside points at least
+    // radius, so by the triangle inequality a side can be skipped once the k-th best distance
+    // is shorter than the gap between the query's distance and the radius
+    float d = distance(_descriptor, &m_points[node.vantage * m_dimensions]);
+    m_neighbours.push(d);
+    if (d < node.radius)
+    {
+        if (node.inside >= 0) search(node.inside, _descriptor);
+        if (node.outside >= 0 && d + m_neighbours.getWorst() >= node.radius) search(node.outside, _descriptor);
+    }
+    else
+    {
+        if (node.outside >= 0) search(node.outside, _descriptor);
+        if (node.inside >= 0 && d - m_neighbours.getWorst() <= node.radius) search(node.inside, _descriptor);
+    }
+}
+
+void NoveltyArchive::searchTail(const float* _descriptor)
+{
+    for (size_t i = m_indexedSize; i < m_size; ++i)
+    {
+        m_neighbours.push(distance(_descriptor, &m_points[i * m_dimensions]));
+    }
+}
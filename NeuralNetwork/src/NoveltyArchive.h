@@ -0,0 +1,100 @@
+// File: NoveltyArchive.h
+// Description: Definition of the novelty search archive. Behaviour descriptors are fixed-length
+//              float vectors, and the novelty of a behaviour is its mean Euclidean distance to its k
+//              nearest neighbours. Archived behaviours are indexed by a vantage-point tree; the ones
+//              added since the last rebuild are scanned linearly until the tree is rebuilt.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef NOVELTY_ARCHIVE_H
+#define NOVELTY_ARCHIVE_H
+
+#include <vector>
+#include <random>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+class NoveltyArchive {
+public:
+    struct Config {
+        int neighbours = 15;            // k of the k-nearest-neighbour distance
+        double archiveRate = 0.1;       // Probability for an evaluated behaviour to be archived
+        size_t maxSize = 1000000;       // The archive stops growing past this size
+        unsigned int seed = 1;
+    };
+
+    struct Stats {
+        uint64_t queries = 0;
+        uint64_t distances = 0;         // Distance computations, tree and linear tail together
+        uint64_t rebuilds = 0;
+
+        double getDistancesPerQuery() const { return queries > 0 ? static_cast<double>(distances) / queries : 0.0; }
+    };
+
+    NoveltyArchive(const Config& _config);
+    ~NoveltyArchive();
+
+    // Forget every behaviour and switch to descriptors of _dimensions floats
+    void reset(size_t _dimensions);
+
+    // Novelty of each of the _count descriptors stored back to back in _descriptors, against the
+    // archive and the other descriptors of the batch (usually the population being evaluated)
+    void computeNovelty(const float* _descriptors, size_t _count, std::vector<double>& _novelty);
+
+    // Archive each descriptor with probability archiveRate, returns how many were kept
+    size_t archive(const float* _descriptors, size_t _count);
+    void add(const float* _descriptor);
+
+    // Mean distance to the k nearest archived behaviours, tree search
+    double query(const float* _descriptor);
+    // Same result by a linear scan of the whole archive, for comparison
+    double queryLinear(const float* _descriptor);
+
+    size_t getSize() const { return m_size; }
+    size_t getDimensions() const { return m_dimensions; }
+    const Stats& getStats() const { return m_stats; }
+    void resetStats() { m_stats = Stats(); }
+
+private:
+    // Inner nodes split their points on the distance to the vantage point; leaves hold a small
+    // range of m_order that is scanned linearly
+    struct TreeNode {
+        uint32_t vantage;               // Point index, or first m_order position for a leaf
+        uint32_t count;                 // Leaf size, 0 for an inner node
+        float radius;                   // Median distance to the vantage point
+        int32_t inside;                 // Children: distance < radius, distance >= radius
+        int32_t outside;
+    };
+
+    // Bounded max-heap of the k best (distance, point) pairs found so far
+    struct Neighbours {
+        std::vector<float> distances;
+        size_t k = 0;
+
+        void clear(size_t _k) { distances.clear(); k = _k; }
+        float getWorst() const;
+        void push(float _distance);
+        double getMean() const;
+    };
+
+    Config m_config;
+    size_t m_dimensions;
+    size_t m_size;
+    std::vector<float> m_points;        // m_size descriptors back to back
+    std::vector<uint32_t> m_order;      // Indexed points, grouped by leaf
+    std::vector<TreeNode> m_nodes;
+    size_t m_indexedSize;               // Points [0, m_indexedSize) are in the tree
+    std::vector<std::pair<float, uint32_t>> m_buildScratch;
+    Neighbours m_neighbours;
+    std::mt19937 m_rng;
+    Stats m_stats;
+
+    float distance(const float* _a, const float* _b);
+    void rebuild();
+    int32_t build(size_t _begin, size_t _end);
+    void search(int32_t _node, const float* _descriptor);
+    void searchTail(const float* _descriptor);
+};
+
+#endif // NOVELTY_ARCHIVE_H
@@ -0,0 +1,94 @@
+// File: ObstacleSchedule.cpp
+// Description: Implementation of the obstacle schedule
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <map>
+#include <mutex>
+#include <random>
+#include "ObstacleSchedule.h"
+
+namespace
+{
+    // Spawn timing (matching DinoGame.addObstacle)
+    const int MINIMUM_TIME_BETWEEN_OBSTACLES = 100;
+    const int RANDOM_TIME_BETWEEN_OBSTACLES = 50;
+    const int NUM_OBSTACLE_TYPES = 6;
+
+    std::mutex cacheMutex;
+    std::map<unsigned int, std::shared_ptr<const ObstacleSchedule>> cache;
+}
+
+ObstacleSchedule::ObstacleSchedule(unsigned int _seed, uint32_t _numFrames)
+    : m_seed(_seed),
+      m_numFrames(_numFrames)
+{
+    // Same draws, in the same order, as the game: the gap after each obstacle, then the type of the next
+    std::mt19937 rng(_seed);
+    int timerBetweenObstacles = 0;
+    int randomAdditionOfNewObstacles = std::uniform_int_distribution<>(0, RANDOM_TIME_BETWEEN_OBSTACLES - 1)(rng);
+    m_spawns.reserve(_numFrames / MINIMUM_TIME_BETWEEN_OBSTACLES + 1);
+
+    for (uint32_t frame = 0; frame < _numFrames; ++frame)
+    {
+        timerBetweenObstacles++;
+        if (timerBetweenObstacles > MINIMUM_TIME_BETWEEN_OBSTACLES + randomAdditionOfNewObstacles)
+        {
+            int type = std::uniform_int_distribution<>(0, NUM_OBSTACLE_TYPES - 1)(rng);
+            m_spawns.push_back(makeSpawn(frame, type));
+
+            timerBetweenObstacles = 0;
+            randomAdditionOfNewObstacles = std::uniform_int_distribution<>(0, RANDOM_TIME_BETWEEN_OBSTACLES - 1)(rng);
+        }
+    }
+}
+
+std::shared_ptr<const ObstacleSchedule> ObstacleSchedule::get(unsigned int _seed, uint32_t _numFrames)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(_seed);
+    if (it != cache.end() && it->second->getNumFrames() >= _numFrames)
+    {
+        return it->second;
+    }
+
+    // A longer course starts with the same spawns, so it replaces the shorter one
+    std::shared_ptr<const ObstacleSchedule> schedule = std::make_shared<ObstacleSchedule>(_seed, _numFrames);
+    cache[_seed] = schedule;
+    return schedule;
+}
+
+void ObstacleSchedule::clearCache()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+}
+
+ObstacleSchedule::Spawn ObstacleSchedule::makeSpawn(uint32_t _frame, int _type)
+{
+    Spawn spawn;
+    spawn.frame = _frame;
+    spawn.type = static_cast<uint8_t>(_type);
+
+    switch (_type)
+    {
+    case 0: // SMALL_CACTUS
+    case 1: // SMALL_CACTUS_MANY
+        spawn.width = 40; spawn.height = 80; spawn.positionY = 0;
+        break;
+    case 2: // BIG_CACTUS
+        spawn.width = 60; spawn.height = 120; spawn.positionY = 0;
+        break;
+    case 3: // BIRD_LOW
+        spawn.width = 60; spawn.height = 50; spawn.positionY = 40;
+        break;
+    case 4: // BIRD_MIDDLE
+        spawn.width = 60; spawn.height = 50; spawn.positionY = 120;
+        break;
+    default: // BIRD_HIGH
+        spawn.width = 60; spawn.height = 50; spawn.positionY = 160;
+        break;
+    }
+
+    return spawn;
+}
@@ -0,0 +1,47 @@
+// File: ObstacleSchedule.h
+// Description: Definition of the obstacle schedule. A schedule is the full list of obstacle spawns
+//              of one course (spawn frame, type, size and height above the ground), generated once
+//              from a seed with the rules of web/js/dinoGame.js. Schedules are immutable and cached
+//              by seed, so every evaluator thread replays the same course from one shared array.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef OBSTACLE_SCHEDULE_H
+#define OBSTACLE_SCHEDULE_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+class ObstacleSchedule {
+public:
+    // 8 bytes per obstacle
+    struct Spawn {
+        uint32_t frame;                 // Index of the game update that adds the obstacle, from 0
+        uint8_t type;                   // DinoSimulator::ObstacleType
+        uint8_t width;
+        uint8_t height;
+        uint8_t positionY;
+    };
+
+    // Cached schedule of _seed covering at least _numFrames frames, created on first use.
+    // Safe to call from any thread.
+    static std::shared_ptr<const ObstacleSchedule> get(unsigned int _seed, uint32_t _numFrames);
+    static void clearCache();
+
+    unsigned int getSeed() const { return m_seed; }
+    uint32_t getNumFrames() const { return m_numFrames; }
+    const std::vector<Spawn>& getSpawns() const { return m_spawns; }
+
+    // Size and height of an obstacle type (matching Obstacle.setObstacleSizeAndPosition)
+    static Spawn makeSpawn(uint32_t _frame, int _type);
+
+    ObstacleSchedule(unsigned int _seed, uint32_t _numFrames);
+
+private:
+    unsigned int m_seed;
+    uint32_t m_numFrames;
+    std::vector<Spawn> m_spawns;
+};
+
+#endif // OBSTACLE_SCHEDULE_H
@@ -0,0 +1,333 @@
+// File: Profiler.cpp
+// Description: Implementation of the built-in profiler
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "Profiler.h"
+
+namespace
+{
+    // Zone and thread names are identifiers chosen in the code, only quotes and backslashes need care
+    void appendEscaped(std::string& _out, const std::string& _text)
+    {
+        for (char c : _text)
+        {
+            if (c == '"' || c == '\\') _out += '\\';
+            _out += c;
+        }
+    }
+}
+
+Profiler::ThreadData::ThreadData()
+    : traceEvents(nullptr),
+      traceCount(0),
+      traceEpoch(0),
+      traceDropped(0)
+{
+    for (auto& zone : zones)
+    {
+        zone.calls.store(0, std::memory_order_relaxed);
+        zone.totalNs.store(0, std::memory_order_relaxed);
+        zone.maxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+Profiler::ThreadData::~ThreadData()
+{
+    delete[] traceEvents.load();
+}
+
+Profiler::ThreadDataOwner::~ThreadDataOwner()
+{
+    if (data) Profiler::instance().retireThreadData(data);
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_startTime(std::chrono::steady_clock::now()),
+      m_enabled(true),
+      m_tracing(false),
+      m_traceEpoch(0),
+      m_numZones(0),
+      m_nextThreadIndex(0)
+{
+    std::fill(m_zoneNames, m_zoneNames + MAX_ZONES, nullptr);
+    std::fill(m_zoneIsCounter, m_zoneIsCounter + MAX_ZONES, false);
+}
+
+Profiler::~Profiler()
+{
+}
+
+int Profiler::registerZone(const char* _name, bool _isCounter)
+{
+    std::lock_guard<std::mutex> lock(m_zonesMutex);
+    int numZones = m_numZones.load(std::memory_order_relaxed);
+    for (int i = 0; i < numZones; ++i)
+    {
+        if (std::strcmp(m_zoneNames[i], _name) == 0) return i;
+    }
+    // Past the limit the probe records nothing
+    if (numZones == MAX_ZONES) return -1;
+
+    m_zoneNames[numZones] = _name;
+    m_zoneIsCounter[numZones] = _isCounter;
+    m_numZones.store(numZones + 1, std::memory_order_release);
+    return numZones;
+}
+
+void Profiler::setThreadName(const char* _name)
+{
+    ThreadData* data = getThreadData();
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    data->name = _name;
+}
+
+Profiler::ThreadData* Profiler::getThreadData()
+{
+    // Registered once per thread, the only time a probe takes a lock
+    thread_local ThreadDataOwner owner;
+    if (!owner.data)
+    {
+        std::lock_guard<std::mutex> lock(m_threadsMutex);
+        m_threads.emplace_back(new ThreadData());
+        owner.data = m_threads.back().get();
+        owner.data->threadIndex = m_nextThreadIndex++;
+    }
+    return owner.data;
+}
+
+void Profiler::retireThreadData(ThreadData* _data)
+{
+    // Called by the exiting thread, the slot's only writer, so its zones are final
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    for (int i = 0; i < MAX_ZONES; ++i)
+    {
+        const ZoneSlot& slot = _data->zones[i];
+        ZoneTotals& totals = m_retiredZones[i];
+        totals.calls += slot.calls.load(std::memory_order_relaxed);
+        totals.totalNs += slot.totalNs.load(std::memory_order_relaxed);
+        totals.maxNs = std::max(totals.maxNs, slot.maxNs.load(std::memory_order_relaxed));
+    }
+    _data->retired = true;
+
+    // Events of the last trace are still to be exported, startTrace frees the slot
+    bool hasTrace = _data->traceCount.load(std::memory_order_relaxed) > 0 &&
+                    _data->traceEpoch.load(std::memory_order_relaxed) == m_traceEpoch.load(std::memory_order_acquire);
+    if (hasTrace) return;
+
+    m_threads.erase(std::find_if(m_threads.begin(), m_threads.end(),
+                                 [&](const std::unique_ptr<ThreadData>& _slot) { return _slot.get() == _data; }));
+}
+
+void Profiler::record(int _zone, int64_t _startNs, int64_t _endNs)
+{
+    if (_zone < 0) return;
+
+    ThreadData& data = *getThreadData();
+    ZoneSlot& slot = data.zones[_zone];
+    uint64_t duration = static_cast<uint64_t>(std::max<int64_t>(0, _endNs - _startNs));
+    slot.calls.store(slot.calls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    slot.totalNs.store(slot.totalNs.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+    if (duration > slot.maxNs.load(std::memory_order_relaxed))
+    {
+        slot.maxNs.store(duration, std::memory_order_relaxed);
+    }
+
+    if (m_tracing.load(std::memory_order_relaxed))
+    {
+        addTraceEvent(data, _zone, _startNs, _endNs);
+    }
+}
+
+void Profiler::count(int _zone, uint64_t _value)
+{
+    if (_zone < 0) return;
+
+    ZoneSlot& slot = getThreadData()->zones[_zone];
+    slot.calls.store(slot.calls.load(std::memory_order_relaxed) + _value, std::memory_order_relaxed);
+}
+
+void Profiler::addTraceEvent(ThreadData& _data, int _zone, int64_t _startNs, int64_t _endNs)
+{
+    // The first event of a new trace drops this thread's events of the previous one. The count
+    // is cleared before the epoch moves, so a reader that sees the new epoch never sees old events.
+    uint64_t epoch = m_traceEpoch.load(std::memory_order_acquire);
+    if (_data.traceEpoch.load(std::memory_order_relaxed) != epoch)
+    {
+        _data.traceCount.store(0, std::memory_order_relaxed);
+        _data.traceDropped.store(0, std::memory_order_relaxed);
+        _data.traceEpoch.store(epoch, std::memory_order_release);
+    }
+
+    TraceEvent* events = _data.traceEvents.load(std::memory_order_relaxed);
+    if (!events)
+    {
+        events = new TraceEvent[TRACE_EVENTS_PER_THREAD];
+        _data.traceEvents.store(events, std::memory_order_release);
+    }
+
+    size_t count = _data.traceCount.load(std::memory_order_relaxed);
+    if (count == TRACE_EVENTS_PER_THREAD)
+    {
+        _data.traceDropped.store(_data.traceDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return;
+    }
+
+    events[count].startNs = _startNs;
+    events[count].durationNs = _endNs - _startNs;
+    events[count].zone = _zone;
+    _data.traceCount.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::startTrace()
+{
+    m_traceEpoch.fetch_add(1, std::memory_order_acq_rel);
+    m_tracing.store(true, std::memory_order_release);
+
+    // The previous trace is dropped, and with it the slots of exited threads kept for it
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    m_threads.erase(std::remove_if(m_threads.begin(), m_threads.end(),
+                                   [](const std::unique_ptr<ThreadData>& _slot) { return _slot->retired; }),
+                    m_threads.end());
+}
+
+void Profiler::stopTrace()
+{
+    m_tracing.store(false, std::memory_order_release);
+}
+
+std::vector<Profiler::ZoneStats> Profiler::getStats() const
+{
+    int numZones = m_numZones.load(std::memory_order_acquire);
+    std::vector<ZoneStats> stats(numZones);
+    {
+        std::lock_guard<std::mutex> lock(m_zonesMutex);
+        for (int i = 0; i < numZones; ++i)
+        {
+            stats[i].name = m_zoneNames[i];
+            stats[i].isCounter = m_zoneIsCounter[i];
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    for (int i = 0; i < numZones; ++i)
+    {
+        stats[i].calls = m_retiredZones[i].calls;
+        stats[i].totalNs = m_retiredZones[i].totalNs;
+        stats[i].maxNs = m_retiredZones[i].maxNs;
+    }
+    for (const auto& data : m_threads)
+    {
+        if (data->retired) continue;
+        for (int i = 0; i < numZones; ++i)
+        {
+            const ZoneSlot& slot = data->zones[i];
+            stats[i].calls += slot.calls.load(std::memory_order_relaxed);
+            stats[i].totalNs += slot.totalNs.load(std::memory_order_relaxed);
+            stats[i].maxNs = std::max(stats[i].maxNs, slot.maxNs.load(std::memory_order_relaxed));
+        }
+    }
+    return stats;
+}
+
+std::string Profiler::formatMetrics() const
+{
+    std::vector<ZoneStats> stats = getStats();
+    std::string out;
+    char value[64];
+
+    // Every sample of a metric follows its TYPE line
+    auto writeMetric = [&](const char* _metric, const char* _type, const char* _label, bool _counters,
+                           const char* _format, double (*_get)(const ZoneStats&)) {
+        out += "# TYPE ";
+        out += _metric;
+        out += ' ';
+        out += _type;
+        out += '\n';
+        for (const auto& zone : stats)
+        {
+            if (zone.isCounter != _counters) continue;
+            out += _metric;
+            out += '{';
+            out += _label;
+            out += "=\"";
+            appendEscaped(out, zone.name);
+            out += "\"} ";
+            std::snprintf(value, sizeof(value), _format, _get(zone));
+            out += value;
+            out += '\n';
+        }
+    };
+
+    writeMetric("profiler_zone_calls_total", "counter", "zone", false, "%.0f",
+                [](const ZoneStats& _zone) { return static_cast<double>(_zone.calls); });
+    writeMetric("profiler_zone_seconds_total", "counter", "zone", false, "%.9f",
+                [](const ZoneStats& _zone) { return _zone.totalNs * 1e-9; });
+    writeMetric("profiler_zone_max_seconds", "gauge", "zone", false, "%.9f",
+                [](const ZoneStats& _zone) { return _zone.maxNs * 1e-9; });
+    writeMetric("profiler_counter_total", "counter", "counter", true, "%.0f",
+                [](const ZoneStats& _zone) { return static_cast<double>(_zone.calls); });
+    return out;
+}
+
+std::string Profiler::getTraceJSON() const
+{
+    uint64_t epoch = m_traceEpoch.load(std::memory_order_acquire);
+    int numZones = m_numZones.load(std::memory_order_acquire);
+    std::vector<std::string> zoneNames(numZones);
+    {
+        std::lock_guard<std::mutex> lock(m_zonesMutex);
+        for (int i = 0; i < numZones; ++i)
+        {
+            zoneNames[i] = m_zoneNames[i];
+        }
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char buffer[160];
+    uint64_t dropped = 0;
+
+    std::lock_guard<std::mutex> lock(m_threadsMutex);
+    for (const auto& data : m_threads)
+    {
+        if (epoch == 0 || data->traceEpoch.load(std::memory_order_acquire) != epoch) continue;
+        size_t count = data->traceCount.load(std::memory_order_acquire);
+        const TraceEvent* events = data->traceEvents.load(std::memory_order_acquire);
+        if (count == 0 || !events) continue;
+        dropped += data->traceDropped.load(std::memory_order_relaxed);
+
+        std::string threadName = data->name.empty() ? "thread " + std::to_string(data->threadIndex) : data->name;
+        out += first ? "" : ",";
+        first = false;
+        std::snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"",
+                      data->threadIndex);
+        out += buffer;
+        appendEscaped(out, threadName);
+        out += "\"}}";
+
+        // Timestamps and durations in microseconds
+        for (size_t i = 0; i < count; ++i)
+        {
+            const TraceEvent& event = events[i];
+            out += ",{\"name\":\"";
+            appendEscaped(out, event.zone < numZones ? zoneNames[event.zone] : std::string("?"));
+            std::snprintf(buffer, sizeof(buffer), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                          data->threadIndex, event.startNs * 1e-3, event.durationNs * 1e-3);
+            out += buffer;
+        }
+    }
+    // Scopes that ended once a thread's buffer was full
+    std::snprintf(buffer, sizeof(buffer), "],\"otherData\":{\"droppedEvents\":%llu}}", static_cast<unsigned long long>(dropped));
+    out += buffer;
+    return out;
+}
@@ -0,0 +1,184 @@
+// File: Profiler.h
+// Description: Definition of the built-in profiler. PROFILE_SCOPE times a block and PROFILE_COUNT adds
+//              to a counter; both aggregate into slots owned by the calling thread, written without
+//              locks or atomic read-modify-writes, and summed over threads only when read. The totals
+//              are served as plain-text metrics, and a Chrome trace (chrome://tracing, Perfetto) can be
+//              recorded between startTrace and stopTrace. Build with PROFILER_ENABLED=0 to compile
+//              every probe out.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+class Profiler {
+public:
+    static const int MAX_ZONES = 64;
+    static const size_t TRACE_EVENTS_PER_THREAD = 1 << 15;
+
+    // Totals of one zone over every thread. For a counter, calls is the summed value.
+    struct ZoneStats {
+        std::string name;
+        bool isCounter = false;
+        uint64_t calls = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+    };
+
+    static Profiler& instance();
+
+    // Id of the zone or counter called _name, created on first use. Ids are handed out once per
+    // call site by the macros below; the same name from several call sites shares one id.
+    int registerZone(const char* _name, bool _isCounter = false);
+
+    // Probes still run their registration but record nothing while disabled
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool _enabled) { m_enabled.store(_enabled, std::memory_order_relaxed); }
+
+    // Shown as the thread's name in traces
+    void setThreadName(const char* _name);
+
+    // Nanoseconds since the profiler was created
+    int64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+    }
+    void record(int _zone, int64_t _startNs, int64_t _endNs);
+    void count(int _zone, uint64_t _value);
+
+    // Zones in registration order, summed over threads
+    std::vector<ZoneStats> getStats() const;
+    // Prometheus text exposition format
+    std::string formatMetrics() const;
+
+    // Record every timed scope that ends in between. Starting a trace drops the previous one.
+    void startTrace();
+    void stopTrace();
+    bool isTracing() const { return m_tracing.load(std::memory_order_relaxed); }
+    bool hasTrace() const { return m_traceEpoch.load(std::memory_order_relaxed) > 0; }
+    // Chrome trace-event JSON of the last trace
+    std::string getTraceJSON() const;
+
+private:
+    // Written by the owning thread only, read by anyone: plain loads and stores, no locked instructions
+    struct ZoneSlot {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> totalNs;
+        std::atomic<uint64_t> maxNs;
+    };
+
+    struct TraceEvent {
+        int64_t startNs;
+        int64_t durationNs;
+        int zone;
+    };
+
+    struct ThreadData {
+        int threadIndex = 0;
+        std::string name;               // Guarded by m_threadsMutex
+        bool retired = false;           // Guarded by m_threadsMutex: exited, zones folded into m_retiredZones
+        ZoneSlot zones[MAX_ZONES];
+        // Allocated on the thread's first traced scope. The first traceCount events belong to the
+        // trace of traceEpoch; the owner starts over when it sees a new epoch.
+        std::atomic<TraceEvent*> traceEvents;
+        std::atomic<size_t> traceCount;
+        std::atomic<uint64_t> traceEpoch;
+        std::atomic<uint64_t> traceDropped;   // Events past TRACE_EVENTS_PER_THREAD
+
+        ThreadData();
+        ~ThreadData();
+    };
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Thread-local owner of a thread's data, hands it back through retireThreadData when the thread exits
+    struct ThreadDataOwner {
+        ThreadData* data = nullptr;
+        ~ThreadDataOwner();
+    };
+
+    struct ZoneTotals {
+        uint64_t calls = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+    };
+
+    ThreadData* getThreadData();
+    void retireThreadData(ThreadData* _data);
+    void addTraceEvent(ThreadData& _data, int _zone, int64_t _startNs, int64_t _endNs);
+
+    std::chrono::steady_clock::time_point m_startTime;
+    std::atomic<bool> m_enabled;
+    std::atomic<bool> m_tracing;
+    std::atomic<uint64_t> m_traceEpoch;
+
+    mutable std::mutex m_zonesMutex;
+    const char* m_zoneNames[MAX_ZONES];
+    bool m_zoneIsCounter[MAX_ZONES];
+    std::atomic<int> m_numZones;
+
+    // One slot per live thread. When a thread exits its totals move to m_retiredZones and its slot
+    // and trace buffer are freed, so short-lived threads (one per WebSocket connection) do not add
+    // up. A slot holding events of the last trace is kept, retired, until the next trace starts.
+    mutable std::mutex m_threadsMutex;
+    std::vector<std::unique_ptr<ThreadData>> m_threads;
+    ZoneTotals m_retiredZones[MAX_ZONES];
+    int m_nextThreadIndex;
+};
+
+// Times the enclosing scope, see PROFILE_SCOPE
+class ProfileScope {
+public:
+    explicit ProfileScope(int _zone)
+        : m_zone(_zone),
+          m_startNs(Profiler::instance().isEnabled() ? Profiler::instance().now() : -1)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (m_startNs >= 0) Profiler::instance().record(m_zone, m_startNs, Profiler::instance().now());
+    }
+
+private:
+    int m_zone;
+    int64_t m_startNs;
+};
+
+#define PROFILER_CONCAT_INNER(_a, _b) _a##_b
+#define PROFILER_CONCAT(_a, _b) PROFILER_CONCAT_INNER(_a, _b)
+
+#if PROFILER_ENABLED
+// Time the rest of the enclosing scope as zone _name (a string literal)
+#define PROFILE_SCOPE(_name) \
+    static const int PROFILER_CONCAT(profileZone, __LINE__) = Profiler::instance().registerZone(_name); \
+    ProfileScope PROFILER_CONCAT(profileScope, __LINE__)(PROFILER_CONCAT(profileZone, __LINE__))
+
+// Add _value to counter _name (a string literal)
+#define PROFILE_COUNT(_name, _value) \
+    do { \
+        static const int profileCounter = Profiler::instance().registerZone(_name, true); \
+        if (Profiler::instance().isEnabled()) Profiler::instance().count(profileCounter, _value); \
+    } while (0)
+#else
+#define PROFILE_SCOPE(_name) do {} while (0)
+#define PROFILE_COUNT(_name, _value) do {} while (0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,724 @@
+// File: SharedMemoryTransport.cpp
+// Description: Implementation of the shared-memory transport to local evaluator processes
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <thread>
+#include "SharedMemoryTransport.h"
+#include "NEAT.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+#endif
+
+namespace {
+    const uint32_t REGION_MAGIC = 0x4E454154;  // "NEAT"
+    const size_t MIN_RING_BYTES = 4096;
+
+    // Every ring record starts with this header and is padded to a multiple of 8 bytes
+    struct RecordHeader {
+        uint32_t size;
+        uint32_t flags;
+    };
+    const uint32_t RECORD_PADDING = 1;
+
+    // Packed genome: header, then the node genes, then the connection genes
+    struct PackedGenomeHeader {
+        int32_t genomeId;
+        uint32_t numNodes;
+        uint32_t numConnections;
+        uint32_t reserved;
+    };
+
+    struct PackedNode {
+        double bias;
+        int32_t nodeId;
+        uint8_t isInput;
+        uint8_t isOutput;
+        uint8_t reserved[2];
+    };
+
+    struct PackedConnection {
+        double weight;
+        int32_t fromNode;
+        int32_t toNode;
+        int32_t innovationNumber;
+        uint32_t enabled;
+    };
+
+    struct PackedResult {
+        int32_t genomeId;
+        uint32_t reserved;
+        double fitness;
+    };
+
+    uint64_t alignRecord(uint64_t _size)
+    {
+        return (_size + 7) & ~static_cast<uint64_t>(7);
+    }
+
+    std::string getPlatformName(const std::string& _name)
+    {
+#ifdef _WIN32
+        return "Local\\" + _name;
+#else
+        return "/" + _name;
+#endif
+    }
+}
+
+SharedMemoryTransport::SharedMemoryTransport()
+    : m_owner(false),
+      m_numWorkers(0),
+      m_workerIndex(-1),
+      m_regionSize(0),
+      m_region(nullptr),
+      m_header(nullptr),
+      m_nextResultRing(0),
+      m_mapping(0),
+      m_job(0)
+{
+}
+
+SharedMemoryTransport::~SharedMemoryTransport()
+{
+    close();
+}
+
+bool SharedMemoryTransport::create(int _numWorkers, size_t _ringBytes)
+{
+    close();
+    if (_numWorkers <= 0) return false;
+
+    size_t ringBytes = MIN_RING_BYTES;
+    while (ringBytes < _ringBytes) ringBytes *= 2;
+
+#ifdef _WIN32
+    unsigned long processId = GetCurrentProcessId();
+#else
+    unsigned long processId = static_cast<unsigned long>(getpid());
+#endif
+    static std::atomic<int> regionCount(0);
+    m_name = "neat_eval_" + std::to_string(processId) + "_" + std::to_string(regionCount.fetch_add(1));
+    m_owner = true;
+    m_numWorkers = _numWorkers;
+    m_regionSize = sizeof(RegionHeader) + _numWorkers * 2 * (sizeof(RingHeader) + ringBytes);
+    if (!mapRegion(true))
+    {
+        close();
+        return false;
+    }
+
+    // Fresh mappings are zero-filled, which is also the initial state of every counter
+    m_header = new (m_region) RegionHeader();
+    m_header->magic = REGION_MAGIC;
+    m_header->numWorkers = static_cast<uint32_t>(_numWorkers);
+    m_header->ringBytes = ringBytes;
+    m_header->shutdown.store(0);
+    m_header->resultDoorbell.sequence.store(0);
+    m_header->resultDoorbell.waiters.store(0);
+    for (int i = 0; i < _numWorkers; ++i)
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            RingHeader* ring = new (getRingPair(i) + side * (sizeof(RingHeader) + ringBytes)) RingHeader();
+            ring->head.store(0);
+            ring->tail.store(0);
+            ring->doorbell.sequence.store(0);
+            ring->doorbell.waiters.store(0);
+        }
+    }
+
+    setupRings();
+    return true;
+}
+
+bool SharedMemoryTransport::open(const std::string& _name, int _workerIndex)
+{
+    close();
+    m_name = _name;
+    m_owner = false;
+    if (!mapRegion(false))
+    {
+        close();
+        return false;
+    }
+
+    m_header = reinterpret_cast<RegionHeader*>(m_region);
+    m_numWorkers = static_cast<int>(m_header->numWorkers);
+    size_t expectedSize = sizeof(RegionHeader) + m_numWorkers * 2 * (sizeof(RingHeader) + m_header->ringBytes);
+    if (m_header->magic != REGION_MAGIC || _workerIndex < 0 || _workerIndex >= m_numWorkers || m_regionSize < expectedSize)
+    {
+        close();
+        return false;
+    }
+
+    m_workerIndex = _workerIndex;
+    setupRings();
+    return true;
+}
+
+void SharedMemoryTransport::close()
+{
+    if (m_owner && m_header)
+    {
+        // Wake every worker so it sees the flag, then give them a moment to exit on their own
+        m_header->shutdown.store(1);
+        for (int i = 0; i < m_numWorkers; ++i)
+        {
+            notify(i);
+        }
+#ifdef _WIN32
+        for (intptr_t worker : m_workers)
+        {
+            WaitForSingleObject(reinterpret_cast<HANDLE>(worker), 2000);
+            CloseHandle(reinterpret_cast<HANDLE>(worker));
+        }
+#else
+        for (intptr_t worker : m_workers)
+        {
+            waitpid(static_cast<pid_t>(worker), nullptr, 0);
+        }
+#endif
+    }
+    m_workers.clear();
+
+#ifdef _WIN32
+    // Closing the job kills any worker that did not exit
+    if (m_job) CloseHandle(reinterpret_cast<HANDLE>(m_job));
+    for (intptr_t event : m_events)
+    {
+        if (event) CloseHandle(reinterpret_cast<HANDLE>(event));
+    }
+    if (m_region) UnmapViewOfFile(m_region);
+    if (m_mapping) CloseHandle(reinterpret_cast<HANDLE>(m_mapping));
+#else
+    if (m_region) munmap(m_region, m_regionSize);
+    if (m_owner && !m_name.empty()) shm_unlink(getPlatformName(m_name).c_str());
+#endif
+
+    m_job = 0;
+    m_events.clear();
+    m_mapping = 0;
+    m_region = nullptr;
+    m_header = nullptr;
+    m_regionSize = 0;
+    m_requestRings.clear();
+    m_resultRings.clear();
+    m_nextResultRing = 0;
+    m_numWorkers = 0;
+    m_workerIndex = -1;
+    m_owner = false;
+    m_name.clear();
+}
+
+bool SharedMemoryTransport::mapRegion(bool _create)
+{
+    std::string platformName = getPlatformName(m_name);
+
+#ifdef _WIN32
+    HANDLE mapping;
+    if (_create)
+    {
+        unsigned long long size = m_regionSize;
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                     static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), platformName.c_str());
+        if (mapping && GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            CloseHandle(mapping);
+            return false;
+        }
+    }
+    else
+    {
+        mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, platformName.c_str());
+    }
+    if (!mapping) return false;
+    m_mapping = reinterpret_cast<intptr_t>(mapping);
+
+    m_region = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    if (!m_region) return false;
+    if (!_create)
+    {
+        MEMORY_BASIC_INFORMATION info;
+        if (VirtualQuery(m_region, &info, sizeof(info)) == 0) return false;
+        m_regionSize = info.RegionSize;
+    }
+
+    // One auto-reset event per doorbell. CreateEvent opens the server's events from a worker.
+    int numDoorbells = (_create ? m_numWorkers : static_cast<int>(reinterpret_cast<RegionHeader*>(m_region)->numWorkers)) + 1;
+    for (int i = 0; i < numDoorbells; ++i)
+    {
+        std::string eventName = platformName + "_doorbell_" + std::to_string(i);
+        HANDLE event = CreateEventA(nullptr, FALSE, FALSE, eventName.c_str());
+        if (!event) return false;
+        m_events.push_back(reinterpret_cast<intptr_t>(event));
+    }
+#else
+    int fd = _create ? shm_open(platformName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)
+                     : shm_open(platformName.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        // Nothing was created, make sure close() does not unlink somebody else's region
+        if (_create) m_name.clear();
+        return false;
+    }
+
+    bool sized = true;
+    if (_create)
+    {
+        sized = ftruncate(fd, static_cast<off_t>(m_regionSize)) == 0;
+    }
+    else
+    {
+        struct stat info;
+        sized = fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(RegionHeader));
+        if (sized) m_regionSize = static_cast<size_t>(info.st_size);
+    }
+
+    void* region = sized ? mmap(nullptr, m_regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (region == MAP_FAILED) return false;
+    m_region = static_cast<uint8_t*>(region);
+#endif
+
+    return true;
+}
+
+uint8_t* SharedMemoryTransport::getRingPair(int _workerIndex) const
+{
+    return m_region + sizeof(RegionHeader) + _workerIndex * 2 * (sizeof(RingHeader) + m_header->ringBytes);
+}
+
+void SharedMemoryTransport::setupRings()
+{
+    uint64_t ringBytes = m_header->ringBytes;
+    int first = m_owner ? 0 : m_workerIndex;
+    int last = m_owner ? m_numWorkers : m_workerIndex + 1;
+
+    // The server sees every ring pair, a worker only its own
+    for (int i = first; i < last; ++i)
+    {
+        uint8_t* pair = getRingPair(i);
+        Ring request;
+        request.header = reinterpret_cast<RingHeader*>(pair);
+        request.data = pair + sizeof(RingHeader);
+        request.mask = ringBytes - 1;
+        request.pendingHead = request.header->head.load(std::memory_order_relaxed);
+        m_requestRings.push_back(request);
+
+        Ring result;
+        result.header = reinterpret_cast<RingHeader*>(pair + sizeof(RingHeader) + ringBytes);
+        result.data = pair + 2 * sizeof(RingHeader) + ringBytes;
+        result.mask = ringBytes - 1;
+        result.pendingHead = result.header->head.load(std::memory_order_relaxed);
+        m_resultRings.push_back(result);
+    }
+}
+
+bool SharedMemoryTransport::launchWorkers(const std::vector<std::string>& _arguments)
+{
+    if (!m_owner || !m_workers.empty()) return false;
+
+#ifdef _WIN32
+    char executable[MAX_PATH];
+    DWORD length = GetModuleFileNameA(nullptr, executable, MAX_PATH);
+    if (length == 0 || length == MAX_PATH) return false;
+
+    // Workers are killed with the job when the server exits, however it exits
+    HANDLE job = CreateJobObjectA(nullptr, nullptr);
+    if (!job) return false;
+    m_job = reinterpret_cast<intptr_t>(job);
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+    limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+    SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+
+    for (int i = 0; i < m_numWorkers; ++i)
+    {
+        std::string commandLine = "\"" + std::string(executable) + "\" --evaluator " + m_name + " " + std::to_string(i);
+        for (const std::string& argument : _arguments)
+        {
+            commandLine += " \"" + argument + "\"";
+        }
+        std::vector<char> commandBuffer(commandLine.begin(), commandLine.end());
+        commandBuffer.push_back('\0');
+
+        STARTUPINFOA startupInfo = {};
+        startupInfo.cb = sizeof(startupInfo);
+        PROCESS_INFORMATION processInfo = {};
+        if (!CreateProcessA(nullptr, commandBuffer.data(), nullptr, nullptr, FALSE, CREATE_SUSPENDED,
+                            nullptr, nullptr, &startupInfo, &processInfo))
+        {
+            return false;
+        }
+        AssignProcessToJobObject(job, processInfo.hProcess);
+        ResumeThread(processInfo.hThread);
+        CloseHandle(processInfo.hThread);
+        m_workers.push_back(reinterpret_cast<intptr_t>(processInfo.hProcess));
+    }
+    return true;
+#elif defined(__linux__)
+    char executable[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+    if (length <= 0) return false;
+    executable[length] = '\0';
+
+    for (int i = 0; i < m_numWorkers; ++i)
+    {
+        // Built before fork(), the child only calls exec
+        std::string index = std::to_string(i);
+        std::vector<char*> argv = { executable, const_cast<char*>("--evaluator"), const_cast<char*>(m_name.c_str()),
+                                    const_cast<char*>(index.c_str()) };
+        for (const std::string& argument : _arguments)
+        {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        pid_t pid = fork();
+        if (pid < 0) return false;
+        if (pid == 0)
+        {
+            // Die with the server, however it exits
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            execv(executable, argv.data());
+            _exit(127);
+        }
+        m_workers.push_back(static_cast<intptr_t>(pid));
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool SharedMemoryTransport::sendGenome(int _genomeId, const Genome& _genome)
+{
+    if (!m_owner || m_requestRings.empty()) return false;
+
+    size_t workerIndex = 0;
+    uint64_t leastUsed = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < m_requestRings.size(); ++i)
+    {
+        uint64_t used = m_requestRings[i].getUsedBytes();
+        if (used < leastUsed)
+        {
+            leastUsed = used;
+            workerIndex = i;
+        }
+    }
+
+    // Packed directly into the ring, the only write of this genome
+    Ring& ring = m_requestRings[workerIndex];
+    size_t size = getPackedSize(_genome);
+    uint8_t* record = ring.beginWrite(size);
+    if (!record)
+    {
+        m_stats.ringFull++;
+        return false;
+    }
+    packGenome(record, _genomeId, _genome);
+    ring.commitWrite();
+    notify(static_cast<int>(workerIndex));
+
+    m_stats.genomesSent++;
+    m_stats.bytesSent += size;
+    return true;
+}
+
+bool SharedMemoryTransport::receiveResult(Result& _result)
+{
+    // Round robin so one busy worker cannot starve the others
+    for (size_t attempt = 0; attempt < m_resultRings.size(); ++attempt)
+    {
+        Ring& ring = m_resultRings[m_nextResultRing];
+        m_nextResultRing = (m_nextResultRing + 1) % m_resultRings.size();
+
+        size_t size = 0;
+        const uint8_t* record = ring.beginRead(size);
+        if (!record) continue;
+
+        bool valid = size == sizeof(PackedResult);
+        if (valid)
+        {
+            const PackedResult* packed = reinterpret_cast<const PackedResult*>(record);
+            _result.genomeId = packed->genomeId;
+            _result.fitness = packed->fitness;
+        }
+        ring.endRead(size);
+        if (valid) return true;
+    }
+    return false;
+}
+
+bool SharedMemoryTransport::waitForResults(int _timeoutMs)
+{
+    if (!m_owner) return false;
+
+    // Read the sequence before checking the rings so a result committed in between ends the wait
+    uint32_t sequence = getDoorbell(m_numWorkers).sequence.load(std::memory_order_seq_cst);
+    for (const Ring& ring : m_resultRings)
+    {
+        if (ring.getUsedBytes() > 0) return true;
+    }
+
+    wait(m_numWorkers, sequence, _timeoutMs);
+    for (const Ring& ring : m_resultRings)
+    {
+        if (ring.getUsedBytes() > 0) return true;
+    }
+    return false;
+}
+
+bool SharedMemoryTransport::receiveGenome(int& _genomeId, Genome& _genome)
+{
+    if (m_requestRings.empty()) return false;
+
+    Ring& ring = m_requestRings.front();
+    size_t size = 0;
+    const uint8_t* record = ring.beginRead(size);
+    if (!record) return false;
+
+    // Unpacked straight out of shared memory
+    bool valid = unpackGenome(record, size, _genomeId, _genome);
+    ring.endRead(size);
+    return valid;
+}
+
+bool SharedMemoryTransport::sendResult(int _genomeId, double _fitness)
+{
+    if (m_owner || m_resultRings.empty()) return false;
+
+    // The server drains results continuously, so a full ring only lasts a moment
+    Ring& ring = m_resultRings.front();
+    uint8_t* record = nullptr;
+    while (!(record = ring.beginWrite(sizeof(PackedResult))))
+    {
+        if (isShutdown()) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    PackedResult* packed = reinterpret_cast<PackedResult*>(record);
+    packed->genomeId = _genomeId;
+    packed->reserved = 0;
+    packed->fitness = _fitness;
+    ring.commitWrite();
+    notify(m_numWorkers);
+    return true;
+}
+
+bool SharedMemoryTransport::waitForGenomes(int _timeoutMs)
+{
+    if (m_owner || m_requestRings.empty()) return false;
+
+    uint32_t sequence = getDoorbell(m_workerIndex).sequence.load(std::memory_order_seq_cst);
+    if (m_requestRings.front().getUsedBytes() > 0) return true;
+    if (isShutdown()) return false;
+
+    wait(m_workerIndex, sequence, _timeoutMs);
+    return m_requestRings.front().getUsedBytes() > 0;
+}
+
+bool SharedMemoryTransport::isShutdown() const
+{
+    return !m_header || m_header->shutdown.load(std::memory_order_acquire) != 0;
+}
+
+size_t SharedMemoryTransport::getPackedSize(const Genome& _genome)
+{
+    return sizeof(PackedGenomeHeader) + _genome.m_nodes.size() * sizeof(PackedNode) +
+           _genome.m_connections.size() * sizeof(PackedConnection);
+}
+
+void SharedMemoryTransport::packGenome(uint8_t* _buffer, int _genomeId, const Genome& _genome)
+{
+    PackedGenomeHeader* header = reinterpret_cast<PackedGenomeHeader*>(_buffer);
+    header->genomeId = _genomeId;
+    header->numNodes = static_cast<uint32_t>(_genome.m_nodes.size());
+    header->numConnections = static_cast<uint32_t>(_genome.m_connections.size());
+    header->reserved = 0;
+
+    PackedNode* nodes = reinterpret_cast<PackedNode*>(header + 1);
+    for (const auto& node : _genome.m_nodes)
+    {
+        nodes->bias = node.bias;
+        nodes->nodeId = node.nodeId;
+        nodes->isInput = node.isInput ? 1 : 0;
+        nodes->isOutput = node.isOutput ? 1 : 0;
+        nodes->reserved[0] = 0;
+        nodes->reserved[1] = 0;
+        nodes++;
+    }
+
+    PackedConnection* connections = reinterpret_cast<PackedConnection*>(nodes);
+    for (const auto& connection : _genome.m_connections)
+    {
+        connections->weight = connection.weight;
+        connections->fromNode = connection.fromNode;
+        connections->toNode = connection.toNode;
+        connections->innovationNumber = connection.innovationNumber;
+        connections->enabled = connection.enabled ? 1 : 0;
+        connections++;
+    }
+}
+
+bool SharedMemoryTransport::unpackGenome(const uint8_t* _buffer, size_t _size, int& _genomeId, Genome& _genome)
+{
+    if (_size < sizeof(PackedGenomeHeader)) return false;
+    const PackedGenomeHeader* header = reinterpret_cast<const PackedGenomeHeader*>(_buffer);
+    size_t expectedSize = sizeof(PackedGenomeHeader) + static_cast<size_t>(header->numNodes) * sizeof(PackedNode) +
+                          static_cast<size_t>(header->numConnections) * sizeof(PackedConnection);
+    if (_size != expectedSize) return false;
+
+    _genomeId = header->genomeId;
+    _genome.m_nodes.clear();
+    _genome.m_connections.clear();
+    _genome.m_nodes.reserve(header->numNodes);
+    _genome.m_connections.reserve(header->numConnections);
+    _genome.setFitness(0.0);
+    _genome.m_evaluated = false;
+
+    const PackedNode* nodes = reinterpret_cast<const PackedNode*>(header + 1);
+    for (uint32_t i = 0; i < header->numNodes; ++i)
+    {
+        _genome.m_nodes.emplace_back(nodes[i].nodeId, nodes[i].bias, nodes[i].isInput != 0, nodes[i].isOutput != 0);
+    }
+
+    const PackedConnection* connections = reinterpret_cast<const PackedConnection*>(nodes + header->numNodes);
+    for (uint32_t i = 0; i < header->numConnections; ++i)
+    {
+        const PackedConnection& connection = connections[i];
+        _genome.m_connections.emplace_back(connection.fromNode, connection.toNode, connection.weight,
+                                           connection.enabled != 0, connection.innovationNumber);
+    }
+    return true;
+}
+
+SharedMemoryTransport::Doorbell& SharedMemoryTransport::getDoorbell(int _index)
+{
+    if (_index >= m_numWorkers) return m_header->resultDoorbell;
+    return reinterpret_cast<RingHeader*>(getRingPair(_index))->doorbell;
+}
+
+void SharedMemoryTransport::notify(int _doorbellIndex)
+{
+    Doorbell& doorbell = getDoorbell(_doorbellIndex);
+    doorbell.sequence.fetch_add(1, std::memory_order_seq_cst);
+
+    // Only pay for the system call when the other side is actually asleep
+    if (doorbell.waiters.load(std::memory_order_seq_cst) == 0) return;
+    m_stats.wakeups++;
+
+#ifdef _WIN32
+    SetEvent(reinterpret_cast<HANDLE>(m_events[_doorbellIndex]));
+#elif defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell.sequence), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+bool SharedMemoryTransport::wait(int _doorbellIndex, uint32_t _observedSequence, int _timeoutMs)
+{
+    Doorbell& doorbell = getDoorbell(_doorbellIndex);
+    doorbell.waiters.fetch_add(1, std::memory_order_seq_cst);
+
+    bool changed = doorbell.sequence.load(std::memory_order_seq_cst) != _observedSequence;
+    if (!changed)
+    {
+#ifdef _WIN32
+        // A stale signal from an earlier notify only costs a spurious wakeup
+        changed = WaitForSingleObject(reinterpret_cast<HANDLE>(m_events[_doorbellIndex]), static_cast<DWORD>(_timeoutMs)) == WAIT_OBJECT_0;
+#elif defined(__linux__)
+        // Shared (not FUTEX_PRIVATE) so it works across processes
+        struct timespec timeout;
+        timeout.tv_sec = _timeoutMs / 1000;
+        timeout.tv_nsec = (_timeoutMs % 1000) * 1000000L;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell.sequence), FUTEX_WAIT, _observedSequence, &timeout, nullptr, 0);
+        changed = doorbell.sequence.load(std::memory_order_seq_cst) != _observedSequence;
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(_timeoutMs, 1)));
+        changed = doorbell.sequence.load(std::memory_order_seq_cst) != _observedSequence;
+#endif
+    }
+
+    doorbell.waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return changed;
+}
+
+uint8_t* SharedMemoryTransport::Ring::beginWrite(size_t _size)
+{
+    uint64_t capacity = mask + 1;
+    uint64_t recordSize = alignRecord(sizeof(RecordHeader) + _size);
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    uint64_t tail = header->tail.load(std::memory_order_acquire);
+    uint64_t offset = head & mask;
+    uint64_t untilEnd = capacity - offset;
+
+    // A record that does not fit before the end skips to the start of the ring
+    uint64_t needed = recordSize + (recordSize > untilEnd ? untilEnd : 0);
+    if (needed > capacity - (head - tail)) return nullptr;
+
+    if (recordSize > untilEnd)
+    {
+        RecordHeader* padding = reinterpret_cast<RecordHeader*>(data + offset);
+        padding->size = static_cast<uint32_t>(untilEnd - sizeof(RecordHeader));
+        padding->flags = RECORD_PADDING;
+        head += untilEnd;
+        offset = 0;
+    }
+
+    RecordHeader* record = reinterpret_cast<RecordHeader*>(data + offset);
+    record->size = static_cast<uint32_t>(_size);
+    record->flags = 0;
+    pendingHead = head + recordSize;
+    return reinterpret_cast<uint8_t*>(record + 1);
+}
+
+const uint8_t* SharedMemoryTransport::Ring::beginRead(size_t& _size)
+{
+    for (;;)
+    {
+        uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        uint64_t head = header->head.load(std::memory_order_acquire);
+        if (tail == head) return nullptr;
+
+        const RecordHeader* record = reinterpret_cast<const RecordHeader*>(data + (tail & mask));
+        if (record->flags & RECORD_PADDING)
+        {
+            header->tail.store(tail + sizeof(RecordHeader) + record->size, std::memory_order_release);
+            continue;
+        }
+
+        _size = record->size;
+        return reinterpret_cast<const uint8_t*>(record + 1);
+    }
+}
+
+void SharedMemoryTransport::Ring::endRead(size_t _size)
+{
+    uint64_t tail = header->tail.load(std::memory_order_relaxed);
+    header->tail.store(tail + alignRecord(sizeof(RecordHeader) + _size), std::memory_order_release);
+}
+
+uint64_t SharedMemoryTransport::Ring::getUsedBytes() const
+{
+    return header->head.load(std::memory_order_acquire) - header->tail.load(std::memory_order_acquire);
+}
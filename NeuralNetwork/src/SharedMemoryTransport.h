@@ -0,0 +1,142 @@
+// File: SharedMemoryTransport.h
+// Description: Definition of the shared-memory transport to local evaluator processes. One shared
+//              region holds a request ring (server -> worker) and a result ring (worker -> server)
+//              per worker process. Genomes are packed straight into the ring in a flat binary form
+//              and read in place on the other side, so a genome is written once and copied once.
+//              Waiting sides sleep on a futex (Linux) or a named event (Windows) and are only woken
+//              when they announced they were waiting.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef SHARED_MEMORY_TRANSPORT_H
+#define SHARED_MEMORY_TRANSPORT_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class Genome;
+
+class SharedMemoryTransport {
+public:
+    struct Result {
+        int genomeId;
+        double fitness;
+    };
+
+    // Process-local counters of the side that owns this object
+    struct Stats {
+        uint64_t genomesSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t ringFull = 0;      // sendGenome() calls rejected because every request ring was full
+        uint64_t wakeups = 0;       // Futex/event signals actually issued
+    };
+
+    SharedMemoryTransport();
+    ~SharedMemoryTransport();
+
+    // Server: create a new region with one request and one result ring of _ringBytes per worker.
+    // _ringBytes is rounded up to a power of two.
+    bool create(int _numWorkers, size_t _ringBytes);
+    // Worker process: attach to ring pair _workerIndex of the region created under _name
+    bool open(const std::string& _name, int _workerIndex);
+    // Detach. The server also tells the workers to exit and removes the region.
+    void close();
+
+    // Server: start one "<this executable> --evaluator <name> <index> <_arguments...>" process per
+    // worker. The workers are tied to the server and die with it.
+    bool launchWorkers(const std::vector<std::string>& _arguments = std::vector<std::string>());
+
+    const std::string& getName() const { return m_name; }
+    int getNumWorkers() const { return m_numWorkers; }
+    const Stats& getStats() const { return m_stats; }
+
+    // Server side. sendGenome() picks the least loaded worker and returns false when no request
+    // ring has room, the caller keeps the genome and tries again later.
+    bool sendGenome(int _genomeId, const Genome& _genome);
+    bool receiveResult(Result& _result);
+    bool waitForResults(int _timeoutMs);
+
+    // Worker side
+    bool receiveGenome(int& _genomeId, Genome& _genome);
+    bool sendResult(int _genomeId, double _fitness);
+    bool waitForGenomes(int _timeoutMs);
+    bool isShutdown() const;
+
+    // Packed genome format, shared by both sides of the region (same executable)
+    static size_t getPackedSize(const Genome& _genome);
+    static void packGenome(uint8_t* _buffer, int _genomeId, const Genome& _genome);
+    static bool unpackGenome(const uint8_t* _buffer, size_t _size, int& _genomeId, Genome& _genome);
+
+private:
+    // A futex word: bumped on every notify, waiters sleep until it changes
+    struct Doorbell {
+        std::atomic<uint32_t> sequence;
+        std::atomic<uint32_t> waiters;
+        char padding[64 - 2 * sizeof(std::atomic<uint32_t>)];
+    };
+
+    // Single-producer single-consumer byte ring. head/tail count bytes since creation, each on
+    // its own cache line. Records are 8-byte aligned and never wrap: a record that does not fit
+    // before the end is preceded by a padding record.
+    struct RingHeader {
+        std::atomic<uint64_t> head;
+        char headPadding[64 - sizeof(std::atomic<uint64_t>)];
+        std::atomic<uint64_t> tail;
+        char tailPadding[64 - sizeof(std::atomic<uint64_t>)];
+        Doorbell doorbell;              // Request rings: rung by the server when it commits
+    };
+
+    struct RegionHeader {
+        uint32_t magic;
+        uint32_t numWorkers;
+        uint64_t ringBytes;
+        std::atomic<uint32_t> shutdown;
+        char padding[64 - 2 * sizeof(uint32_t) - sizeof(uint64_t) - sizeof(std::atomic<uint32_t>)];
+        Doorbell resultDoorbell;        // Shared by every result ring, the server waits on all of them at once
+    };
+
+    // Process-local view of one ring
+    struct Ring {
+        RingHeader* header = nullptr;
+        uint8_t* data = nullptr;
+        uint64_t mask = 0;
+        uint64_t pendingHead = 0;
+
+        uint8_t* beginWrite(size_t _size);
+        void commitWrite() { header->head.store(pendingHead, std::memory_order_release); }
+        const uint8_t* beginRead(size_t& _size);
+        void endRead(size_t _size);
+        uint64_t getUsedBytes() const;
+    };
+
+    std::string m_name;
+    bool m_owner;
+    int m_numWorkers;
+    int m_workerIndex;
+    size_t m_regionSize;
+    uint8_t* m_region;
+    RegionHeader* m_header;
+    std::vector<Ring> m_requestRings;
+    std::vector<Ring> m_resultRings;
+    size_t m_nextResultRing;
+    Stats m_stats;
+
+    // Platform handles: mapping, doorbell events and job object (Windows), worker processes
+    intptr_t m_mapping;
+    intptr_t m_job;
+    std::vector<intptr_t> m_events;
+    std::vector<intptr_t> m_workers;
+
+    bool mapRegion(bool _create);
+    void setupRings();
+    uint8_t* getRingPair(int _workerIndex) const;
+    // Doorbell _index < m_numWorkers is the request ring of that worker, m_numWorkers the result doorbell
+    Doorbell& getDoorbell(int _index);
+    void notify(int _doorbellIndex);
+    bool wait(int _doorbellIndex, uint32_t _observedSequence, int _timeoutMs);
+};
+
+#endif // SHARED_MEMORY_TRANSPORT_H
@@ -0,0 +1,99 @@
+// File: ThreadPool.cpp
+// Description: Implementation of the fixed-size worker pool
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int _numThreads)
+    : m_task(nullptr),
+      m_count(0),
+      m_batchId(0),
+      m_pendingWorkers(0),
+      m_stopping(false)
+{
+    int numWorkers = std::max(1, _numThreads) - 1;
+    m_workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_startCondition.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t _count, const std::function<void(size_t _begin, size_t _end)>& _task)
+{
+    if (_count == 0) return;
+
+    // Not worth waking anybody up for a tiny batch
+    if (m_workers.empty() || _count < static_cast<size_t>(getNumThreads()))
+    {
+        _task(0, _count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &_task;
+        m_count = _count;
+        m_pendingWorkers = static_cast<int>(m_workers.size());
+        m_batchId++;
+    }
+    m_startCondition.notify_all();
+
+    // The calling thread takes the first range
+    runRange(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this]() { return m_pendingWorkers == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::workerLoop(int _workerIndex)
+{
+    unsigned long long lastBatch = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, lastBatch]() { return m_stopping || m_batchId != lastBatch; });
+            if (m_stopping) return;
+            lastBatch = m_batchId;
+        }
+
+        runRange(_workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pendingWorkers--;
+        }
+        m_doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::runRange(int _rangeIndex)
+{
+    size_t numRanges = static_cast<size_t>(getNumThreads());
+    size_t begin = m_count * _rangeIndex / numRanges;
+    size_t end = m_count * (_rangeIndex + 1) / numRanges;
+
+    if (begin < end)
+    {
+        (*m_task)(begin, end);
+    }
+}
@@ -0,0 +1,42 @@
+// File: ThreadPool.h
+// Description: Definition of a small fixed-size worker pool used to run simulation work in parallel
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+class ThreadPool {
+public:
+    // _numThreads counts the calling thread, so a pool of 1 runs everything inline
+    ThreadPool(int _numThreads);
+    ~ThreadPool();
+
+    // Split [0, _count) into one contiguous range per thread and block until all ranges are done
+    void parallelFor(size_t _count, const std::function<void(size_t _begin, size_t _end)>& _task);
+
+    int getNumThreads() const { return static_cast<int>(m_workers.size()) + 1; }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+
+    const std::function<void(size_t, size_t)>* m_task;
+    size_t m_count;
+    unsigned long long m_batchId;
+    int m_pendingWorkers;
+    bool m_stopping;
+
+    void workerLoop(int _workerIndex);
+    void runRange(int _rangeIndex);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,283 @@
+// File: WebSocketFrameParser.cpp
+// Description: Implementation of the incremental WebSocket frame parser
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#include <algorithm>
+#include <cstring>
+#include "WebSocketFrameParser.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define WEBSOCKET_MASK_AVX2
+#define WEBSOCKET_MASK_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WEBSOCKET_MASK_SSE2
+#endif
+
+namespace {
+    const size_t INITIAL_BUFFER_SIZE = 64 * 1024;
+    const size_t MAX_CONTROL_PAYLOAD = 125;
+}
+
+WebSocketFrameParser::WebSocketFrameParser(size_t _maxMessageSize, bool _requireMasked)
+    : m_buffer(INITIAL_BUFFER_SIZE),
+      m_readPos(0),
+      m_writePos(0),
+      m_pendingFrameSize(0),
+      m_fragmentOpcode(0),
+      m_inFragmentedMessage(false),
+      m_maxMessageSize(_maxMessageSize),
+      m_requireMasked(_requireMasked),
+      m_error(RESULT_NEED_MORE)
+{
+}
+
+WebSocketFrameParser::~WebSocketFrameParser()
+{
+}
+
+uint8_t* WebSocketFrameParser::prepareWrite(size_t _minBytes, size_t& _available)
+{
+    // Make room for the rest of a partially received frame in one go
+    size_t wanted = _minBytes;
+    size_t buffered = getBufferedBytes();
+    if (m_pendingFrameSize > buffered)
+    {
+        wanted = std::max(wanted, m_pendingFrameSize - buffered);
+    }
+
+    reserveTail(wanted);
+    _available = m_buffer.size() - m_writePos;
+    return m_buffer.data() + m_writePos;
+}
+
+void WebSocketFrameParser::commitWrite(size_t _bytes)
+{
+    m_writePos = std::min(m_writePos + _bytes, m_buffer.size());
+}
+
+void WebSocketFrameParser::append(const uint8_t* _data, size_t _size)
+{
+    reserveTail(_size);
+    std::memcpy(m_buffer.data() + m_writePos, _data, _size);
+    m_writePos += _size;
+}
+
+void WebSocketFrameParser::reserveTail(size_t _bytes)
+{
+    if (m_readPos == m_writePos)
+    {
+        m_readPos = 0;
+        m_writePos = 0;
+    }
+    if (m_buffer.size() - m_writePos >= _bytes) return;
+
+    // Move the unread bytes (at most one partial frame) to the front
+    if (m_readPos > 0)
+    {
+        size_t unread = m_writePos - m_readPos;
+        std::memmove(m_buffer.data(), m_buffer.data() + m_readPos, unread);
+        m_readPos = 0;
+        m_writePos = unread;
+    }
+    if (m_buffer.size() - m_writePos < _bytes)
+    {
+        m_buffer.resize(std::max(m_writePos + _bytes, m_buffer.size() * 2));
+    }
+}
+
+WebSocketFrameParser::Result WebSocketFrameParser::next(Frame& _frame)
+{
+    if (m_error != RESULT_NEED_MORE) return m_error;
+
+    for (;;)
+    {
+        size_t available = m_writePos - m_readPos;
+        if (available < 2) return RESULT_NEED_MORE;
+
+        // Header: everything needed to size the frame comes from here, never from the payload
+        const uint8_t* header = m_buffer.data() + m_readPos;
+        bool fin = (header[0] & 0x80) != 0;
+        int reserved = header[0] & 0x70;
+        int opcode = header[0] & 0x0F;
+        bool masked = (header[1] & 0x80) != 0;
+        uint64_t payloadLength = header[1] & 0x7F;
+        size_t headerSize = 2;
+
+        if (payloadLength == 126)
+        {
+            if (available < 4) return RESULT_NEED_MORE;
+            payloadLength = (static_cast<uint64_t>(header[2]) << 8) | header[3];
+            headerSize = 4;
+        }
+        else if (payloadLength == 127)
+        {
+            if (available < 10) return RESULT_NEED_MORE;
+            payloadLength = 0;
+            for (int i = 0; i < 8; ++i)
+            {
+                payloadLength = (payloadLength << 8) | header[2 + i];
+            }
+            headerSize = 10;
+        }
+        if (masked) headerSize += 4;
+
+        bool control = (opcode & 0x8) != 0;
+        if (reserved != 0 || (m_requireMasked && !masked))
+        {
+            return m_error = RESULT_PROTOCOL_ERROR;
+        }
+        if (control)
+        {
+            if (!fin || payloadLength > MAX_CONTROL_PAYLOAD ||
+                (opcode != OPCODE_CLOSE && opcode != OPCODE_PING && opcode != OPCODE_PONG))
+            {
+                return m_error = RESULT_PROTOCOL_ERROR;
+            }
+        }
+        else if (opcode != OPCODE_CONTINUATION && opcode != OPCODE_TEXT && opcode != OPCODE_BINARY)
+        {
+            return m_error = RESULT_PROTOCOL_ERROR;
+        }
+        if (payloadLength > m_maxMessageSize)
+        {
+            return m_error = RESULT_TOO_LARGE;
+        }
+
+        size_t frameSize = headerSize + static_cast<size_t>(payloadLength);
+        if (available < frameSize)
+        {
+            m_pendingFrameSize = frameSize;
+            return RESULT_NEED_MORE;
+        }
+        m_pendingFrameSize = 0;
+
+        // Unmask in place, the payload is handed out straight from the receive buffer
+        uint8_t* payload = m_buffer.data() + m_readPos + headerSize;
+        size_t size = static_cast<size_t>(payloadLength);
+        if (masked)
+        {
+            applyMask(payload, size, payload - 4);
+        }
+        m_readPos += frameSize;
+
+        // Control frames may arrive between the fragments of a message
+        if (control)
+        {
+            _frame.opcode = opcode;
+            _frame.data = payload;
+            _frame.size = size;
+            return RESULT_CONTROL;
+        }
+
+        if (opcode == OPCODE_CONTINUATION)
+        {
+            if (!m_inFragmentedMessage) return m_error = RESULT_PROTOCOL_ERROR;
+            if (m_fragments.size() + size > m_maxMessageSize) return m_error = RESULT_TOO_LARGE;
+
+            m_fragments.insert(m_fragments.end(), payload, payload + size);
+            if (!fin) continue;
+
+            m_inFragmentedMessage = false;
+            _frame.opcode = m_fragmentOpcode;
+            _frame.data = m_fragments.data();
+            _frame.size = m_fragments.size();
+            return RESULT_MESSAGE;
+        }
+
+        // A new data frame while a fragmented message is still open
+        if (m_inFragmentedMessage) return m_error = RESULT_PROTOCOL_ERROR;
+
+        if (fin)
+        {
+            _frame.opcode = opcode;
+            _frame.data = payload;
+            _frame.size = size;
+            return RESULT_MESSAGE;
+        }
+
+        m_inFragmentedMessage = true;
+        m_fragmentOpcode = opcode;
+        m_fragments.assign(payload, payload + size);
+    }
+}
+
+int WebSocketFrameParser::encodeHeader(uint8_t* _header, uint64_t _length, int _opcode, const uint8_t* _maskKey)
+{
+    // FIN + opcode
+    _header[0] = static_cast<uint8_t>(0x80 | _opcode);
+
+    // Payload length
+    int size;
+    if (_length < 126)
+    {
+        _header[1] = static_cast<uint8_t>(_length);
+        size = 2;
+    }
+    else if (_length < 65536)
+    {
+        _header[1] = 126;
+        _header[2] = (_length >> 8) & 0xFF;
+        _header[3] = _length & 0xFF;
+        size = 4;
+    }
+    else
+    {
+        _header[1] = 127;
+        for (int i = 0; i < 8; i++)
+        {
+            _header[2 + i] = (_length >> ((7 - i) * 8)) & 0xFF;
+        }
+        size = 10;
+    }
+
+    if (_maskKey)
+    {
+        _header[1] |= 0x80;
+        std::memcpy(_header + size, _maskKey, 4);
+        size += 4;
+    }
+    return size;
+}
+
+void WebSocketFrameParser::applyMask(uint8_t* _data, size_t _size, const uint8_t _key[4])
+{
+    // Every step below covers a multiple of 4 bytes, so the key stays aligned with the data
+    uint32_t key32;
+    std::memcpy(&key32, _key, 4);
+    size_t i = 0;
+
+#ifdef WEBSOCKET_MASK_AVX2
+    const __m256i key256 = _mm256_set1_epi32(static_cast<int>(key32));
+    for (; i + 32 <= _size; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_data + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(_data + i), _mm256_xor_si256(block, key256));
+    }
+#endif
+
+#ifdef WEBSOCKET_MASK_SSE2
+    const __m128i key128 = _mm_set1_epi32(static_cast<int>(key32));
+    for (; i + 16 <= _size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(_data + i), _mm_xor_si128(block, key128));
+    }
+#endif
+
+    const uint64_t key64 = (static_cast<uint64_t>(key32) << 32) | key32;
+    for (; i + 8 <= _size; i += 8)
+    {
+        uint64_t block;
+        std::memcpy(&block, _data + i, 8);
+        block ^= key64;
+        std::memcpy(_data + i, &block, 8);
+    }
+
+    for (; i < _size; ++i)
+    {
+        _data[i] ^= _key[i & 3];
+    }
+}
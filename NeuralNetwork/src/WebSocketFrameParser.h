@@ -0,0 +1,92 @@
+// File: WebSocketFrameParser.h
+// Description: Definition of the incremental WebSocket frame parser. Bytes are received straight into
+//              the parser's buffer, complete frames are unmasked in place (16-32 bytes per step with
+//              SIMD) and handed out as views, and fragmented messages are reassembled up to a size limit.
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#ifndef WEBSOCKET_FRAME_PARSER_H
+#define WEBSOCKET_FRAME_PARSER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class WebSocketFrameParser {
+public:
+    enum Result {
+        RESULT_NEED_MORE,       // No complete frame buffered yet
+        RESULT_MESSAGE,         // A whole (possibly reassembled) text or binary message
+        RESULT_CONTROL,         // A close, ping or pong frame
+        RESULT_PROTOCOL_ERROR,  // Malformed frame, close with 1002
+        RESULT_TOO_LARGE        // Frame or message over the limit, close with 1009
+    };
+
+    enum Opcode {
+        OPCODE_CONTINUATION = 0x0,
+        OPCODE_TEXT = 0x1,
+        OPCODE_BINARY = 0x2,
+        OPCODE_CLOSE = 0x8,
+        OPCODE_PING = 0x9,
+        OPCODE_PONG = 0xA
+    };
+
+    // Points into the parser's buffers: valid until the next call to prepareWrite() or next()
+    struct Frame {
+        int opcode = 0;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    // A server parses client frames with _requireMasked: RFC 6455 requires clients to mask every
+    // frame, and an unmasked one is a protocol error. A client parses the server's unmasked frames.
+    WebSocketFrameParser(size_t _maxMessageSize, bool _requireMasked = false);
+    ~WebSocketFrameParser();
+
+    // Space to recv() into, at least _minBytes long. Call commitWrite() with what was received.
+    uint8_t* prepareWrite(size_t _minBytes, size_t& _available);
+    void commitWrite(size_t _bytes);
+
+    // Bytes that arrived some other way (e.g. read together with the handshake)
+    void append(const uint8_t* _data, size_t _size);
+
+    // Parse the next frame out of the buffered bytes. After an error the parser stays in the error state.
+    Result next(Frame& _frame);
+
+    size_t getBufferedBytes() const { return m_writePos - m_readPos; }
+
+    // XOR _size bytes with the 4-byte masking key, starting at key offset 0
+    static void applyMask(uint8_t* _data, size_t _size, const uint8_t _key[4]);
+
+    // Largest frame header: 2 bytes, 8 bytes of extended length and a 4-byte masking key
+    static const int MAX_HEADER_SIZE = 14;
+
+    // Write the header of a single-fragment frame carrying _length payload bytes into _header and
+    // return its size. Servers send unmasked frames; a client passes its masking key, and masks the
+    // payload with applyMask.
+    static int encodeHeader(uint8_t* _header, uint64_t _length, int _opcode, const uint8_t* _maskKey = nullptr);
+
+private:
+    // Receive buffer with read/write cursors. Consumed bytes are reclaimed by resetting the cursors
+    // when the buffer drains, or by moving the unread tail down once when more room is needed,
+    // so each byte is moved at most once instead of erasing the prefix per frame.
+    std::vector<uint8_t> m_buffer;
+    size_t m_readPos;
+    size_t m_writePos;
+
+    // Size of the frame waiting for more bytes, so the buffer can grow to hold it in one piece
+    size_t m_pendingFrameSize;
+
+    // Fragmented message being reassembled
+    std::vector<uint8_t> m_fragments;
+    int m_fragmentOpcode;
+    bool m_inFragmentedMessage;
+
+    size_t m_maxMessageSize;
+    bool m_requireMasked;
+    Result m_error;
+
+    void reserveTail(size_t _bytes);
+};
+
+#endif // WEBSOCKET_FRAME_PARSER_H
@@ -11,14 +11,29 @@
 #include <queue>
 #include <mutex>
 #include <thread>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
 #include <nlohmann/json.hpp>
-#include "websocket.h"
 #include "NEAT.h"
+#include "DinoSimulator.h"
+#include "MPSCQueue.h"
+#include "Logger.h"
+#include "GenomeDeltaEncoder.h"
+#include "SharedMemoryTransport.h"
+#include "IslandModel.h"
+#include "ObstacleSchedule.h"
+#include "HyperparameterSweep.h"
+#include "NetworkLayout.h"
+#include "EvolutionStatistics.h"
+#include "Profiler.h"
+#include "websocket.h" // Pulls in <windows.h> and its min/max macros, keep it after the other headers
 
 using std::cout;
 using std::cerr;
@@ -29,248 +44,984 @@ using json = nlohmann::json;
 
 // WebSocket server
 std::unique_ptr<SimpleWebSocketServer> server;
-std::mutex clientMutex;
-bool clientConnected = false;
+std::atomic<bool> clientConnected(false);
 
-// NEAT state
+// Work handed from the socket thread to the evolution thread
+struct EvolutionEvent {
+    enum Type { READY, FITNESS, CACHE_MISS };
+    Type type;
+    int genomeId;
+    double fitness;
+    int genomeCacheSize; // READY: genomes the client can cache for delta encoding
+    int workers = 1;     // READY: genomes the client evaluates at the same time
+    int inferences = 0;  // FITNESS from the web client: network queries and frames of its game
+    int frames = 0;
+    double simulationMs = 0.0; // FITNESS from the web client: time spent simulating, and animation frames
+    int animationFrames = 0;
+    int epoch = 0;       // CACHE_MISS: cache epoch of the genome the client could not decode
+};
+
+// The socket thread only parses messages and pushes events. All NEAT state below is owned by
+// the evolution thread, and everything it sends goes through outboundMessages to the sender
+// thread, so neither side ever waits on the other's work.
+MPSCQueue<EvolutionEvent> evolutionEvents(1024);
+MPSCQueue<string> outboundMessages(1024);
+
+// NEAT state (evolution thread only)
 NEAT* neat = nullptr;
 std::queue<int> genomeQueue;
 std::map<int, double> fitnessResults;
-std::mutex neatMutex;
 bool trainingActive = false;
 int currentGeneration = 1;
 int genomesTested = 0;
 int totalGenomes = 0;
+int genomesInFlight = 0; // Sent and waiting for a fitness result
+int clientWorkers = 1;   // Web Workers of the client, kept busy with one genome each
+double championFitness = -1.0; // Best fitness sent to the client in a champion message
+
+// Every fitness result is folded into the statistics, and a snapshot goes to the client and the
+// log at most every --stats-interval ms (--stats-log <path>)
+EvolutionStatistics::Config statisticsConfig;
+std::unique_ptr<EvolutionStatistics> statistics;
+EvolutionStatistics::RunningStats generationFitness; // Steady state: results since the last report
+
+// Built-in profiler, see Profiler.h. Its totals are served as plain text at /metrics on the server
+// port. GET /trace/start (or --trace <path> for the first one) records the next generation as a
+// Chrome trace, served at /trace and written to the path. --no-profile turns the probes off.
+string tracePath;
+std::atomic<bool> traceRequested(false);
+
+// Steady-state (rtNEAT) mode: no generation barrier, see handleSteadyStateFitness
+bool steadyStateMode = false;
+unsigned long long nextReportAt = 0; // Evaluation count of the next steady-state "generation" report
+std::chrono::steady_clock::time_point trainingStartTime;
+
+// When dinos query their network (--decision-interval, --skip-airborne, --input-epsilon), sent to the
+// web client and used by headless runs. Inference counts reported by the client are summed here.
+DinoSimulator::DecisionPolicy decisionPolicy;
+unsigned long long clientGames = 0;
+unsigned long long clientInferences = 0;
+unsigned long long clientFrames = 0;
+
+// Courses each genome plays in headless runs (--episodes), see NEAT::evaluateEpisodes
+int evaluationEpisodes = 1;
+
+// Evaluation speed of the web client (--ticks-per-frame, --render-interval, --render-champion): game
+// ticks per animation frame and which frames are drawn. With --ticks-per-frame 0 the ticks follow the
+// simulation time the client reports, so a fast machine is not held to the display refresh rate.
+struct ClientMode {
+    int ticksPerFrame = 1;
+    int renderInterval = 1;     // Draw every Kth animation frame, 0 = none
+    bool renderChampion = false; // Draw only games beating the client's best score
+    bool adaptive = false;
+};
+ClientMode clientMode;
+const int initialAdaptiveTicks = 16;
+const int maxTicksPerFrame = 4096;
+const double targetSimulationMs = 8.0; // Of a 16.7 ms frame at 60 Hz
+
+// Mirror of the client's genome cache, genomes are sent as deltas against it
+GenomeDeltaEncoder genomeDeltaEncoder;
+unsigned long long genomeBytesSent = 0;
+
+// Local evaluator processes (--local-evaluators): genomes go through shared memory instead of
+// the WebSocket, and their results come back as the same FITNESS events
+std::unique_ptr<SharedMemoryTransport> localEvaluators;
+
+// Every evaluation runs on this course: the web client replays its obstacle schedule and the
+// local evaluators simulate the same seed, so fitness results are comparable and cacheable
+const unsigned int courseSeed = 1;
 
 // Convert NEAT genome to JSON for web client
 json genomeToJSON(Genome* genome) {
-    json genomeData;
-    genomeData["id"] = static_cast<int>(reinterpret_cast<uintptr_t>(genome));
-    genomeData["numInputs"] = neat->getConfig().numInputs;
-    genomeData["numOutputs"] = neat->getConfig().numOutputs;
+    PROFILE_SCOPE("genomeToJSON");
+    return GenomeDeltaEncoder::genomeToJSON(*genome, static_cast<int>(reinterpret_cast<uintptr_t>(genome)),
+                                            neat->getConfig().numInputs, neat->getConfig().numOutputs);
+}
+
+// Obstacle schedule for the web client. Spawns are flat [frame, type, frame, type, ...] pairs,
+// the client derives sizes from the type the same way ObstacleSchedule::makeSpawn does.
+json obstacleScheduleToJSON(const ObstacleSchedule& schedule) {
+    json spawns = json::array();
+    for (const auto& spawn : schedule.getSpawns()) {
+        spawns.push_back(spawn.frame);
+        spawns.push_back(spawn.type);
+    }
+    return {
+        {"type", "obstacle_schedule"},
+        {"seed", schedule.getSeed()},
+        {"numFrames", schedule.getNumFrames()},
+        {"spawns", std::move(spawns)}
+    };
+}
 
-    // Nodes
+// Layout of a displayed genome: flat [nodeId, layer, order, ...] triples in node gene order
+json networkLayoutToJSON(const NetworkLayout& layout) {
     json nodes = json::array();
-    for (const auto& node : genome->m_nodes) {
-        std::string type;
-        if (node.isInput) type = "input";
-        else if (node.isOutput) type = "output";
-        else type = "hidden";
-        // For visualization, try to infer layer: input=0, output=last, hidden=1 (or more if needed)
-        int layer = node.isInput ? 0 : (node.isOutput ? 2 : 1);
-        nodes.push_back({
-            {"id", node.nodeId},
-            {"layer", layer},
-            {"type", type},
-            {"bias", node.bias}
-        });
-    }
-    genomeData["nodes"] = nodes;
-
-    // Connections
-    json connections = json::array();
-    for (const auto& conn : genome->m_connections) {
-        connections.push_back({
-            {"fromNode", conn.fromNode},
-            {"toNode", conn.toNode},
-            {"weight", conn.weight},
-            {"enabled", conn.enabled},
-            {"innovationNumber", conn.innovationNumber}
-        });
-    }
-    genomeData["connections"] = connections;
-    return genomeData;
-}
-
-// Send a genome to the web client for testing
+    for (const auto& position : layout.getPositions()) {
+        nodes.push_back(position.nodeId);
+        nodes.push_back(position.layer);
+        nodes.push_back(position.order);
+    }
+    return {
+        {"layers", layout.getNumLayers()},
+        {"nodes", std::move(nodes)}
+    };
+}
+
+// The client only draws the champion, so only the champion carries a layout. Layouts are
+// computed once per topology, see NetworkLayout::get.
+void sendChampion(Genome* genome) {
+    if (!genome || genome->getFitness() <= championFitness) return;
+    championFitness = genome->getFitness();
+    
+    json message;
+    message["type"] = "champion";
+    message["fitness"] = championFitness;
+    message["genome"] = genomeToJSON(genome);
+    message["layout"] = networkLayoutToJSON(*NetworkLayout::get(*genome));
+    outboundMessages.push(message.dump());
+}
+
+// Statistics snapshot. Species are flat [id, size, staleness, meanFitness, maxFitness, ...] tuples,
+// complexity bins count genomes with 0, 1, 2-3, 4-7, ... hidden nodes or enabled connections.
+json statisticsToJSON(const EvolutionStatistics::Snapshot& snapshot) {
+    json species = json::array();
+    for (const auto& entry : snapshot.species) {
+        species.push_back(entry.id);
+        species.push_back(entry.size);
+        species.push_back(entry.staleness);
+        species.push_back(entry.meanFitness);
+        species.push_back(entry.maxFitness);
+    }
+    const int numBins = EvolutionStatistics::NUM_COMPLEXITY_BINS;
+    return {
+        {"type", "statistics"},
+        {"seconds", snapshot.seconds},
+        {"evaluations", snapshot.evaluations},
+        {"evaluationsPerSecond", snapshot.evaluationsPerSecond},
+        {"bestFitness", snapshot.bestFitness},
+        {"fitness", {
+            {"results", snapshot.fitness.count},
+            {"mean", snapshot.fitness.mean},
+            {"stdDev", snapshot.fitness.getStdDev()},
+            {"min", snapshot.fitness.min},
+            {"max", snapshot.fitness.max},
+            {"median", snapshot.medianFitness},
+            {"p90", snapshot.p90Fitness}
+        }},
+        {"hiddenNodes", {
+            {"mean", snapshot.hiddenNodes.mean},
+            {"bins", std::vector<uint32_t>(snapshot.hiddenNodeBins, snapshot.hiddenNodeBins + numBins)}
+        }},
+        {"connections", {
+            {"mean", snapshot.connections.mean},
+            {"bins", std::vector<uint32_t>(snapshot.connectionBins, snapshot.connectionBins + numBins)}
+        }},
+        {"species", std::move(species)}
+    };
+}
+
+// Fold one evaluation into the statistics, and send a snapshot when one is due
+void recordResult(const Genome& genome, double fitness) {
+    statistics->addResult(genome, fitness);
+    if (statistics->isSnapshotDue()) {
+        outboundMessages.push(statisticsToJSON(statistics->takeSnapshot(*neat)).dump());
+    }
+}
+
+json decisionPolicyToJSON(const DinoSimulator::DecisionPolicy& policy) {
+    return {
+        {"type", "decision_policy"},
+        {"interval", policy.interval},
+        {"skipAirborne", policy.skipAirborne},
+        {"inputEpsilon", policy.inputEpsilon}
+    };
+}
+
+json clientModeToJSON(const ClientMode& mode) {
+    return {
+        {"type", "mode"},
+        {"ticksPerFrame", mode.ticksPerFrame},
+        {"renderInterval", mode.renderInterval},
+        {"renderChampion", mode.renderChampion}
+    };
+}
+
+// Find a genome of the current population from the id sent to the web client
+Genome* findGenome(int genomeId) {
+    for (auto* g : neat->getPopulation()) {
+        if (static_cast<int>(reinterpret_cast<uintptr_t>(g)) == genomeId) {
+            return g;
+        }
+    }
+    return nullptr;
+}
+
+// Send one genome, as a delta against a genome the client has cached when that is smaller
+void sendGenome(int genomeId, Genome* genome) {
+    json message;
+    json delta;
+    int parentId = static_cast<int>(reinterpret_cast<uintptr_t>(genome->m_parent));
+    if (genomeDeltaEncoder.encode(genomeId, *genome, delta, parentId)) {
+        message["type"] = "genome_delta";
+        message["genome"] = std::move(delta);
+    } else {
+        message["type"] = "genome";
+        message["genome"] = genomeToJSON(genome);
+    }
+    message["epoch"] = genomeDeltaEncoder.getEpoch();
+    
+    string text = message.dump();
+    genomeBytesSent += text.size();
+    PROFILE_COUNT("genomes_sent", 1);
+    outboundMessages.push(std::move(text));
+    LOG_EVERY_N(Logger::LEVEL_DEBUG, 10, "Sent genome {} for testing", genomeId);
+}
+
+// Hand every queued genome to the local evaluators, as far as their rings have room. What is
+// left stays queued and goes out as results free up space.
+void dispatchLocalGenomes() {
+    while (!genomeQueue.empty()) {
+        int genomeId = genomeQueue.front();
+        Genome* genome = findGenome(genomeId);
+        if (genome) {
+            if (!localEvaluators->sendGenome(genomeId, *genome)) break;
+            genomesInFlight++;
+        }
+        genomeQueue.pop();
+    }
+}
+
+// Send genomes to the web client for testing, until each of its workers has one
 void sendNextGenome() {
-    int genomeId = -1;
-    Genome* genome = nullptr;
+    if (localEvaluators) {
+        dispatchLocalGenomes();
+        return;
+    }
     
-    // Get genome data without holding both locks simultaneously
-    {
-        std::lock_guard<std::mutex> lock(neatMutex);
-        if (genomeQueue.empty()) return;
-        
-        genomeId = genomeQueue.front();
+    while (!genomeQueue.empty() && genomesInFlight < clientWorkers) {
+        int genomeId = genomeQueue.front();
         genomeQueue.pop();
         
         // Find the genome in the population
-        auto& population = neat->getPopulation();
-        for (auto* g : population) {
-            if (static_cast<int>(reinterpret_cast<uintptr_t>(g)) == genomeId) {
-                genome = g;
-                break;
-            }
+        Genome* genome = findGenome(genomeId);
+        if (!clientConnected) return;
+        if (!genome) continue;
+        
+        sendGenome(genomeId, genome);
+        genomesInFlight++;
+    }
+}
+
+// Queue the current population for testing. Genomes whose fitness is already in the
+// fitness cache are resolved on the spot instead of being sent to the web client.
+void queuePopulation() {
+    auto& population = neat->getPopulation();
+    genomeQueue = std::queue<int>();
+    fitnessResults.clear();
+    genomesTested = 0;
+    totalGenomes = static_cast<int>(population.size());
+    neat->resetFitnessCacheStats();
+    
+    for (auto* genome : population) {
+        int genomeId = static_cast<int>(reinterpret_cast<uintptr_t>(genome));
+        double fitness = 0.0;
+        if (neat->lookupFitness(*genome, fitness)) {
+            fitnessResults[genomeId] = fitness;
+            genomesTested++;
+        } else {
+            genomeQueue.push(genomeId);
         }
     }
+}
+
+void evolveGeneration();
+
+// A generation is traced from its first genome to the end of its evolution step (steady state: to
+// the next report), so a trace covers evaluation and NEAT's work alike
+void beginGenerationTrace() {
+    if (traceRequested.exchange(false)) {
+        Profiler::instance().startTrace();
+        LOG_INFO("Tracing generation {}", currentGeneration);
+    }
+}
+
+void endGenerationTrace() {
+    Profiler& profiler = Profiler::instance();
+    if (!profiler.isTracing()) return;
+    profiler.stopTrace();
     
-    // Check client connection separately
-    {
-        std::lock_guard<std::mutex> clientLock(clientMutex);
-        if (!clientConnected || !genome) return;
-        
-        json message;
-        message["type"] = "genome";
-        message["genome"] = genomeToJSON(genome);
+    if (tracePath.empty()) {
+        LOG_INFO("Trace of generation {} recorded, see /trace", currentGeneration);
+        return;
+    }
+    std::FILE* file = std::fopen(tracePath.c_str(), "w");
+    if (!file) {
+        LOG_ERROR("Cannot write the trace to {}", tracePath);
+        return;
+    }
+    string trace = profiler.getTraceJSON();
+    std::fwrite(trace.data(), 1, trace.size(), file);
+    std::fclose(file);
+    LOG_INFO("Trace of generation {} written to {}", currentGeneration, tracePath);
+}
+
+// Steady-state mode: keep the evaluators busy by replacing the worst genome until enough
+// offspring that actually need testing are queued or out for evaluation. Local evaluators and
+// web clients with several workers get two per worker so each has one to start on while its
+// result travels back.
+void refillSteadyStateQueue() {
+    const int maxCachedOffspring = 100;
+    int target = localEvaluators ? 2 * localEvaluators->getNumWorkers() : (clientWorkers > 1 ? 2 * clientWorkers : 1);
+    
+    for (int attempt = 0; static_cast<int>(genomeQueue.size()) + genomesInFlight < target && attempt < maxCachedOffspring; ++attempt) {
+        Genome* child = neat->replaceWorst();
+        if (!child) break;
         
-        if (server) {
-            server->sendMessage(message.dump());
-            cout << "Sent genome " << genomeId << " for testing" << endl;
+        double cachedFitness = 0.0;
+        if (neat->lookupFitness(*child, cachedFitness)) {
+            neat->reportFitness(child, cachedFitness);
+            generationFitness.add(cachedFitness);
+            continue;
         }
+        genomeQueue.push(static_cast<int>(reinterpret_cast<uintptr_t>(child)));
     }
 }
 
-// Start NEAT training
-void startTraining() {
-    {
-        std::lock_guard<std::mutex> lock(neatMutex);
-        if (!neat) {
-            NEAT::Config config;
-            config.populationSize = 30;
-            config.numInputs = 4; // dinoY, dinoVelocity, obstacleX, obstacleHeight
-            config.numOutputs = 2; // jump, crouch
-            config.compatibilityThreshold = 30;
-            config.weightMutationRate = 0.01;
-            config.addNodeRate = 0.3;
-            config.addConnectionRate = 0.5;
-            neat = new NEAT(config);
-            neat->initializePopulation();
-            cout << "NEAT initialized with population size: " << config.populationSize << endl;
+// Evolve and queue generations until one has something left to send. A generation that
+// is entirely resolved from the fitness cache is evolved straight away.
+void advanceGeneration() {
+    const int maxCachedGenerations = 100;
+    
+    for (int cachedGenerations = 0; ; ++cachedGenerations) {
+        if (cachedGenerations >= maxCachedGenerations) {
+            LOG_WARNING("Every genome of the last {} generations was already evaluated, stopping training", maxCachedGenerations);
+            trainingActive = false;
+            return;
         }
         
-        auto& population = neat->getPopulation();
-        genomeQueue = std::queue<int>();
-        fitnessResults.clear();
-        genomesTested = 0;
-        totalGenomes = static_cast<int>(population.size());
+        evolveGeneration();
         
-        for (auto* genome : population) {
-            genomeQueue.push(static_cast<int>(reinterpret_cast<uintptr_t>(genome)));
+        queuePopulation();
+        if (genomesTested < totalGenomes) break;
+    }
+    
+    LOG_INFO("Starting generation {} with {} genomes", currentGeneration, totalGenomes);
+    beginGenerationTrace();
+    sendNextGenome();
+}
+
+// Start NEAT training
+void startTraining(int genomeCacheSize, int workers) {
+    // A (re)connected client starts with an empty cache
+    genomeDeltaEncoder.reset(genomeCacheSize > 0 ? static_cast<size_t>(genomeCacheSize) : 0);
+    clientWorkers = (std::max)(1, workers);
+    
+    if (!neat) {
+        NEAT::Config config;
+        config.populationSize = 30;
+        config.numInputs = 4; // dinoY, dinoVelocity, obstacleX, obstacleHeight
+        config.numOutputs = 2; // jump, crouch
+        // Generational reproduction is a stub, so every generation is the previous one again and
+        // would be resolved entirely from the cache. Only steady-state offspring are memoized.
+        config.fitnessCacheSize = steadyStateMode ? 4096 : 0;
+        config.steadyState = steadyStateMode;
+        neat = new NEAT(config);
+        neat->setEvaluationSeeds({ courseSeed });
+        neat->initializePopulation();
+        nextReportAt = config.populationSize;
+        statisticsConfig.populationSize = config.populationSize;
+        statistics = std::make_unique<EvolutionStatistics>(statisticsConfig);
+        LOG_INFO("NEAT initialized with population size: {}", config.populationSize);
+    }
+    
+    // Before any genome, so the client plays every one of them on the course
+    DinoSimulator::Config simConfig;
+    auto schedule = ObstacleSchedule::get(courseSeed, static_cast<uint32_t>(simConfig.maxFrames));
+    outboundMessages.push(obstacleScheduleToJSON(*schedule).dump());
+    outboundMessages.push(decisionPolicyToJSON(decisionPolicy).dump());
+    if (clientMode.adaptive) clientMode.ticksPerFrame = initialAdaptiveTicks;
+    outboundMessages.push(clientModeToJSON(clientMode).dump());
+    championFitness = -1.0;
+    
+    queuePopulation();
+    genomesInFlight = 0;
+    bool generationComplete = genomesTested >= totalGenomes;
+    trainingActive = true;
+    trainingStartTime = std::chrono::steady_clock::now();
+    
+    // Steady state has no generations to complete: cached genomes count as results right away
+    if (steadyStateMode) {
+        for (const auto& result : fitnessResults) {
+            if (Genome* genome = findGenome(result.first)) {
+                neat->reportFitness(genome, result.second);
+            }
         }
-        
-        trainingActive = true;
+        refillSteadyStateQueue();
+        generationComplete = false;
+    }
+    
+    if (generationComplete) {
+        advanceGeneration();
+        return;
     }
     
-    cout << "Starting generation " << currentGeneration << " with " << totalGenomes << " genomes" << endl;
+    LOG_INFO("Starting generation {} with {} genomes", currentGeneration, totalGenomes);
+    beginGenerationTrace();
     sendNextGenome();
 }
 
+// Outbound path health: bytes copied per message should stay at frame-header size
+void logSendStats() {
+    if (!server) return;
+    
+    SimpleWebSocketServer::SendStats sendStats = server->getSendStats();
+    if (sendStats.messagesSent == 0) return;
+    
+    LOG_INFO("Send path: {} messages in {} sends, {} bytes copied per message, p99 latency < {} us, {} dropped",
+             sendStats.messagesSent, sendStats.sendCalls, static_cast<double>(sendStats.bytesCopied) / sendStats.messagesSent,
+             sendStats.getLatencyPercentileMicroseconds(0.99), sendStats.messagesDropped);
+}
+
+// Genome encoding efficiency: average bytes per genome message and how many went out as deltas
+void logGenomeWireStats() {
+    const GenomeDeltaEncoder::Stats& wireStats = genomeDeltaEncoder.getStats();
+    unsigned long long genomesSent = wireStats.fullGenomes + wireStats.deltaGenomes;
+    if (genomesSent == 0) return;
+    
+    LOG_INFO("Genome wire: {} full, {} delta, {} bytes per genome", wireStats.fullGenomes, wireStats.deltaGenomes,
+             static_cast<double>(genomeBytesSent) / genomesSent);
+}
+
+// Local evaluators: packed genome size and how often the rings were full or a side had to be woken
+void logLocalEvaluatorStats() {
+    if (!localEvaluators) return;
+    const SharedMemoryTransport::Stats& transportStats = localEvaluators->getStats();
+    if (transportStats.genomesSent == 0) return;
+    
+    LOG_INFO("Local evaluators: {} genomes, {} bytes per genome, {} ring full, {} wakeups", transportStats.genomesSent,
+             static_cast<double>(transportStats.bytesSent) / transportStats.genomesSent, transportStats.ringFull, transportStats.wakeups);
+}
+
+// Adaptive client mode: keep the client's simulation time per animation frame near the target, leaving
+// the rest of the frame to the browser. Ticks move by powers of two so the mode is rarely resent.
+void adaptClientMode(double simulationMs, int animationFrames) {
+    // The last animation frame of a game is cut short by the death, short games say little
+    if (!clientMode.adaptive || animationFrames < 4) return;
+    
+    double msPerFrame = simulationMs / animationFrames;
+    int ticks = clientMode.ticksPerFrame;
+    if (msPerFrame > 1.5 * targetSimulationMs) {
+        ticks = (std::max)(1, ticks / 2);
+    } else if (msPerFrame < 0.5 * targetSimulationMs) {
+        ticks = (std::min)(maxTicksPerFrame, ticks * 2);
+    }
+    if (ticks == clientMode.ticksPerFrame) return;
+    
+    LOG_INFO("Client simulates {} ms per animation frame, {} ticks per frame instead of {}",
+             msPerFrame, ticks, clientMode.ticksPerFrame);
+    clientMode.ticksPerFrame = ticks;
+    outboundMessages.push(clientModeToJSON(clientMode).dump());
+}
+
+// Network queries made by the web client against one per frame, the cost the decision policy saves
+void logInferenceStats() {
+    if (clientFrames == 0) return;
+    
+    LOG_INFO("Decisions: {} inferences per game, {}% of frames without inference",
+             static_cast<double>(clientInferences) / clientGames,
+             100.0 * (1.0 - static_cast<double>(clientInferences) / clientFrames));
+}
+
 // Evolve to next generation
 void evolveGeneration() {
-    cout << "Generation " << currentGeneration << " complete!" << endl;
+    LOG_INFO("Generation {} complete!", currentGeneration);
     
     double bestFitness = 0.0;
     double avgFitness = 0.0;
+    auto& population = neat->getPopulation();
     
-    {
-        std::lock_guard<std::mutex> lock(neatMutex);
-        auto& population = neat->getPopulation();
-        
-        for (auto* genome : population) {
-            auto it = fitnessResults.find(static_cast<int>(reinterpret_cast<uintptr_t>(genome)));
-            if (it != fitnessResults.end()) {
-                genome->setFitness(it->second);
-            } else {
-                genome->setFitness(0.0);
-            }
-        }
-        
-        for (auto* genome : population) {
-            bestFitness = max(bestFitness, genome->getFitness());
-            avgFitness += genome->getFitness();
+    // One pass: set the fitness of every genome and sum it up
+    Genome* bestGenome = nullptr;
+    for (auto* genome : population) {
+        auto it = fitnessResults.find(static_cast<int>(reinterpret_cast<uintptr_t>(genome)));
+        if (it != fitnessResults.end()) {
+            genome->setFitness(it->second);
+        } else {
+            genome->setFitness(0.0);
         }
-        avgFitness /= population.size();
         
-        neat->evolve();
-        currentGeneration++;
+        if (!bestGenome || genome->getFitness() > bestGenome->getFitness()) bestGenome = genome;
+        bestFitness = max(bestFitness, genome->getFitness());
+        avgFitness += genome->getFitness();
     }
+    avgFitness /= population.size();
+    sendChampion(bestGenome);
+    
+    const FitnessCache::Stats& cacheStats = neat->getFitnessCacheStats();
+    LOG_INFO("Fitness cache: {}/{} hits ({}%), {} evaluations saved", cacheStats.hits, cacheStats.getLookups(),
+             std::round(cacheStats.getHitRate() * 1000.0) / 10.0, cacheStats.hits);
+    
+    neat->evolve();
+    endGenerationTrace();
+    currentGeneration++;
     
-    cout << "Best fitness: " << bestFitness << endl;
-    cout << "Average fitness: " << avgFitness << endl;
+    LOG_INFO("Best fitness: {}", bestFitness);
+    LOG_INFO("Average fitness: {}", avgFitness);
     
     json stats;
     stats["type"] = "evolution_stats";
     stats["generation"] = currentGeneration;
     stats["bestFitness"] = bestFitness;
     stats["avgFitness"] = avgFitness;
+    outboundMessages.push(stats.dump());
     
-    // Send stats without holding the neatMutex
-    json statsCopy = stats;
-    std::lock_guard<std::mutex> clientLock(clientMutex);
-    if (server) {
-        server->sendMessage(statsCopy.dump());
+    LOG_INFO("Evolved to generation {}", currentGeneration);
+    logSendStats();
+    logGenomeWireStats();
+    logLocalEvaluatorStats();
+    logInferenceStats();
+}
+
+// Steady-state mode: fold the result in and hand the evaluator an offspring straight away,
+// so a slow evaluation never holds up the others
+void handleSteadyStateFitness(int genomeId, double fitness) {
+    if (Genome* genome = findGenome(genomeId)) {
+        neat->reportFitness(genome, fitness);
+        neat->storeFitness(*genome, fitness);
+        sendChampion(genome);
+        recordResult(*genome, fitness);
+    }
+    generationFitness.add(fitness);
+    
+    unsigned long long evaluations = neat->getEvaluationCount();
+    LOG_RATE_LIMITED(Logger::LEVEL_INFO, 10, "Genome {} fitness: {} (evaluation {})", genomeId, fitness, evaluations);
+    
+    refillSteadyStateQueue();
+    evaluations = neat->getEvaluationCount();
+    
+    // Report once per population-size worth of evaluations, the steady-state "generation". Cached
+    // results credited by refillSteadyStateQueue can cross several of them in one step, each is reported.
+    int populationSize = neat->getConfig().populationSize;
+    if (populationSize > 0 && evaluations >= nextReportAt) {
+        // Best of the population (cached by NEAT), average of the results since the last report
+        Genome* bestGenome = neat->getBestGenome();
+        double bestFitness = bestGenome ? bestGenome->getFitness() : 0.0;
+        double avgFitness = generationFitness.mean;
+        generationFitness = EvolutionStatistics::RunningStats();
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - trainingStartTime).count();
+        double evaluationsPerSecond = seconds > 0.0 ? evaluations / seconds : 0.0;
+        LOG_INFO("Steady state: {} evaluations, {} replacements, {} evaluations/s, best fitness {}",
+                 evaluations, neat->getReplacementCount(), evaluationsPerSecond, bestFitness);
+        logSendStats();
+        logGenomeWireStats();
+        logLocalEvaluatorStats();
+        logInferenceStats();
+        
+        while (evaluations >= nextReportAt) {
+            currentGeneration++;
+            nextReportAt += populationSize;
+            
+            json stats;
+            stats["type"] = "evolution_stats";
+            stats["generation"] = currentGeneration;
+            stats["bestFitness"] = bestFitness;
+            stats["avgFitness"] = avgFitness;
+            stats["evaluations"] = evaluations;
+            stats["evaluationsPerSecond"] = evaluationsPerSecond;
+            outboundMessages.push(stats.dump());
+        }
+        
+        endGenerationTrace();
+        beginGenerationTrace();
+    }
+    
+    sendNextGenome();
+}
+
+// Generational mode: collect results until the whole population has been tested
+void handleFitness(int genomeId, double fitness) {
+    PROFILE_SCOPE("handleFitness");
+    PROFILE_COUNT("evaluations", 1);
+    if (genomesInFlight > 0) genomesInFlight--;
+    
+    if (steadyStateMode) {
+        handleSteadyStateFitness(genomeId, fitness);
+        return;
+    }
+    
+    fitnessResults[genomeId] = fitness;
+    genomesTested++;
+    
+    if (Genome* genome = findGenome(genomeId)) {
+        neat->storeFitness(*genome, fitness);
+        recordResult(*genome, fitness);
+    }
+    
+    LOG_RATE_LIMITED(Logger::LEVEL_INFO, 10, "Genome {} fitness: {} ({}/{})", genomeId, fitness, genomesTested, totalGenomes);
+    
+    if (genomesTested >= totalGenomes) {
+        advanceGeneration();
+    } else {
+        sendNextGenome();
+    }
+}
+
+// The client could not decode a genome. A miss on the current epoch means the caches went out of
+// sync: the client has dropped its cache, so start over. A miss on an older epoch is a genome that
+// was in flight when that happened, already handled: only resend it.
+void handleCacheMiss(int genomeId, int epoch) {
+    if (epoch >= genomeDeltaEncoder.getEpoch()) {
+        LOG_WARNING("Client genome cache out of sync on genome {}, resending", genomeId);
+        genomeDeltaEncoder.reset(genomeDeltaEncoder.getCapacity());
     }
     
-    cout << "Evolved to generation " << currentGeneration << endl;
+    if (Genome* genome = findGenome(genomeId)) {
+        sendGenome(genomeId, genome);
+    }
 }
 
-// Handle WebSocket messages
+// Evolution thread: drain the events pushed by the socket thread
+void evolutionLoop() {
+    Profiler::instance().setThreadName("evolution");
+    EvolutionEvent event;
+    while (true) {
+        if (!evolutionEvents.waitPop(event, std::chrono::milliseconds(100))) continue;
+        
+        switch (event.type) {
+        case EvolutionEvent::READY:
+            startTraining(event.genomeCacheSize, event.workers);
+            break;
+        case EvolutionEvent::CACHE_MISS:
+            handleCacheMiss(event.genomeId, event.epoch);
+            break;
+        case EvolutionEvent::FITNESS:
+            if (event.frames > 0) {
+                clientGames++;
+                clientInferences += event.inferences;
+                clientFrames += event.frames;
+            }
+            adaptClientMode(event.simulationMs, event.animationFrames);
+            handleFitness(event.genomeId, event.fitness);
+            break;
+        }
+    }
+}
+
+// Sender thread: write queued messages to the socket in order
+void senderLoop() {
+    Profiler::instance().setThreadName("sender");
+    string message;
+    while (true) {
+        if (!outboundMessages.waitPop(message, std::chrono::milliseconds(100))) continue;
+        
+        if (server && clientConnected) {
+            server->sendMessage(std::move(message));
+        }
+    }
+}
+
+// Local evaluators: turn results read from shared memory into FITNESS events, like handleMessage
+void localResultLoop() {
+    SharedMemoryTransport::Result result;
+    while (true) {
+        if (!localEvaluators->waitForResults(100)) continue;
+        
+        while (localEvaluators->receiveResult(result)) {
+            EvolutionEvent event;
+            event.type = EvolutionEvent::FITNESS;
+            event.genomeId = result.genomeId;
+            event.fitness = result.fitness;
+            event.genomeCacheSize = 0;
+            evolutionEvents.push(event);
+        }
+    }
+}
+
+// Evaluator process (--evaluator): run every batch of genomes found in the request ring through
+// the native simulator and write the scores back
+int runLocalEvaluator(const string& regionName, int workerIndex) {
+    SharedMemoryTransport transport;
+    if (!transport.open(regionName, workerIndex)) {
+        cerr << "Evaluator " << workerIndex << ": cannot open shared memory region " << regionName << endl;
+        return 1;
+    }
+    
+    std::vector<std::unique_ptr<Genome>> genomes;
+    std::vector<Genome*> batch;
+    std::vector<int> genomeIds;
+    DinoSimulator::Config simConfig;
+    simConfig.seed = courseSeed;
+    simConfig.decisions = decisionPolicy;
+    
+    while (!transport.isShutdown()) {
+        if (!transport.waitForGenomes(100)) continue;
+        
+        batch.clear();
+        genomeIds.clear();
+        int genomeId = 0;
+        while (true) {
+            if (batch.size() == genomes.size()) genomes.push_back(std::make_unique<Genome>());
+            Genome* genome = genomes[batch.size()].get();
+            if (!transport.receiveGenome(genomeId, *genome)) break;
+            batch.push_back(genome);
+            genomeIds.push_back(genomeId);
+        }
+        if (batch.empty()) continue;
+        
+        DinoSimulator::evaluateGenomes(batch, simConfig);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (!transport.sendResult(genomeIds[i], batch[i]->getFitness())) break;
+        }
+    }
+    return 0;
+}
+
+// Handle WebSocket messages. Runs on the socket thread, so it only parses and hands off.
 void handleMessage(const string& message) {
     try {
-        json data = json::parse(message);
+        json data;
+        {
+            PROFILE_SCOPE("json::parse");
+            data = json::parse(message);
+        }
         string type = data["type"];
         
         if (type == "fitness") {
-            int genomeId = data["genomeId"];
-            double fitness = data["fitness"];
-            
-            bool shouldEvolve = false;
-            bool shouldSendNext = false;
-            
-            {
-                std::lock_guard<std::mutex> lock(neatMutex);
-                fitnessResults[genomeId] = fitness;
-                genomesTested++;
-                
-                cout << "Genome " << genomeId << " fitness: " << fitness << " (" << genomesTested << "/" << totalGenomes << ")" << endl;
-                
-                if (genomesTested >= totalGenomes) {
-                    shouldEvolve = true;
-                } else {
-                    shouldSendNext = true;
-                }
-            }
-            
-            if (shouldEvolve) {
-                evolveGeneration();
-                
-                {
-                    std::lock_guard<std::mutex> lock(neatMutex);
-                    auto& population = neat->getPopulation();
-                    genomeQueue = std::queue<int>();
-                    fitnessResults.clear();
-                    genomesTested = 0;
-                    totalGenomes = static_cast<int>(population.size());
-                    
-                    for (auto* genome : population) {
-                        genomeQueue.push(static_cast<int>(reinterpret_cast<uintptr_t>(genome)));
-                    }
-                }
-                
-                cout << "Starting generation " << currentGeneration << " with " << totalGenomes << " genomes" << endl;
-                sendNextGenome();
-            } else if (shouldSendNext) {
-                sendNextGenome();
-            }
+            EvolutionEvent event;
+            event.type = EvolutionEvent::FITNESS;
+            event.genomeId = data["genomeId"];
+            event.fitness = data["fitness"];
+            event.genomeCacheSize = 0;
+            event.inferences = data.value("inferences", 0);
+            event.frames = data.value("frames", 0);
+            event.simulationMs = data.value("simulationMs", 0.0);
+            event.animationFrames = data.value("animationFrames", 0);
+            evolutionEvents.push(event);
         } else if (type == "ready") {
-            cout << "Web client ready for training!" << endl;
-            startTraining();
+            if (localEvaluators) {
+                LOG_INFO("Web client connected, genomes are evaluated by the local evaluators");
+                return;
+            }
+            EvolutionEvent event;
+            event.type = EvolutionEvent::READY;
+            event.genomeId = -1;
+            event.fitness = 0.0;
+            event.genomeCacheSize = data.value("genomeCacheSize", 0);
+            event.workers = data.value("workers", 1);
+            LOG_INFO("Web client ready for training with {} worker(s)!", event.workers);
+            evolutionEvents.push(event);
+        } else if (type == "cache_miss") {
+            EvolutionEvent event;
+            event.type = EvolutionEvent::CACHE_MISS;
+            event.genomeId = data["genomeId"];
+            event.fitness = 0.0;
+            event.genomeCacheSize = 0;
+            event.epoch = data.value("epoch", 0);
+            evolutionEvents.push(event);
         } else if (type == "ping") {
             json response = { {"type", "pong"} };
-            std::lock_guard<std::mutex> clientLock(clientMutex);
-            if (server) {
-                server->sendMessage(response.dump());
-            }
+            outboundMessages.push(response.dump());
         }
     } catch (const std::exception& e) {
-        cerr << "Error processing message: " << e.what() << endl;
+        LOG_ERROR("Error processing message: {}", e.what());
+    }
+}
+
+// Self test of the default server path, without a socket: startTraining, then every genome queued for
+// the client is answered through handleFitness until the third generation starts or training stops
+int runTrainingSelfTest() {
+    const int generations = 2;
+    
+    Logger::Config logConfig;
+    logConfig.filePath = "";
+    logConfig.consoleLevel = Logger::LEVEL_WARNING;
+    Logger::instance().start(logConfig);
+    
+    clientConnected = true;
+    startTraining(0, 1);
+    
+    int results = 0;
+    string message;
+    while (trainingActive && currentGeneration <= generations && outboundMessages.tryPop(message)) {
+        json data = json::parse(message);
+        if (data["type"] != "genome") continue;
+        // Any deterministic score will do, it only has to come back
+        const json& genome = data["genome"];
+        handleFitness(genome["id"], static_cast<double>(genome["connections"].size()));
+        results++;
+    }
+    Logger::instance().stop();
+    
+    bool passed = trainingActive && currentGeneration > generations;
+    cout << (passed ? "PASS" : "FAIL") << ": " << results << " fitness results, generation " << currentGeneration
+         << ", training " << (trainingActive ? "active" : "stopped") << endl;
+    return passed ? 0 : 1;
+}
+
+// Sensor bits from a comma separated list such as "dino,closest,second,type,bird"
+unsigned int parseSensors(const string& list) {
+    unsigned int sensors = 0;
+    std::stringstream stream(list);
+    string name;
+    while (std::getline(stream, name, ',')) {
+        if (name == "dino") sensors |= DinoSimulator::SENSOR_DINO;
+        else if (name == "closest") sensors |= DinoSimulator::SENSOR_CLOSEST;
+        else if (name == "second") sensors |= DinoSimulator::SENSOR_SECOND;
+        else if (name == "type") sensors |= DinoSimulator::SENSOR_TYPE;
+        else if (name == "bird") sensors |= DinoSimulator::SENSOR_BIRD_HEIGHT;
+        else cerr << "Unknown sensor '" << name << "' ignored" << endl;
+    }
+    return sensors != 0 ? sensors : static_cast<unsigned int>(DinoSimulator::SENSORS_DEFAULT);
+}
+
+// Headless island-model run: evolve numIslands populations against the native simulator
+void runIslands(int numIslands, bool noveltySearch, unsigned int sensors) {
+    IslandModel::Config config;
+    config.numIslands = numIslands;
+    config.neat.populationSize = 100;
+    config.simulator.sensors = sensors;
+    config.neat.numInputs = DinoSimulator::getNumInputs(sensors);
+    config.neat.numOutputs = 2;
+    config.neat.noveltySearch = noveltySearch;
+    config.simulator.decisions = decisionPolicy;
+    config.simulator.episodes = evaluationEpisodes;
+    
+    LOG_INFO("Evolving {} islands for {} generations, {} migrants every {} generations{}",
+             config.numIslands, config.generations, config.migrantsPerMigration, config.migrationInterval,
+             noveltySearch ? ", selecting on novelty" : "");
+    IslandModel islands(config);
+    IslandModel::Stats stats = islands.run();
+    for (size_t i = 0; i < stats.islands.size(); ++i) {
+        const IslandModel::IslandStats& island = stats.islands[i];
+        LOG_INFO("Island {}: best fitness {}, {} evaluations, {} migrants sent, {} received",
+                 i, island.bestFitness, island.evaluations, island.migrantsSent, island.migrantsReceived);
     }
+    LOG_INFO("Best fitness {} after {} evaluations in {}s ({} evals/s)",
+             stats.bestFitness, stats.evaluations, stats.seconds, stats.getEvaluationsPerSecond());
 }
 
-int main() {
-    cout << "=== NEAT WebSocket Server for Dino Game (using SimpleWebSocketServer) ===" << endl;
-    cout << "Starting WebSocket server on port 20000..." << endl;
+// Headless sweep over the main NEAT parameters, every run against the native simulator
+void runSweep(const string& outputPrefix, unsigned int sensors) {
+    NEAT::Config base;
+    base.populationSize = 100;
+    base.numInputs = DinoSimulator::getNumInputs(sensors);
+    base.numOutputs = 2;
+    
+    HyperparameterSweep::Grid grid;
+    grid.compatibilityThreshold = { 2.0, 3.0, 4.0 };
+    grid.weightMutationRate = { 0.5, 0.8 };
+    grid.weightMutationPower = { 0.05, 0.1, 0.2 };
+    grid.toggleConnectionRate = { 0.05, 0.1 };
+    
+    HyperparameterSweep::Config config;
+    config.runs = HyperparameterSweep::makeGrid(base, grid);
+    config.numThreads = static_cast<int>(std::thread::hardware_concurrency());
+    config.outputPrefix = outputPrefix;
+    config.simulator.sensors = sensors;
+    config.simulator.decisions = decisionPolicy;
+    config.simulator.episodes = evaluationEpisodes;
+    
+    LOG_INFO("Sweeping {} configurations on {} threads, results in {}_runs.csv and {}_series.csv",
+             config.runs.size(), config.numThreads, outputPrefix, outputPrefix);
+    HyperparameterSweep sweep(config);
+    HyperparameterSweep::Stats stats = sweep.run();
+    if (stats.bestRun >= 0) {
+        LOG_INFO("Best run {} with fitness {}", stats.runs[stats.bestRun].index, stats.runs[stats.bestRun].bestFitness);
+    }
+    LOG_INFO("{} runs, {} stopped early, {} evaluations in {}s", stats.runs.size(), stats.stoppedEarly,
+             stats.evaluations, stats.seconds);
+}
+
+int main(int argc, char* argv[]) {
+    int numLocalEvaluators = 0;
+    int numIslands = 0;
+    bool noveltySearch = false;
+    string sweepPrefix;
+    string evaluatorRegion;
+    int evaluatorIndex = 0;
+    // Decision policy flags, passed on to the local evaluator processes as given
+    std::vector<string> evaluatorArguments;
+    unsigned int sensors = DinoSimulator::SENSORS_DEFAULT;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--self-test") {
+            return runTrainingSelfTest();
+        } else if (arg == "--islands" && i + 1 < argc) {
+            numIslands = std::atoi(argv[++i]);
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            sweepPrefix = argv[++i];
+        } else if (arg == "--sensors" && i + 1 < argc) {
+            sensors = parseSensors(argv[++i]);
+        } else if (arg == "--decision-interval" && i + 1 < argc) {
+            decisionPolicy.interval = std::atoi(argv[++i]);
+            evaluatorArguments.insert(evaluatorArguments.end(), { arg, argv[i] });
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            statisticsConfig.snapshotIntervalMs = std::atoi(argv[++i]);
+        } else if (arg == "--stats-log" && i + 1 < argc) {
+            statisticsConfig.logPath = argv[++i];
+        } else if (arg == "--episodes" && i + 1 < argc) {
+            evaluationEpisodes = std::atoi(argv[++i]);
+        } else if (arg == "--ticks-per-frame" && i + 1 < argc) {
+            clientMode.ticksPerFrame = std::atoi(argv[++i]);
+            clientMode.adaptive = clientMode.ticksPerFrame <= 0;
+            clientMode.ticksPerFrame = (std::max)(1, clientMode.ticksPerFrame);
+        } else if (arg == "--render-interval" && i + 1 < argc) {
+            clientMode.renderInterval = std::atoi(argv[++i]);
+        } else if (arg == "--render-champion") {
+            clientMode.renderChampion = true;
+        } else if (arg == "--skip-airborne") {
+            decisionPolicy.skipAirborne = true;
+            evaluatorArguments.push_back(arg);
+        } else if (arg == "--input-epsilon" && i + 1 < argc) {
+            decisionPolicy.inputEpsilon = std::atof(argv[++i]);
+            evaluatorArguments.insert(evaluatorArguments.end(), { arg, argv[i] });
+        } else if (arg == "--novelty") {
+            noveltySearch = true;
+        } else if (arg == "--evaluator" && i + 2 < argc) {
+            evaluatorRegion = argv[++i];
+            evaluatorIndex = std::atoi(argv[++i]);
+        } else if (arg == "--local-evaluators" && i + 1 < argc) {
+            numLocalEvaluators = std::atoi(argv[++i]);
+        } else if (arg == "--steady-state") {
+            steadyStateMode = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+            traceRequested = true;
+        } else if (arg == "--no-profile") {
+            Profiler::instance().setEnabled(false);
+        }
+    }
+
+    if (!evaluatorRegion.empty()) {
+        return runLocalEvaluator(evaluatorRegion, evaluatorIndex);
+    }
+    // The evaluators answer with the score of one game per genome, on the server's course
+    if (numLocalEvaluators > 0 && evaluationEpisodes > 1) {
+        cerr << "--episodes applies to --islands and --sweep runs, not to --local-evaluators" << endl;
+        return 1;
+    }
+
+    if (!sweepPrefix.empty()) {
+        Logger::instance().start(Logger::Config());
+        runSweep(sweepPrefix, sensors);
+        Logger::instance().stop();
+        return 0;
+    }
+    
+    if (numIslands > 0) {
+        Logger::instance().start(Logger::Config());
+        runIslands(numIslands, noveltySearch, sensors);
+        Logger::instance().stop();
+        return 0;
+    }
+
+    Logger::instance().start(Logger::Config());
+    
+    LOG_INFO("=== NEAT WebSocket Server for Dino Game (using SimpleWebSocketServer) ===");
+    LOG_INFO("Starting WebSocket server on port 20000...");
     
     // Create WebSocket server
     server = std::make_unique<SimpleWebSocketServer>();
@@ -278,25 +1029,66 @@ int main() {
     // Set up callbacks
     server->setMessageCallback(handleMessage);
     server->setConnectCallback([]() {
-        cout << "=== CLIENT CONNECTION STARTED ===" << endl;
-        std::lock_guard<std::mutex> lock(clientMutex);
         clientConnected = true;
-        cout << "WebSocket client connected!" << endl;
+        LOG_INFO("WebSocket client connected!");
     });
     server->setDisconnectCallback([]() {
-        cout << "WebSocket client disconnected!" << endl;
-        std::lock_guard<std::mutex> lock(clientMutex);
+        LOG_INFO("WebSocket client disconnected!");
         clientConnected = false;
     });
+    server->setHttpCallback([](const string& path, string& contentType, string& body) {
+        Profiler& profiler = Profiler::instance();
+        if (path == "/metrics") {
+            contentType = "text/plain; version=0.0.4; charset=utf-8";
+            body = profiler.formatMetrics();
+            return true;
+        }
+        if (path == "/trace/start") {
+            traceRequested = true;
+            body = "Tracing the next generation, then see /trace\n";
+            return true;
+        }
+        if (path == "/trace" && profiler.hasTrace() && !profiler.isTracing()) {
+            contentType = "application/json";
+            body = profiler.getTraceJSON();
+            return true;
+        }
+        return false;
+    });
+    
+    // Evolution and socket writes run on their own threads, off the socket reader
+    std::thread(evolutionLoop).detach();
+    std::thread(senderLoop).detach();
+    
+    // Local evaluators start training right away, the browser can still connect to watch the stats
+    if (numLocalEvaluators > 0) {
+        localEvaluators = std::make_unique<SharedMemoryTransport>();
+        if (!localEvaluators->create(numLocalEvaluators, 1 << 20) || !localEvaluators->launchWorkers(evaluatorArguments)) {
+            LOG_ERROR("Failed to start {} local evaluators", numLocalEvaluators);
+            Logger::instance().stop();
+            return 1;
+        }
+        LOG_INFO("Started {} local evaluators on shared memory region {}", numLocalEvaluators, localEvaluators->getName());
+        std::thread(localResultLoop).detach();
+        
+        EvolutionEvent event;
+        event.type = EvolutionEvent::READY;
+        event.genomeId = -1;
+        event.fitness = 0.0;
+        event.genomeCacheSize = 0;
+        evolutionEvents.push(event);
+    }
     
     // Start the server
     if (!server->start(20000)) {
-        cerr << "Failed to start WebSocket server" << endl;
+        LOG_ERROR("Failed to start WebSocket server");
+        Logger::instance().stop();
         return 1;
     }
     
-    cout << "Server listening on port 20000" << endl;
-    cout << "Open your web Dino game in the browser to connect." << endl;
+    LOG_INFO("Server listening on port 20000{}", steadyStateMode ? " (steady-state evolution)" : "");
+    LOG_INFO("Open your web Dino game in the browser to connect.");
+    LOG_INFO("Profiler metrics at http://127.0.0.1:20000/metrics{}", Profiler::instance().isEnabled() ? "" : " (disabled)");
     
     // Keep the main thread alive
     while (true) {
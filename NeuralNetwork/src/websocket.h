@@ -1,22 +1,86 @@
 #pragma once
 
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#include <wincrypt.h>
 #include <string>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
 #include <functional>
+#include <cstdint>
+#include "WebSocketFrameParser.h"
+#include "Profiler.h"
+#include <winsock2.h> // Defines min/max macros, keep it after the standard headers
+#include <ws2tcpip.h>
+#include <wincrypt.h>
 
 #pragma comment(lib, "ws2_32.lib")
 #pragma comment(lib, "crypt32.lib")
 
 class SimpleWebSocketServer {
+public:
+    struct SendStats {
+        uint64_t messagesSent = 0;
+        uint64_t payloadBytesSent = 0;
+        uint64_t bytesCopied = 0;       // Frame headers only, payloads are sent straight from the queued buffer
+        uint64_t sendCalls = 0;         // Each WSASend carries up to MAX_FRAMES_PER_SEND frames
+        uint64_t messagesDropped = 0;   // A connection's queue stayed full past the backpressure timeout
+        uint64_t latencyBuckets[32] = {}; // Queued-to-sent latency, bucket i counts [2^i, 2^(i+1)) microseconds
+
+        uint64_t getLatencyPercentileMicroseconds(double _percentile) const {
+            uint64_t total = 0;
+            for (uint64_t count : latencyBuckets) total += count;
+            if (total == 0) return 0;
+
+            uint64_t threshold = static_cast<uint64_t>(_percentile * total);
+            uint64_t seen = 0;
+            for (int i = 0; i < 32; i++) {
+                seen += latencyBuckets[i];
+                if (seen > threshold) return 1ULL << (i + 1);
+            }
+            return 1ULL << 32;
+        }
+    };
+
 private:
+    static const int MAX_FRAME_HEADER = 10;  // Server frames are never masked
+    static const int MAX_FRAMES_PER_SEND = 16;
+
+    // A frame waiting in a connection's outbound queue. The payload is shared, so a broadcast
+    // queues the same buffer on every connection.
+    struct OutboundFrame {
+        std::shared_ptr<const std::string> payload;
+        int opcode;
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    // Each connection is read by handleClient and written by its own writer thread, so a slow
+    // client only ever stalls its own queue
+    struct Connection {
+        SOCKET socket = INVALID_SOCKET;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<OutboundFrame> queue;
+        size_t queuedBytes = 0;
+        bool closing = false;
+        std::thread writer;
+    };
+
     SOCKET serverSocket;
-    SOCKET clientSocket = INVALID_SOCKET; // Store the current client socket
+    std::mutex connectionsMutex;
+    std::vector<std::shared_ptr<Connection>> connections;
+    size_t maxQueuedBytes = 8 * 1024 * 1024;
+    size_t maxMessageSize = 16 * 1024 * 1024;
+    std::chrono::milliseconds backpressureTimeout = std::chrono::milliseconds(2000);
+    std::mutex statsMutex;
+    SendStats sendStats;
     std::function<void(const std::string&)> messageCallback;
     std::function<void()> connectCallback;
     std::function<void()> disconnectCallback;
+    std::function<bool(const std::string&, std::string&, std::string&)> httpCallback;
     bool running;
 
     // Base64 encoding
@@ -125,143 +189,283 @@ private:
         return send(clientSocket, response.c_str(), (int)response.length(), 0) != SOCKET_ERROR;
     }
 
-    // Send WebSocket frame
-    bool sendFrame(SOCKET socket, const std::string& message, int opcode = 0x01) {
-        std::vector<uint8_t> frame;
-        
-        // FIN + opcode
-        frame.push_back(0x80 | opcode);
-        
-        // Payload length
-        if (message.length() < 126) {
-            frame.push_back(message.length());
-        } else if (message.length() < 65536) {
-            frame.push_back(126);
-            frame.push_back((message.length() >> 8) & 0xFF);
-            frame.push_back(message.length() & 0xFF);
-        } else {
-            frame.push_back(127);
-            for (int i = 7; i >= 0; i--) {
-                frame.push_back((message.length() >> (i * 8)) & 0xFF);
-            }
+    // Answer a plain HTTP GET on the WebSocket port (metrics scrapes, curl) and close
+    void handleHttpRequest(SOCKET clientSocket, const std::string& request) {
+        size_t pathEnd = request.find(' ', 4);
+        std::string path = request.substr(4, pathEnd == std::string::npos ? std::string::npos : pathEnd - 4);
+        
+        std::string contentType = "text/plain; charset=utf-8";
+        std::string body;
+        bool found = httpCallback && httpCallback(path, contentType, body);
+        if (!found) {
+            contentType = "text/plain; charset=utf-8";
+            body = "Not found\n";
         }
         
-        // Payload
-        frame.insert(frame.end(), message.begin(), message.end());
-        
-        return send(socket, (char*)frame.data(), (int)frame.size(), 0) != SOCKET_ERROR;
+        std::string response =
+            std::string(found ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n") +
+            "Content-Type: " + contentType + "\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n"
+            "\r\n";
+        WSABUF buffers[2];
+        buffers[0].buf = const_cast<CHAR*>(response.data());
+        buffers[0].len = static_cast<ULONG>(response.size());
+        buffers[1].buf = const_cast<CHAR*>(body.data());
+        buffers[1].len = static_cast<ULONG>(body.size());
+        sendBuffers(clientSocket, buffers, body.empty() ? 1 : 2);
     }
 
-    // Parse WebSocket frame
-    struct WebSocketFrame {
-        bool fin;
-        int opcode;
-        bool masked;
-        uint64_t payloadLength;
-        std::vector<uint8_t> payload;
-    };
-
-    WebSocketFrame parseFrame(const std::vector<uint8_t>& data) {
-        WebSocketFrame frame;
-        if (data.size() < 2) return frame;
-        
-        frame.fin = (data[0] & 0x80) != 0;
-        frame.opcode = data[0] & 0x0F;
-        frame.masked = (data[1] & 0x80) != 0;
-        
-        uint64_t payloadLength = data[1] & 0x7F;
-        int headerSize = 2;
-        
-        if (payloadLength == 126) {
-            if (data.size() < 4) return frame;
-            payloadLength = (data[2] << 8) | data[3];
-            headerSize = 4;
-        } else if (payloadLength == 127) {
-            if (data.size() < 10) return frame;
-            payloadLength = 0;
-            for (int i = 0; i < 8; i++) {
-                payloadLength = (payloadLength << 8) | data[2 + i];
+    // Scatter-gather send (winsock's writev), retried until every buffer is out
+    static bool sendBuffers(SOCKET socket, WSABUF* buffers, DWORD count) {
+        while (count > 0) {
+            DWORD bytesSent = 0;
+            if (WSASend(socket, buffers, count, &bytesSent, 0, NULL, NULL) == SOCKET_ERROR) return false;
+            
+            // Skip what went out and resume mid-buffer after a partial send
+            while (count > 0 && bytesSent >= buffers->len) {
+                bytesSent -= buffers->len;
+                buffers++;
+                count--;
             }
-            headerSize = 10;
+            if (count > 0) {
+                buffers->buf += bytesSent;
+                buffers->len -= bytesSent;
+            }
+        }
+        return true;
+    }
+
+    // Queue a frame on one connection. Blocks while the connection is over its byte budget,
+    // which pushes back on the producer instead of growing without bound.
+    bool enqueueFrame(Connection& connection, const std::shared_ptr<const std::string>& payload, int opcode) {
+        std::unique_lock<std::mutex> lock(connection.mutex);
+        
+        // An oversized frame still goes through once the queue is empty
+        bool hasRoom = connection.changed.wait_for(lock, backpressureTimeout, [&]() {
+            return connection.closing || connection.queue.empty() ||
+                   connection.queuedBytes + payload->size() <= maxQueuedBytes;
+        });
+        if (!hasRoom || connection.closing) {
+            lock.unlock();
+            std::lock_guard<std::mutex> statsLock(statsMutex);
+            sendStats.messagesDropped++;
+            return false;
         }
         
-        if (frame.masked) {
-            if (data.size() < headerSize + 4 + payloadLength) return frame;
-            uint8_t mask[4] = {data[headerSize], data[headerSize + 1], data[headerSize + 2], data[headerSize + 3]};
-            headerSize += 4;
+        OutboundFrame frame;
+        frame.payload = payload;
+        frame.opcode = opcode;
+        frame.queuedAt = std::chrono::steady_clock::now();
+        connection.queue.push_back(std::move(frame));
+        connection.queuedBytes += payload->size();
+        connection.changed.notify_all();
+        return true;
+    }
+
+    // Writer thread of one connection: coalesce queued frames into a single WSASend each round
+    void writerLoop(Connection* connection) {
+        Profiler::instance().setThreadName("websocket writer");
+        OutboundFrame batch[MAX_FRAMES_PER_SEND];
+        uint8_t headers[MAX_FRAMES_PER_SEND][MAX_FRAME_HEADER];
+        WSABUF buffers[MAX_FRAMES_PER_SEND * 2];
+        
+        while (true) {
+            int numFrames = 0;
+            {
+                std::unique_lock<std::mutex> lock(connection->mutex);
+                connection->changed.wait(lock, [&]() { return connection->closing || !connection->queue.empty(); });
+                
+                // Frames queued before closing (e.g. the close reply) still go out
+                if (connection->queue.empty()) return;
+                
+                while (numFrames < MAX_FRAMES_PER_SEND && !connection->queue.empty()) {
+                    batch[numFrames++] = std::move(connection->queue.front());
+                    connection->queue.pop_front();
+                }
+            }
+            
+            size_t payloadBytes = 0;
+            uint64_t headerBytes = 0;
+            DWORD numBuffers = 0;
+            for (int i = 0; i < numFrames; i++) {
+                const std::string& payload = *batch[i].payload;
+                int headerSize = WebSocketFrameParser::encodeHeader(headers[i], payload.size(), batch[i].opcode);
+                headerBytes += headerSize;
+                payloadBytes += payload.size();
+                
+                buffers[numBuffers].buf = reinterpret_cast<CHAR*>(headers[i]);
+                buffers[numBuffers++].len = static_cast<ULONG>(headerSize);
+                if (!payload.empty()) {
+                    buffers[numBuffers].buf = const_cast<CHAR*>(payload.data());
+                    buffers[numBuffers++].len = static_cast<ULONG>(payload.size());
+                }
+            }
             
-            frame.payload.resize(payloadLength);
-            for (uint64_t i = 0; i < payloadLength; i++) {
-                frame.payload[i] = data[headerSize + i] ^ mask[i % 4];
+            bool sent;
+            {
+                PROFILE_SCOPE("websocket.send");
+                sent = sendBuffers(connection->socket, buffers, numBuffers);
+            }
+            if (sent) {
+                PROFILE_COUNT("websocket.frames_sent", numFrames);
+                PROFILE_COUNT("websocket.bytes_sent", payloadBytes + headerBytes);
+            }
+            auto sentAt = std::chrono::steady_clock::now();
+            
+            {
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                sendStats.sendCalls++;
+                sendStats.bytesCopied += headerBytes;
+                if (sent) {
+                    sendStats.messagesSent += numFrames;
+                    sendStats.payloadBytesSent += payloadBytes;
+                    for (int i = 0; i < numFrames; i++) {
+                        long long micros = std::chrono::duration_cast<std::chrono::microseconds>(sentAt - batch[i].queuedAt).count();
+                        int bucket = 0;
+                        while (bucket < 31 && (1LL << (bucket + 1)) <= micros) bucket++;
+                        sendStats.latencyBuckets[bucket]++;
+                    }
+                }
+            }
+            
+            for (int i = 0; i < numFrames; i++) {
+                batch[i].payload.reset();
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(connection->mutex);
+                connection->queuedBytes -= payloadBytes;
+                if (!sent) {
+                    // Peer is gone: drop what is left and release blocked producers
+                    connection->closing = true;
+                    connection->queue.clear();
+                    connection->queuedBytes = 0;
+                }
+                connection->changed.notify_all();
+            }
+            if (!sent) return;
+        }
+    }
+
+    // Queue a control frame (close, pong) on the connection's writer
+    bool sendControlFrame(Connection& connection, int opcode, const std::string& payload = std::string()) {
+        return enqueueFrame(connection, std::make_shared<const std::string>(payload), opcode);
+    }
+
+    // Close with a status code (1002 protocol error, 1009 message too big)
+    void sendCloseFrame(Connection& connection, int statusCode) {
+        std::string payload;
+        payload.push_back(static_cast<char>((statusCode >> 8) & 0xFF));
+        payload.push_back(static_cast<char>(statusCode & 0xFF));
+        sendControlFrame(connection, WebSocketFrameParser::OPCODE_CLOSE, payload);
+    }
+
+    // Dispatch every complete frame buffered in the parser. Returns false once the connection must close.
+    bool processFrames(WebSocketFrameParser& parser, Connection& connection) {
+        WebSocketFrameParser::Frame frame;
+        
+        while (true) {
+            switch (parser.next(frame)) {
+            case WebSocketFrameParser::RESULT_NEED_MORE:
+                return true;
+            case WebSocketFrameParser::RESULT_PROTOCOL_ERROR:
+                sendCloseFrame(connection, 1002);
+                return false;
+            case WebSocketFrameParser::RESULT_TOO_LARGE:
+                sendCloseFrame(connection, 1009);
+                return false;
+            case WebSocketFrameParser::RESULT_MESSAGE:
+                PROFILE_COUNT("websocket.messages_received", 1);
+                if (frame.opcode == WebSocketFrameParser::OPCODE_TEXT && messageCallback) {
+                    messageCallback(std::string(reinterpret_cast<const char*>(frame.data), frame.size));
+                }
+                break;
+            case WebSocketFrameParser::RESULT_CONTROL:
+                if (frame.opcode == WebSocketFrameParser::OPCODE_CLOSE) {
+                    sendControlFrame(connection, WebSocketFrameParser::OPCODE_CLOSE);
+                    return false;
+                } else if (frame.opcode == WebSocketFrameParser::OPCODE_PING) {
+                    // Pong echoes the ping payload
+                    sendControlFrame(connection, WebSocketFrameParser::OPCODE_PONG,
+                                     std::string(reinterpret_cast<const char*>(frame.data), frame.size));
+                }
+                break;
             }
-        } else {
-            if (data.size() < headerSize + payloadLength) return frame;
-            frame.payload.assign(data.begin() + headerSize, data.begin() + headerSize + payloadLength);
         }
-        
-        return frame;
     }
 
     // Handle client connection
     void handleClient(SOCKET clientSocket) {
         char buffer[4096];
-        std::vector<uint8_t> messageBuffer;
         bool handshakeCompleted = false;
+        std::shared_ptr<Connection> connection;
+        // Client frames must be masked
+        WebSocketFrameParser parser(maxMessageSize, true);
         
         while (running) {
-            int bytesReceived = recv(clientSocket, buffer, sizeof(buffer), 0);
-            if (bytesReceived <= 0) break;
-            
             if (!handshakeCompleted) {
+                int bytesReceived = recv(clientSocket, buffer, sizeof(buffer), 0);
+                if (bytesReceived <= 0) break;
+                
                 std::string request(buffer, bytesReceived);
                 if (request.find("GET /") == 0 && request.find("Upgrade: websocket") != std::string::npos) {
                     if (handleHandshake(clientSocket, request)) {
                         handshakeCompleted = true;
-                        this->clientSocket = clientSocket; // Set the client socket for sending messages
+                        
+                        // From here on every write goes through the connection's writer thread
+                        connection = std::make_shared<Connection>();
+                        connection->socket = clientSocket;
+                        connection->writer = std::thread(&SimpleWebSocketServer::writerLoop, this, connection.get());
+                        {
+                            std::lock_guard<std::mutex> lock(connectionsMutex);
+                            connections.push_back(connection);
+                        }
                         if (connectCallback) connectCallback();
+                        Profiler::instance().setThreadName("websocket reader");
+                        
+                        // Frames the client sent right behind the handshake
+                        size_t headerEnd = request.find("\r\n\r\n");
+                        if (headerEnd != std::string::npos && headerEnd + 4 < request.size()) {
+                            parser.append(reinterpret_cast<const uint8_t*>(request.data()) + headerEnd + 4, request.size() - headerEnd - 4);
+                            if (!processFrames(parser, *connection)) break;
+                        }
                         continue;
                     } else {
                         break;
                     }
+                } else if (request.find("GET /") == 0) {
+                    handleHttpRequest(clientSocket, request);
+                    break;
                 }
             } else {
-                messageBuffer.insert(messageBuffer.end(), buffer, buffer + bytesReceived);
+                // Receive straight into the parser's buffer
+                size_t available = 0;
+                uint8_t* space = parser.prepareWrite(sizeof(buffer), available);
+                int capacity = available > (1 << 30) ? (1 << 30) : static_cast<int>(available);
+                int bytesReceived = recv(clientSocket, reinterpret_cast<char*>(space), capacity, 0);
+                if (bytesReceived <= 0) break;
                 
-                while (messageBuffer.size() >= 2) {
-                    WebSocketFrame frame = parseFrame(messageBuffer);
-                    if (frame.payload.empty()) break;
-                    
-                    // Remove processed frame from buffer
-                    size_t frameSize = 2;
-                    if (frame.masked) frameSize += 4;
-                    if (frame.payload.size() < 126) {
-                        frameSize += frame.payload.size();
-                    } else if (frame.payload.size() < 65536) {
-                        frameSize += 2 + frame.payload.size();
-                    } else {
-                        frameSize += 8 + frame.payload.size();
-                    }
-                    
-                    if (messageBuffer.size() < frameSize) break;
-                    messageBuffer.erase(messageBuffer.begin(), messageBuffer.begin() + frameSize);
-                    
-                    // Handle message
-                    if (frame.opcode == 0x01) { // Text frame
-                        std::string message(frame.payload.begin(), frame.payload.end());
-                        if (messageCallback) messageCallback(message);
-                    } else if (frame.opcode == 0x08) { // Close frame
-                        sendFrame(clientSocket, "", 0x08);
-                        goto cleanup;
-                    } else if (frame.opcode == 0x09) { // Ping frame
-                        sendFrame(clientSocket, "", 0x0A); // Send pong
-                    }
-                }
+                parser.commitWrite(bytesReceived);
+                if (!processFrames(parser, *connection)) break;
             }
         }
         
-    cleanup:
+        if (connection) {
+            {
+                std::lock_guard<std::mutex> lock(connectionsMutex);
+                connections.erase(std::remove(connections.begin(), connections.end(), connection), connections.end());
+            }
+            {
+                std::lock_guard<std::mutex> lock(connection->mutex);
+                connection->closing = true;
+                connection->changed.notify_all();
+            }
+            connection->writer.join();
+        }
         closesocket(clientSocket);
-        if (disconnectCallback) disconnectCallback();
+        // Plain HTTP requests never were a client
+        if (connection && disconnectCallback) disconnectCallback();
     }
 
 public:
@@ -340,8 +544,50 @@ public:
         disconnectCallback = callback;
     }
     
+    // Serve plain HTTP GETs on the same port: the callback gets the path (with its query string),
+    // fills in the content type and body, and returns false for a 404
+    void setHttpCallback(std::function<bool(const std::string& path, std::string& contentType, std::string& body)> callback) {
+        httpCallback = callback;
+    }
+    
+    // Queue a text message on every connected client. Returns false if no client took it.
     bool sendMessage(const std::string& message) {
-        if (clientSocket == INVALID_SOCKET) return false;
-        return sendFrame(clientSocket, message, 0x01);
+        return broadcast(std::make_shared<const std::string>(message));
+    }
+    
+    bool sendMessage(std::string&& message) {
+        return broadcast(std::make_shared<const std::string>(std::move(message)));
+    }
+    
+    // Queue one serialized buffer on every connection without copying it per client
+    bool broadcast(const std::shared_ptr<const std::string>& message) {
+        std::vector<std::shared_ptr<Connection>> targets;
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            targets = connections;
+        }
+        
+        bool queued = false;
+        for (auto& connection : targets) {
+            queued = enqueueFrame(*connection, message, 0x01) || queued;
+        }
+        return queued;
+    }
+    
+    // Per-connection queue limit in bytes and how long a producer waits for room before the
+    // message is dropped for that connection
+    void setSendQueueLimits(size_t maxBytes, std::chrono::milliseconds timeout) {
+        maxQueuedBytes = maxBytes;
+        backpressureTimeout = timeout;
+    }
+    
+    // Largest incoming message (after reassembly) before the connection is closed with 1009
+    void setMaxMessageSize(size_t maxBytes) {
+        maxMessageSize = maxBytes;
+    }
+    
+    SendStats getSendStats() {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        return sendStats;
     }
 }; 
\ No newline at end of file
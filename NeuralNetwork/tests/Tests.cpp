@@ -0,0 +1,213 @@
+// File: Tests.cpp
+// Description: Checks of the NEAT core that need no server: every test prints what failed and the
+//              executable returns 1 when anything did. Fixtures shared with the web client's checks
+//              are read from the tests directory (--fixtures <dir>).
+// Author: Nicolas Gauvin-Gingras
+// Date: 2026-10-19
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include "NEAT.h"
+#include "CompiledNetwork.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using json = nlohmann::json;
+
+string fixtureDirectory = "tests";
+int checks = 0;
+int failures = 0;
+
+void check(bool condition, const string& what) {
+    checks++;
+    if (!condition) {
+        failures++;
+        cout << "  FAIL " << what << endl;
+    }
+}
+
+void checkNear(double actual, double expected, double tolerance, const string& what) {
+    std::ostringstream message;
+    message.precision(17);
+    message << what << ": " << actual << ", expected " << expected;
+    check(std::fabs(actual - expected) <= tolerance, message.str());
+}
+
+bool readFixture(const string& name, json& fixture) {
+    std::ifstream file(fixtureDirectory + "/" + name);
+    if (!file) {
+        check(false, "cannot open fixture " + fixtureDirectory + "/" + name);
+        return false;
+    }
+    fixture = json::parse(file);
+    return true;
+}
+
+// Inverse of GenomeDeltaEncoder::genomeToJSON
+Genome genomeFromJSON(const json& data) {
+    Genome genome;
+    for (const auto& node : data["nodes"]) {
+        string type = node["type"];
+        genome.addNode(node["id"], node.value("bias", 0.0), type == "input", type == "output");
+    }
+    for (const auto& connection : data["connections"]) {
+        genome.addConnection(connection["fromNode"], connection["toNode"], connection["weight"], connection["innovationNumber"]);
+        genome.m_connections.back().enabled = connection["enabled"];
+    }
+    return genome;
+}
+
+// The native networks compute the outputs the browser's NEATNetwork is checked against
+// (tests/networkCrossCheck.js): sigmoid of the weighted inputs plus the node bias
+void testNetworkFixture() {
+    json fixture;
+    if (!readFixture("network_fixture.json", fixture)) return;
+    Genome genome = genomeFromJSON(fixture["genome"]);
+
+    for (bool prune : { false, true }) {
+        CompiledNetwork network = genome.compile(nullptr, prune);
+        for (const auto& testCase : fixture["cases"]) {
+            std::vector<double> inputs = testCase["inputs"];
+            std::vector<double> expected = testCase["outputs"];
+            network.resetState();
+            network.feedForward(inputs);
+            check(network.getNumOutputs() == expected.size(), "compiled network output count");
+            for (size_t i = 0; i < expected.size() && i < network.getNumOutputs(); ++i) {
+                checkNear(network.getOutput(i), expected[i], 1e-12,
+                          string(prune ? "pruned" : "unpruned") + " network, inputs " + testCase["inputs"].dump() + ", output " + std::to_string(i));
+            }
+        }
+    }
+}
+
+// Dead structure is dropped at build time without changing what the network computes. Hidden node 4
+// leads nowhere, hidden node 6 only through a disabled connection, and hidden node 5 has no enabled
+// input, so its constant value is folded into the bias of output 2.
+void testPruning() {
+    Genome genome;
+    genome.addNode(0, 0.0, true, false);
+    genome.addNode(1, 0.0, true, false);
+    genome.addNode(2, 0.1, false, true);
+    genome.addNode(3, -0.2, false, true);
+    genome.addNode(4, 0.3, false, false);
+    genome.addNode(5, 0.5, false, false);
+    genome.addNode(6, -0.4, false, false);
+    genome.addConnection(0, 2, 0.7, 0);
+    genome.addConnection(1, 3, -1.1, 1);
+    genome.addConnection(0, 4, 0.9, 2);
+    genome.addConnection(1, 5, 1.3, 3);
+    genome.addConnection(5, 2, 0.6, 4);
+    genome.addConnection(0, 6, 0.5, 5);
+    genome.addConnection(6, 3, 0.8, 6);
+    genome.m_connections[3].enabled = false;
+    genome.m_connections[6].enabled = false;
+
+    CompiledNetwork full = genome.compile(nullptr, false);
+    CompiledNetwork pruned = genome.compile(nullptr, true);
+
+    const CompiledNetwork::PruneStats& stats = pruned.getPruneStats();
+    check(stats.disabledEdges == 2, "2 disabled edges, got " + std::to_string(stats.disabledEdges));
+    check(stats.danglingEdges == 0, "no dangling edges, got " + std::to_string(stats.danglingEdges));
+    check(stats.deadEndNodes == 2, "2 dead-end nodes, got " + std::to_string(stats.deadEndNodes));
+    check(stats.deadEndEdges == 2, "2 dead-end edges, got " + std::to_string(stats.deadEndEdges));
+    check(stats.constantNodes == 1, "1 constant node, got " + std::to_string(stats.constantNodes));
+    check(stats.foldedEdges == 1, "1 folded edge, got " + std::to_string(stats.foldedEdges));
+    check(stats.getNodesRemoved() == 3, "3 nodes removed, got " + std::to_string(stats.getNodesRemoved()));
+    check(full.getNumEdges() == 5, "5 edges unpruned, got " + std::to_string(full.getNumEdges()));
+    check(pruned.getNumEdges() == 2, "2 edges pruned, got " + std::to_string(pruned.getNumEdges()));
+    check(!pruned.isPatchable(), "a network with folded constants is not patchable");
+
+    auto sigmoid = [](double x) { return 1.0 / (1.0 + std::exp(-x)); };
+    const double inputs[][2] = { { 0.0, 0.0 }, { 1.0, -1.0 }, { -0.3, 2.5 } };
+    for (const auto& input : inputs) {
+        string what = "inputs [" + std::to_string(input[0]) + ", " + std::to_string(input[1]) + "]";
+        double expected[2] = {
+            sigmoid(0.7 * input[0] + 0.6 * sigmoid(0.5) + 0.1),
+            sigmoid(-1.1 * input[1] - 0.2)
+        };
+        full.resetState();
+        full.feedForward(input, 2);
+        pruned.resetState();
+        pruned.feedForward(input, 2);
+        for (size_t i = 0; i < 2; ++i) {
+            checkNear(full.getOutput(i), expected[i], 1e-12, "unpruned network, " + what + ", output " + std::to_string(i));
+            checkNear(pruned.getOutput(i), full.getOutput(i), 1e-12, "pruned network, " + what + ", output " + std::to_string(i));
+        }
+    }
+}
+
+// Culling keeps the survivalThreshold fraction of a species, champion first
+void testCull() {
+    auto fillSpecies = [](std::vector<Genome>& genomes, double firstFitness) {
+        for (size_t i = 0; i < genomes.size(); ++i) {
+            // Shuffled fitness values, the champion in the middle
+            genomes[i].setFitness(firstFitness + static_cast<double>((i * 7) % genomes.size()));
+        }
+        Species species(&genomes[0], 0);
+        for (size_t i = 1; i < genomes.size(); ++i) species.addGenome(&genomes[i]);
+        return species;
+    };
+
+    std::vector<Genome> genomes(10);
+    Species species = fillSpecies(genomes, 0.0);
+    species.cull(0.3);
+    check(species.getSize() == 3, "30% of 10 keeps 3, got " + std::to_string(species.getSize()));
+    if (species.getSize() == 3) {
+        checkNear(species.getGenomes()[0]->getFitness(), 9.0, 0.0, "champion first");
+        double keptSum = species.getGenomes()[1]->getFitness() + species.getGenomes()[2]->getFitness();
+        checkNear(keptSum, 15.0, 0.0, "the next two best kept");
+    }
+
+    std::vector<Genome> small(4);
+    Species keepBest = fillSpecies(small, 1.0);
+    keepBest.cull(0.2);
+    check(keepBest.getSize() == 1, "keepBest keeps the champion when 20% of 4 rounds to 0");
+    if (keepBest.getSize() == 1) checkNear(keepBest.getGenomes()[0]->getFitness(), 4.0, 0.0, "champion kept");
+
+    std::vector<Genome> other(4);
+    Species noBest = fillSpecies(other, 1.0);
+    noBest.cull(0.2, false);
+    check(noBest.getSize() == 0, "without keepBest 20% of 4 keeps nothing");
+}
+
+struct Test {
+    const char* name;
+    std::function<void()> run;
+};
+
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--fixtures" && i + 1 < argc) {
+            fixtureDirectory = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--fixtures <dir>]" << endl;
+            return 1;
+        }
+    }
+
+    const Test tests[] = {
+        { "network fixture", testNetworkFixture },
+        { "pruning", testPruning },
+        { "cull", testCull },
+    };
+
+    for (const Test& test : tests) {
+        int failuresBefore = failures;
+        cout << test.name << endl;
+        test.run();
+        if (failures == failuresBefore) cout << "  ok" << endl;
+    }
+
+    cout << checks << " checks, " << failures << " failed" << endl;
+    return failures == 0 ? 0 : 1;
+}
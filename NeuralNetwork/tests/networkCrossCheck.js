@@ -0,0 +1,26 @@
+// Checks the browser's NEATNetwork against network_fixture.json, the outputs the native networks
+// are tested against in Tests.cpp. Run from NeuralNetwork/: node tests/networkCrossCheck.js
+const fs = require('fs');
+const path = require('path');
+const vm = require('vm');
+
+const context = {};
+vm.createContext(context);
+vm.runInContext(fs.readFileSync(path.join(__dirname, '../web/js/neuralNetwork.js'), 'utf8') + '\nthis.NEATNetwork = NEATNetwork;', context);
+const fixture = JSON.parse(fs.readFileSync(path.join(__dirname, 'network_fixture.json'), 'utf8'));
+
+const tolerance = 1e-12;
+let failures = 0;
+const network = new context.NEATNetwork(fixture.genome);
+for (const testCase of fixture.cases) {
+    const outputs = network.feedForward(testCase.inputs);
+    testCase.outputs.forEach((expected, i) => {
+        if (!(Math.abs(outputs[i] - expected) <= tolerance)) {
+            console.log(`FAIL inputs ${JSON.stringify(testCase.inputs)} output ${i}: ${outputs[i]}, expected ${expected}`);
+            failures++;
+        }
+    });
+}
+
+console.log(failures === 0 ? `${fixture.cases.length} cases passed` : `${failures} outputs differ`);
+process.exit(failures === 0 ? 0 : 1);
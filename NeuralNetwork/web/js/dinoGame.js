@@ -1,8 +1,20 @@
-// Dino Game Class - JavaScript version of the Processing Dino game
+// Hard stop of AI games so a perfect dino cannot run forever, DinoSimulator::Config::maxFrames.
+// A course from the server replaces it with its own length.
+const MAX_FRAMES = 20000;
+
+// Sprite sizes the game logic depends on, for a headless game with no images to measure
+const HEADLESS_SPRITES = {
+    dinoRun1: { width: 96, height: 112 },
+    dinoDuck: { width: 136, height: 68 }
+};
+
+// Dino Game Class - JavaScript version of the Processing Dino game.
+// Without a canvas (a Web Worker evaluator) the game is headless: nothing is loaded or drawn.
 class DinoGame {
     constructor(canvas) {
         this.canvas = canvas;
-        this.ctx = canvas.getContext('2d');
+        this.ctx = canvas ? canvas.getContext('2d') : null;
+        this.width = canvas ? canvas.width : 1200; // Also the input scale of obstacle positions
         
         // Game state
         this.isRunning = false;
@@ -25,12 +37,45 @@ class DinoGame {
         this.minimumTimeBetweenObstacles = 100;
         this.randomAdditionOfNewObstacles = Math.floor(Math.random() * 50);
         this.obstacles = [];
+        // Obstacles all move left at the same speed, so they stay sorted by position: the ones
+        // ahead of the dino start at this index, and the ones off screen are at the front
+        this.nextAhead = 0;
+        
+        // Course sent by the server (see ObstacleSchedule.cpp): obstacles spawn at fixed frames
+        // instead of random ones, so every genome plays the same course as the native simulator
+        this.obstacleSchedule = null;
+        this.maxFrames = MAX_FRAMES;
+        this.frame = 0;
+        this.nextSpawn = 0;
+        
+        // When the network is queried (see DinoSimulator::DecisionPolicy). Between two queries the dino
+        // keeps its last outputs, like a held key. Sent by the server, every frame by default.
+        this.decisionPolicy = { interval: 1, skipAirborne: false, inputEpsilon: 0 };
+        this.inputs = [0, 0, 0, 0];
+        this.lastInputs = [0, 0, 0, 0];
+        this.framesSinceDecision = 1;
+        this.inferenceCalls = 0;
+        this.decisionFrames = 0;
+        
+        // Evaluation speed, set by the server's 'mode' message: game ticks per animation frame for AI
+        // games, and which animation frames are drawn (every renderInterval-th, none for 0, or with
+        // renderChampion only those of a game beating the best score seen so far)
+        this.ticksPerFrame = 1;
+        this.renderInterval = 1;
+        this.renderChampion = false;
+        this.bestScore = 0;
+        this.animationFrames = 0;
+        this.simulationMs = 0;
         
         // Ground height (matching Processing code)
         this.groundHeight = 250;
         
         // Load images
-        this.loadImages();
+        if (canvas) {
+            this.loadImages();
+        } else {
+            this.images = HEADLESS_SPRITES;
+        }
         
         // AI control
         this.aiControl = false;
@@ -91,17 +136,42 @@ class DinoGame {
     
     // Start the game
     start() {
+        this.resetState();
+        this.gameLoop();
+    }
+    
+    // Play a whole AI game at once without drawing, as fast as possible (Web Worker evaluators)
+    runHeadless() {
+        this.resetState();
+        const start = performance.now();
+        while (!this.isOver()) {
+            this.updateAI();
+            this.update();
+        }
+        this.simulationMs = performance.now() - start;
+        this.isRunning = false;
+        this.gameOver = true;
+    }
+    
+    resetState() {
         this.isRunning = true;
         this.gameOver = false;
         this.score = 0;
         this.obstacles = [];
+        this.nextAhead = 0;
         this.timerBetweenObstacles = 0;
         this.speed = 5;
         this.dinoDead = false;
         this.posY = 0;
         this.velY = 0;
         this.isCrouching = false;
-        this.gameLoop();
+        this.frame = 0;
+        this.nextSpawn = 0;
+        this.framesSinceDecision = this.decisionPolicy.interval;
+        this.inferenceCalls = 0;
+        this.decisionFrames = 0;
+        this.animationFrames = 0;
+        this.simulationMs = 0;
     }
     
     // Pause/unpause the game
@@ -124,19 +194,48 @@ class DinoGame {
     gameLoop() {
         if (!this.isRunning || this.isPaused) return;
 
-        // Call AI update if enabled
-        this.updateAI();
+        // AI games can run several ticks per animation frame, people play at display rate
+        const ticks = this.aiControl && this.neuralNetwork ? this.ticksPerFrame : 1;
+        const start = performance.now();
+        for (let tick = 0; tick < ticks && !this.isOver(); tick++) {
+            // Call AI update if enabled
+            this.updateAI();
 
-        this.update();
-        this.render();
+            this.update();
+        }
+        this.simulationMs += performance.now() - start;
+        this.animationFrames++;
+        
+        if (this.shouldRender()) {
+            this.render();
+        }
 
-        if (!this.dinoDead) {
+        if (!this.isOver()) {
             this.animationId = requestAnimationFrame(() => this.gameLoop());
         } else {
             this.gameOver = true;
+            this.bestScore = Math.max(this.bestScore, this.score);
         }
     }
     
+    // { ticksPerFrame, renderInterval, renderChampion } from the server
+    setMode(mode) {
+        this.ticksPerFrame = Math.max(1, mode.ticksPerFrame);
+        this.renderInterval = mode.renderInterval;
+        this.renderChampion = mode.renderChampion;
+    }
+    
+    // Nothing is drawn for most games: skip the per-genome visualization too
+    isHeadless() {
+        return this.renderInterval <= 0 || this.renderChampion;
+    }
+    
+    shouldRender() {
+        if (!this.aiControl || !this.neuralNetwork) return true;
+        if (this.renderChampion) return this.score > this.bestScore;
+        return this.renderInterval > 0 && this.animationFrames % this.renderInterval === 0;
+    }
+    
     // Update game state (matching Processing move() method)
     update() {
         this.updateSpeed();
@@ -254,14 +353,15 @@ class DinoGame {
     
     // Update obstacles (matching Processing updateObstacles())
     updateObstacles() {
-        for (let i = this.obstacles.length - 1; i >= 0; i--) {
+        for (let i = 0; i < this.obstacles.length; i++) {
             this.obstacles[i].move(this.speed);
             
             this.checkCollision(i);
-            
-            if ((this.obstacles[i].positionX + this.obstacles[i].obstacleWidth) < 0) {
-                this.obstacles.splice(i, 1);
-            }
+        }
+        
+        while (this.obstacles.length > 0 && (this.obstacles[0].positionX + this.obstacles[0].obstacleWidth) < 0) {
+            this.obstacles.shift();
+            this.nextAhead = Math.max(0, this.nextAhead - 1);
         }
     }
     
@@ -294,8 +394,32 @@ class DinoGame {
         }
     }
     
+    // { interval, skipAirborne, inputEpsilon } from the server
+    setDecisionPolicy(policy) {
+        this.decisionPolicy = policy;
+    }
+    
+    // Replay a course from the server: { seed, numFrames, spawns: [frame, type, frame, type, ...] }.
+    // null goes back to random obstacles.
+    setObstacleSchedule(schedule) {
+        this.obstacleSchedule = schedule;
+        this.maxFrames = schedule ? schedule.numFrames : MAX_FRAMES;
+    }
+    
     // Add obstacle (matching Processing addObstacle())
     addObstacle() {
+        const frame = this.frame++;
+        
+        // Past the end of the course (the native simulator stops there) obstacles are random again
+        if (this.obstacleSchedule && frame < this.obstacleSchedule.numFrames) {
+            const spawns = this.obstacleSchedule.spawns;
+            if (2 * this.nextSpawn < spawns.length && spawns[2 * this.nextSpawn] === frame) {
+                this.obstacles.push(new Obstacle(spawns[2 * this.nextSpawn + 1]));
+                this.nextSpawn++;
+            }
+            return;
+        }
+        
         this.timerBetweenObstacles += 1;
         
         if (this.timerBetweenObstacles > (this.minimumTimeBetweenObstacles + this.randomAdditionOfNewObstacles)) {
@@ -342,17 +466,11 @@ class DinoGame {
     
     // Get nearest obstacle for AI
     getNearestObstacle() {
-        let nearest = null;
-        let minDistance = Infinity;
-        
-        for (const obstacle of this.obstacles) {
-            if (obstacle.positionX > this.dinoX && obstacle.positionX < minDistance) {
-                nearest = obstacle;
-                minDistance = obstacle.positionX;
-            }
+        while (this.nextAhead < this.obstacles.length && this.obstacles[this.nextAhead].positionX <= this.dinoX) {
+            this.nextAhead++;
         }
         
-        return nearest;
+        return this.nextAhead < this.obstacles.length ? this.obstacles[this.nextAhead] : null;
     }
     
     // Update AI control
@@ -360,15 +478,18 @@ class DinoGame {
         if (!this.aiControl || !this.neuralNetwork) return;
         
         const gameState = this.getGameState();
-        const inputs = [
-            gameState.dinoY / 100,  // Normalize
-            gameState.dinoVelocity / 20,  // Normalize
-            gameState.obstacleX / this.canvas.width,  // Normalize
-            gameState.obstacleHeight / 120  // Normalize
-        ];
-        
-        // Feed forward through neural network
-        this.neuralNetwork.feedForward(inputs);
+        const inputs = this.inputs;
+        inputs[0] = gameState.dinoY / 100;  // Normalize
+        inputs[1] = gameState.dinoVelocity / 20;  // Normalize
+        inputs[2] = gameState.obstacleX / this.width;  // Normalize
+        inputs[3] = gameState.obstacleHeight / 120;  // Normalize
+        
+        // Feed forward through neural network, or keep the previous outputs
+        this.decisionFrames++;
+        if (this.needsDecision(inputs)) {
+            this.neuralNetwork.feedForward(inputs);
+            this.inferenceCalls++;
+        }
         const outputs = this.neuralNetwork.getOutputs();
         
         // Apply AI decision
@@ -381,11 +502,39 @@ class DinoGame {
         }
     }
     
+    // Same rule as DinoSimulator::needsDecision
+    needsDecision(inputs) {
+        const policy = this.decisionPolicy;
+        if (policy.interval <= 1 && !policy.skipAirborne) return true;
+        if (policy.skipAirborne && this.posY > 0) {
+            this.framesSinceDecision++;
+            return false;
+        }
+        
+        let decide = this.framesSinceDecision >= policy.interval;
+        for (let i = 0; policy.inputEpsilon > 0 && !decide && i < inputs.length; i++) {
+            decide = Math.abs(inputs[i] - this.lastInputs[i]) > policy.inputEpsilon;
+        }
+        
+        if (!decide) {
+            this.framesSinceDecision++;
+            return false;
+        }
+        this.framesSinceDecision = 1;
+        for (let i = 0; i < inputs.length; i++) this.lastInputs[i] = inputs[i];
+        return true;
+    }
+    
     // Check if game is over
     isDead() {
         return this.dinoDead;
     }
     
+    // The dino died, or an AI game reached maxFrames like the native simulator's games
+    isOver() {
+        return this.dinoDead || (this.aiControl && this.frame >= this.maxFrames);
+    }
+    
     // Get fitness for NEAT
     getFitness() {
         return this.score;
@@ -0,0 +1,83 @@
+// Pool of Web Worker evaluators (evaluatorWorker.js). Genomes wait in a queue until a worker is
+// idle, and every result comes back through onResult(result, genome) on the main thread.
+// A genome whose worker fails is queued again once, then reported with a fitness of 0.
+class EvaluatorPool {
+    constructor(numWorkers, onResult) {
+        this.workers = [];
+        this.idle = [];
+        this.pending = [];
+        this.running = new Map(); // worker -> genome
+        this.retried = new Set(); // genomes already queued again after a worker error
+        this.onResult = onResult;
+        
+        for (let i = 0; i < numWorkers; i++) {
+            const worker = new Worker('js/evaluatorWorker.js');
+            worker.onmessage = (event) => {
+                const genome = this.running.get(worker);
+                this.running.delete(worker);
+                this.retried.delete(genome);
+                this.idle.push(worker);
+                this.onResult(event.data, genome);
+                this.dispatch();
+            };
+            worker.onerror = (error) => {
+                console.error(`Evaluator worker ${i} failed:`, error.message);
+                error.preventDefault();
+                
+                // The worker stays usable after an exception in its handler: give it back the
+                // genome's place so the generation does not wait on a result that never comes
+                const genome = this.running.get(worker);
+                this.running.delete(worker);
+                this.idle.push(worker);
+                if (genome) {
+                    if (this.retried.has(genome)) {
+                        this.retried.delete(genome);
+                        this.onResult({ genomeId: genome.id, fitness: 0, inferences: 0, frames: 0, simulationMs: 0 }, genome);
+                    } else {
+                        this.retried.add(genome);
+                        this.pending.unshift(genome);
+                    }
+                }
+                this.dispatch();
+            };
+            this.workers.push(worker);
+            this.idle.push(worker);
+        }
+    }
+    
+    get size() {
+        return this.workers.length;
+    }
+    
+    // Same message to every worker, such as the course or the decision policy
+    broadcast(message) {
+        for (const worker of this.workers) {
+            worker.postMessage(message);
+        }
+    }
+    
+    evaluate(genome) {
+        this.pending.push(genome);
+        this.dispatch();
+    }
+    
+    dispatch() {
+        while (this.idle.length > 0 && this.pending.length > 0) {
+            const worker = this.idle.pop();
+            const genome = this.pending.shift();
+            this.running.set(worker, genome);
+            worker.postMessage({ type: 'evaluate', genome: genome });
+        }
+    }
+    
+    terminate() {
+        for (const worker of this.workers) {
+            worker.terminate();
+        }
+        this.workers = [];
+        this.idle = [];
+        this.pending = [];
+        this.running.clear();
+        this.retried.clear();
+    }
+}
@@ -0,0 +1,29 @@
+// Web Worker evaluator: plays genomes in a headless DinoGame, off the UI thread.
+// Messages (see EvaluatorPool): obstacle_schedule and decision_policy set up the games,
+// evaluate plays one genome and answers with its fitness.
+importScripts('dinoGame.js', 'neuralNetwork.js');
+
+const game = new DinoGame(null);
+
+onmessage = (event) => {
+    const data = event.data;
+    switch (data.type) {
+        case 'obstacle_schedule':
+            game.setObstacleSchedule(data.schedule);
+            break;
+        case 'decision_policy':
+            game.setDecisionPolicy(data.policy);
+            break;
+        case 'evaluate':
+            game.setNeuralNetwork(new NEATNetwork(data.genome));
+            game.runHeadless();
+            postMessage({
+                genomeId: data.genome.id,
+                fitness: game.getFitness(),
+                inferences: game.inferenceCalls,
+                frames: game.decisionFrames,
+                simulationMs: game.simulationMs
+            });
+            break;
+    }
+};
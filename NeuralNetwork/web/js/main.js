@@ -12,6 +12,17 @@ class DinoGameApp {
         this.population = [];
         this.currentGenomeIndex = 0;
         
+        // Genomes kept for the server's delta encoding, see GenomeCache. Genomes sent before the
+        // server's last cache reset carry an older epoch and are not cached.
+        this.genomeCache = new GenomeCache(256);
+        this.cacheEpoch = 0;
+        
+        // With ?workers=N (or ?workers=auto, one per core but one) genomes are evaluated by a pool of
+        // Web Workers and the main thread only visualizes. Without it, on this thread as before.
+        this.evaluators = this.createEvaluators();
+        this.lastWorkerFitness = 0;
+        this.bestWorkerFitness = 0;
+        
         this.initializeEventListeners();
         this.initializeStats();
         
@@ -53,9 +64,29 @@ class DinoGameApp {
     
     // Update statistics display
     updateStats() {
-        document.getElementById('score').textContent = `Score: ${this.game.score}`;
+        const workers = this.evaluators && this.isTraining;
+        document.getElementById('score').textContent = `Score: ${workers ? this.lastWorkerFitness : this.game.score}`;
         document.getElementById('generation').textContent = `Generation: ${this.currentGeneration}`;
-        document.getElementById('fitness').textContent = `Fitness: ${this.game.getFitness()}`;
+        document.getElementById('fitness').textContent = `Fitness: ${workers ? this.bestWorkerFitness : this.game.getFitness()}`;
+    }
+    
+    createEvaluators() {
+        const requested = new URLSearchParams(window.location.search).get('workers');
+        if (!requested || typeof Worker === 'undefined') return null;
+        
+        const cores = navigator.hardwareConcurrency || 2;
+        const numWorkers = requested === 'auto' ? Math.max(1, cores - 1) : parseInt(requested, 10);
+        if (!(numWorkers > 0)) return null;
+        
+        try {
+            const pool = new EvaluatorPool(numWorkers, (result) => this.receiveWorkerResult(result));
+            console.log(`Evaluating genomes on ${numWorkers} workers`);
+            return pool;
+        } catch (error) {
+            // Workers cannot start from file:// pages in most browsers
+            console.warn('Cannot start evaluator workers, evaluating on the main thread:', error);
+            return null;
+        }
     }
     
     // Start manual mode
@@ -66,6 +97,8 @@ class DinoGameApp {
         this.population = [];
         this.currentGenomeIndex = 0;
         
+        // Manual games use random obstacles; the server sends its course again on 'ready'
+        this.game.setObstacleSchedule(null);
         this.game.stop();
         this.game.start();
         
@@ -96,7 +129,14 @@ class DinoGameApp {
         // Instead of initializing a local population, notify the backend to start training
         // The backend will send genomes one by one
         if (this.ws && this.ws.readyState === WebSocket.OPEN) {
-            this.ws.send(JSON.stringify({ type: 'ready' }));
+            // The server restarts its mirror of the cache on 'ready'
+            this.genomeCache.clear();
+            this.cacheEpoch = 0;
+            this.ws.send(JSON.stringify({
+                type: 'ready',
+                genomeCacheSize: this.genomeCache.capacity,
+                workers: this.evaluators ? this.evaluators.size : 1
+            }));
         }
 
         // Update UI
@@ -144,8 +184,44 @@ class DinoGameApp {
         switch (data.type) {
             case 'genome':
                 // Receive new genome from C++ and test it
+                if (data.epoch >= this.cacheEpoch) {
+                    this.cacheEpoch = data.epoch;
+                    this.genomeCache.set(data.genome.id, data.genome);
+                }
                 this.testGenome(data.genome);
                 break;
+            case 'genome_delta':
+                // Same, sent as changes to a genome received earlier
+                this.receiveGenomeDelta(data.genome, data.epoch);
+                break;
+            case 'obstacle_schedule':
+                // Course of the native simulator, every genome is played on it
+                this.game.setObstacleSchedule({ seed: data.seed, numFrames: data.numFrames, spawns: data.spawns });
+                if (this.evaluators) {
+                    this.evaluators.broadcast({ type: 'obstacle_schedule', schedule: this.game.obstacleSchedule });
+                }
+                break;
+            case 'decision_policy':
+                // How often the network is queried, applied from the next game on
+                this.game.setDecisionPolicy({ interval: data.interval, skipAirborne: data.skipAirborne, inputEpsilon: data.inputEpsilon });
+                if (this.evaluators) {
+                    this.evaluators.broadcast({ type: 'decision_policy', policy: this.game.decisionPolicy });
+                }
+                break;
+            case 'mode':
+                // Evaluation speed, adjusted by the server to the throughput it measures
+                this.game.setMode({ ticksPerFrame: data.ticksPerFrame, renderInterval: data.renderInterval, renderChampion: data.renderChampion });
+                break;
+            case 'champion':
+                // New best genome, the one the network view shows, laid out by the server
+                this.networkViz.updateNetwork(data.genome, data.layout);
+                break;
+            case 'statistics':
+                // Throttled snapshot of the server's streaming statistics
+                document.getElementById('statistics').textContent =
+                    `Species: ${data.species.length / 5} | ${Math.round(data.evaluationsPerSecond)} evaluations/s | ` +
+                    `median ${Math.round(data.fitness.median)}, p90 ${Math.round(data.fitness.p90)}`;
+                break;
             case 'evolution_stats':
                 // Update evolution statistics
                 this.evolutionStats.addFitness(data.generation, data.bestFitness, data.avgFitness);
@@ -156,21 +232,51 @@ class DinoGameApp {
         }
     }
     
+    // Rebuild a genome from its cached base, or ask for the full genome if the caches went out of sync.
+    // A delta from an older epoch was encoded against a cache dropped since: it is requested again
+    // without clearing, and the server does not reset for it.
+    receiveGenomeDelta(delta, epoch) {
+        if (epoch < this.cacheEpoch) {
+            this.ws.send(JSON.stringify({ type: 'cache_miss', genomeId: delta.id, epoch: epoch }));
+            return;
+        }
+        this.cacheEpoch = epoch;
+        
+        const base = this.genomeCache.get(delta.baseId);
+        if (base === undefined) {
+            // The server starts the next epoch when it gets this, so the deltas still in flight are stale
+            console.warn(`Genome ${delta.id}: base genome ${delta.baseId} not cached, requesting full genome`);
+            this.genomeCache.clear();
+            this.cacheEpoch = epoch + 1;
+            this.ws.send(JSON.stringify({ type: 'cache_miss', genomeId: delta.id, epoch: epoch }));
+            return;
+        }
+        
+        const genomeData = applyGenomeDelta(base, delta);
+        this.genomeCache.set(genomeData.id, genomeData);
+        this.testGenome(genomeData);
+    }
+    
     // Test a genome from the C++ backend
     testGenome(genomeData) {
+        if (this.evaluators) {
+            this.evaluators.evaluate(genomeData);
+            return;
+        }
+        
         console.log("Received genome:", genomeData);
         // Create a neural network from the genome data
         const network = this.createNetworkFromGenome(genomeData);
         // Set the network for the game
         this.game.setNeuralNetwork(network);
-        // Draw the network immediately
-        this.networkViz.updateNetwork(genomeData);
+        // The network view shows the champion (see 'champion'), only its inputs and outputs follow this game
+        const headless = this.game.isHeadless();
         // Start the game
         this.game.start();
-        // Run until the dino dies
+        // Run until the dino dies or the game reaches its frame limit
         const gameLoop = () => {
             // Real-time input/output visualization
-            if (this.game.neuralNetwork) {
+            if (this.game.neuralNetwork && !headless) {
                 const gameState = this.game.getGameState();
                 const inputs = [
                     gameState.dinoY / 100,
@@ -181,15 +287,17 @@ class DinoGameApp {
                 const outputs = this.game.neuralNetwork.getOutputs();
                 this.networkViz.updateRealTime(inputs, outputs);
             }
-            if (this.game.isDead()) {
+            if (this.game.isOver()) {
                 // Send fitness back to C++
                 this.ws.send(JSON.stringify({
                     type: 'fitness',
                     genomeId: genomeData.id,
-                    fitness: this.game.getFitness()
+                    fitness: this.game.getFitness(),
+                    inferences: this.game.inferenceCalls,
+                    frames: this.game.decisionFrames,
+                    simulationMs: this.game.simulationMs,
+                    animationFrames: this.game.animationFrames
                 }));
-                // Update visualization with this genome (final state)
-                this.networkViz.updateNetwork(genomeData);
                 console.log(`Genome ${genomeData.id} completed with fitness: ${this.game.getFitness()}`);
             } else {
                 // Continue game
@@ -199,6 +307,21 @@ class DinoGameApp {
         gameLoop();
     }
     
+    // A worker finished a genome: report it
+    receiveWorkerResult(result) {
+        this.ws.send(JSON.stringify({
+            type: 'fitness',
+            genomeId: result.genomeId,
+            fitness: result.fitness,
+            inferences: result.inferences,
+            frames: result.frames,
+            simulationMs: result.simulationMs
+        }));
+        
+        this.lastWorkerFitness = result.fitness;
+        this.bestWorkerFitness = Math.max(this.bestWorkerFitness, result.fitness);
+    }
+    
     // Create a neural network from genome data
     createNetworkFromGenome(genomeData) {
         return new NEATNetwork(genomeData);
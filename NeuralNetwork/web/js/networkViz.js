@@ -19,24 +19,27 @@ class NetworkVisualizer {
         this.links = [];
     }
     
-    // Update the network visualization with new neural network data
-    updateNetwork(network) {
+    // Update the network visualization with new neural network data. With a layout from the
+    // server (see NetworkLayout) every node is placed by it and no force simulation runs.
+    updateNetwork(network, layout) {
         if (!network) return;
         
         // Clear previous visualization
+        if (this.simulation) this.simulation.stop();
         this.svg.selectAll('*').remove();
         
         // Convert network to D3 format
-        this.convertNetworkToD3(network);
+        this.convertNetworkToD3(network, layout);
         
         // Create the visualization
         this.createVisualization();
     }
     
     // Convert neural network to D3.js format
-    convertNetworkToD3(network) {
+    convertNetworkToD3(network, layout) {
         this.nodes = [];
         this.links = [];
+        this.fixedLayout = !!layout;
         const defaultRadius = 18;
         const nodeMargin = defaultRadius + 12;
         const leftX = nodeMargin;
@@ -58,7 +61,32 @@ class NetworkVisualizer {
         }
         // Hidden nodes: distributed between input and output
         let maxLayer = 1;
-        if (network.nodes) {
+        if (network.nodes && layout) {
+            // Flat [nodeId, layer, order, ...] triples, positioned like the inputs and outputs
+            const placement = new Map();
+            const layerSizes = new Array(layout.layers).fill(0);
+            for (let i = 0; i < layout.nodes.length; i += 3) {
+                placement.set(layout.nodes[i], { layer: layout.nodes[i + 1], order: layout.nodes[i + 2] });
+                layerSizes[layout.nodes[i + 1]]++;
+            }
+            maxLayer = Math.max(1, layout.layers - 2);
+            network.nodes.filter(node => node.type === 'hidden').forEach(node => {
+                const place = placement.get(node.id);
+                if (!place) return;
+                const x = leftX + (rightX - leftX) * (place.layer / (maxLayer + 1));
+                const y = (this.height - 100) * (place.order + 1) / (layerSizes[place.layer] + 1) + 50;
+                this.nodes.push({
+                    id: `hidden_${node.id}`,
+                    type: 'hidden',
+                    layer: place.layer,
+                    x: x,
+                    y: y,
+                    fx: x,
+                    fy: y,
+                    genomeId: node.id // hidden node id in genome
+                });
+            });
+        } else if (network.nodes) {
             maxLayer = Math.max(1, ...network.nodes.map(n => n.layer));
             const hiddenNodes = network.nodes.filter(node => node.type === 'hidden');
             hiddenNodes.forEach((node, index) => {
@@ -162,22 +190,8 @@ class NetworkVisualizer {
             .attr('text-anchor', d => d.type === 'input' ? 'end' : 'start')
             .attr('font-size', '13px')
             .attr('fill', '#222');
-        // Create force simulation
-        this.simulation = d3.forceSimulation(this.nodes)
-            .force('link', d3.forceLink(this.links).id(d => d.id).distance(80))
-            .force('charge', d3.forceManyBody().strength(-300))
-            .force('center', d3.forceCenter(this.width / 2, this.height / 2))
-            .force('x', d3.forceX().x(d => d.x).strength(0.1))
-            .force('y', d3.forceY().y(d => d.y).strength(0.1));
-        // Only hidden nodes are affected by simulation
-        this.simulation.nodes().forEach(n => {
-            if (n.type === 'input' || n.type === 'output') {
-                n.fx = n.x;
-                n.fy = n.y;
-            }
-        });
         // Update positions on tick
-        this.simulation.on('tick', () => {
+        const draw = () => {
             link
                 .attr('x1', d => d.source.x)
                 .attr('y1', d => d.source.y)
@@ -192,7 +206,28 @@ class NetworkVisualizer {
             semanticLabel
                 .attr('x', d => d.type === 'input' ? d.x - 40 : d.x + 40)
                 .attr('y', d => d.y + 5);
-        });
+        };
+        if (this.fixedLayout) {
+            // Every node is already placed, draw once
+            this.simulation = null;
+            draw();
+        } else {
+            // Create force simulation
+            this.simulation = d3.forceSimulation(this.nodes)
+                .force('link', d3.forceLink(this.links).id(d => d.id).distance(80))
+                .force('charge', d3.forceManyBody().strength(-300))
+                .force('center', d3.forceCenter(this.width / 2, this.height / 2))
+                .force('x', d3.forceX().x(d => d.x).strength(0.1))
+                .force('y', d3.forceY().y(d => d.y).strength(0.1));
+            // Only hidden nodes are affected by simulation
+            this.simulation.nodes().forEach(n => {
+                if (n.type === 'input' || n.type === 'output') {
+                    n.fx = n.x;
+                    n.fy = n.y;
+                }
+            });
+            this.simulation.on('tick', draw);
+        }
         // After drawing the network, overlay HTML labels for input/output nodes
         // Remove old labels
         d3.select('#networkViz').selectAll('.network-label').remove();
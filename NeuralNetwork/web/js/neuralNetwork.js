@@ -18,6 +18,7 @@ class NEATNetwork {
                 id: nodeData.id,
                 layer: nodeData.layer,
                 type: nodeData.type,
+                bias: nodeData.bias || 0,
                 value: 0,
                 activated: false
             });
@@ -69,7 +70,7 @@ class NEATNetwork {
             }
             
             // Apply activation function
-            node.value = this.activationFunction(sum);
+            node.value = this.activationFunction(sum + node.bias);
             node.activated = true;
         }
         
@@ -80,9 +81,10 @@ class NEATNetwork {
         return this.outputs;
     }
     
-    // Activation function (tanh)
+    // Activation function (sigmoid), the same as the server's networks (Node, CompiledNetwork) so a
+    // genome plays the same game here, in the workers and in the native simulator
     activationFunction(x) {
-        return Math.tanh(x);
+        return 1 / (1 + Math.exp(-x));
     }
     
     // Get outputs
@@ -99,4 +101,86 @@ class NEATNetwork {
             connections: this.genomeData.connections
         };
     }
-} 
\ No newline at end of file
+} 
+
+// LRU cache of received genomes, mirrored by the server so it can send genomes as deltas.
+// Every get/set must happen in the order the genomes arrive for both sides to stay in sync.
+class GenomeCache {
+    constructor(capacity) {
+        this.capacity = capacity;
+        this.genomes = new Map(); // Iteration order is the LRU order, oldest first
+    }
+    
+    get(id) {
+        const genome = this.genomes.get(id);
+        if (genome === undefined) return undefined;
+        this.genomes.delete(id);
+        this.genomes.set(id, genome);
+        return genome;
+    }
+    
+    set(id, genome) {
+        // Genome ids are reused by the server, a new genome replaces the old one
+        this.genomes.delete(id);
+        this.genomes.set(id, genome);
+        while (this.genomes.size > this.capacity) {
+            this.genomes.delete(this.genomes.keys().next().value);
+        }
+    }
+    
+    clear() {
+        this.genomes.clear();
+    }
+}
+
+// Rebuild a genome from a cached base and a 'genome_delta' message. The base is left untouched.
+function applyGenomeDelta(base, delta) {
+    const removedNodes = new Set(delta.removedNodes || []);
+    const removedConnections = new Set(delta.removedConnections || []);
+    
+    const biases = new Map();
+    const changedBiases = delta.biases || [];
+    for (let i = 0; i < changedBiases.length; i += 2) {
+        biases.set(changedBiases[i], changedBiases[i + 1]);
+    }
+    const weights = new Map();
+    const changedWeights = delta.weights || [];
+    for (let i = 0; i < changedWeights.length; i += 2) {
+        weights.set(changedWeights[i], changedWeights[i + 1]);
+    }
+    const toggled = new Set(delta.toggled || []);
+    
+    const nodes = [];
+    for (const node of base.nodes) {
+        if (removedNodes.has(node.id)) continue;
+        nodes.push(biases.has(node.id) ? { ...node, bias: biases.get(node.id) } : node);
+    }
+    for (const node of delta.addedNodes || []) {
+        nodes.push(node);
+    }
+    
+    const connections = [];
+    for (const conn of base.connections) {
+        const innovation = conn.innovationNumber;
+        if (removedConnections.has(innovation)) continue;
+        if (!weights.has(innovation) && !toggled.has(innovation)) {
+            connections.push(conn);
+            continue;
+        }
+        const patched = { ...conn };
+        if (weights.has(innovation)) patched.weight = weights.get(innovation);
+        if (toggled.has(innovation)) patched.enabled = !conn.enabled;
+        connections.push(patched);
+    }
+    for (const conn of delta.addedConnections || []) {
+        connections.push(conn);
+    }
+    
+    return {
+        id: delta.id,
+        numInputs: base.numInputs,
+        numOutputs: base.numOutputs,
+        nodes: nodes,
+        connections: connections
+    };
+}